@@ -0,0 +1,130 @@
+// AFAmazonS3ByteRangeDownload.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class AFAmazonS3Manager;
+
+/**
+ `AFAmazonS3ByteRangeDownload` downloads an object into a local file by fetching byte ranges of the object in parallel, using the `HEAD` and ranged `GET` operations of an `AFAmazonS3Manager`.
+
+ @discussion The destination file is preallocated to the size of the object, and each range is written at its offset in the file as it arrives, so no range is held in memory. Only the body of a `206 Partial Content` response with the object's `ETag` is written. A range that fails is fetched again from its first byte, since the bytes written by the failed attempt are not trusted. When there are no more ranges to start, the largest range still in flight is split, and its second half is fetched on a free connection, so that a single slow range does not hold up the end of the download.
+
+ ## Resuming Downloads
+
+ When `journalPath` is set, the `ETag` and size of the object and the byte ranges that remain to be fetched are archived to that path once the object has been inspected, and again each time a range finishes. A range is only left out of the journal once its response has been verified, so a range that was in flight when the download stopped is fetched again in full. A download revived with `+byteRangeDownloadWithJournalAtPath:manager:error:` keeps the bytes already in the destination file, and fetches only the remaining ranges, as long as the object has the same `ETag` and size, and the destination file has not been truncated. Otherwise, the whole object is downloaded again.
+
+ A download that fails keeps its journal. The journal is removed once the download succeeds or is cancelled.
+ */
+@interface AFAmazonS3ByteRangeDownload : NSObject <NSSecureCoding>
+
+/**
+ The manager used to send requests. A download revived from a journal must be given a manager before it is started.
+ */
+@property (nonatomic, strong) AFAmazonS3Manager *manager;
+
+/**
+ The object path.
+ */
+@property (readonly, nonatomic, copy) NSString *path;
+
+/**
+ The path of the local file being written.
+ */
+@property (readonly, nonatomic, copy) NSString *destinationFilePath;
+
+/**
+ The `ETag` of the object, or `nil` if the object has not yet been inspected. Every range is checked against this value, so a download fails if the object changes while it is in progress.
+ */
+@property (readonly, nonatomic, copy) NSString *ETag;
+
+/**
+ The size of the object, in bytes.
+ */
+@property (readonly, nonatomic, assign) unsigned long long contentLength;
+
+/**
+ The size of each range, in bytes. Defaults to the manager's `byteRangeDownloadSize`. Changes made after the download has started have no effect.
+ */
+@property (nonatomic, assign) unsigned long long rangeSize;
+
+/**
+ The maximum number of ranges fetched at once. Defaults to the manager's `maximumConcurrentByteRangeDownloads`.
+ */
+@property (nonatomic, assign) NSUInteger maximumConcurrentRanges;
+
+/**
+ The number of times a failed range is retried before the download fails. Defaults to the manager's `maximumByteRangeDownloadRetryCount`.
+ */
+@property (nonatomic, assign) NSUInteger maximumRangeRetryCount;
+
+/**
+ The path to which the progress of the download is archived, or `nil` if the download is not journaled. Must be set before the download is started.
+ */
+@property (nonatomic, copy) NSString *journalPath;
+
+/**
+ Whether the download has been cancelled.
+ */
+@property (readonly, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+
+/**
+ Initializes a byte-range download for the specified object.
+
+ @param manager The manager used to send requests. Must not be `nil`.
+ @param path The object path. Must not be `nil`.
+ @param destinationFilePath The path of the local file to write. Must not be `nil`.
+ */
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                           path:(NSString *)path
+            destinationFilePath:(NSString *)destinationFilePath;
+
+/**
+ Revives a byte-range download from a journal written by a previous download.
+
+ @param journalPath The path of the journal. Must not be `nil`.
+ @param manager The manager used to send requests. Must not be `nil`.
+ @param error If the journal cannot be read, upon return contains an `NSError` object that describes the problem.
+
+ @return The revived download, which has not been started, or `nil` if the journal cannot be read.
+ */
++ (instancetype)byteRangeDownloadWithJournalAtPath:(NSString *)journalPath
+                                           manager:(AFAmazonS3Manager *)manager
+                                             error:(NSError * __autoreleasing *)error;
+
+/**
+ Inspects the object and begins fetching ranges, or the ranges that remain to be fetched if the download was revived from a journal.
+
+ @param progress A block object to be called as ranges are downloaded from the server. This block has no return value and takes three arguments: the number of bytes read since the last time the download progress block was called, the total bytes read across all ranges, and the size of the object. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the whole object has been written to the destination file. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the object could not be downloaded. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+ */
+- (void)startWithProgress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                  success:(void (^)(id responseObject))success
+                  failure:(void (^)(NSError *error))failure;
+
+/**
+ Cancels any ranges in flight. The failure block is called with an `NSURLErrorCancelled` error.
+ */
+- (void)cancel;
+
+@end
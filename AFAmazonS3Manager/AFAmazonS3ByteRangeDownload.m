@@ -0,0 +1,763 @@
+// AFAmazonS3ByteRangeDownload.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3ByteRangeDownload.h"
+#import "AFAmazonS3Manager.h"
+#import "AFAmazonS3ResponseSerializer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static unsigned long long const AFAmazonS3MinimumByteRangeSplitLength = 1024 * 1024;
+
+static void * AFAmazonS3ByteRangeDownloadProcessingQueueKey = &AFAmazonS3ByteRangeDownloadProcessingQueueKey;
+
+static BOOL AFPreallocateFileWithDescriptor(int fileDescriptor, unsigned long long length, NSError * __autoreleasing *error) {
+#if defined(F_PREALLOCATE)
+    fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, (off_t)length, 0};
+    if (fcntl(fileDescriptor, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        fcntl(fileDescriptor, F_PREALLOCATE, &store);
+    }
+#endif
+
+    if (ftruncate(fileDescriptor, (off_t)length) == -1) {
+        if (error) {
+            *error = [[NSError alloc] initWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        }
+
+        return NO;
+    }
+
+    return YES;
+}
+
+#pragma mark -
+
+/**
+ Writes the bytes it receives into a file, starting at an offset and stopping at an end offset. Bytes past the end offset are discarded, which allows the end offset to be moved closer while the stream is in use.
+ */
+@interface AFAmazonS3FileRangeOutputStream : NSOutputStream
+
+- (instancetype)initWithFileHandle:(NSFileHandle *)fileHandle
+                            offset:(unsigned long long)offset
+                         endOffset:(unsigned long long)endOffset;
+
+- (unsigned long long)offset;
+- (unsigned long long)endOffset;
+
+/**
+ Moves the end offset to the middle of the bytes not yet written, and returns the new end offset. Returns `0` if fewer than twice `minimumLength` bytes remain.
+ */
+- (unsigned long long)splitRemainingBytesWithMinimumLength:(unsigned long long)minimumLength;
+
+@end
+
+@interface AFAmazonS3FileRangeOutputStream ()
+@property (readwrite, nonatomic, strong) NSFileHandle *fileHandle;
+@property (readwrite, nonatomic, assign) NSStreamStatus streamStatus;
+@property (readwrite, nonatomic, strong) NSError *streamError;
+@end
+
+@implementation AFAmazonS3FileRangeOutputStream {
+    unsigned long long _offset;
+    unsigned long long _endOffset;
+}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wimplicit-atomic-properties"
+@synthesize delegate;
+#pragma clang diagnostic pop
+@synthesize streamStatus;
+@synthesize streamError;
+
+- (instancetype)initWithFileHandle:(NSFileHandle *)fileHandle
+                            offset:(unsigned long long)offset
+                         endOffset:(unsigned long long)endOffset
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.fileHandle = fileHandle;
+    _offset = offset;
+    _endOffset = endOffset;
+
+    return self;
+}
+
+- (unsigned long long)offset {
+    @synchronized(self) {
+        return _offset;
+    }
+}
+
+- (unsigned long long)endOffset {
+    @synchronized(self) {
+        return _endOffset;
+    }
+}
+
+- (unsigned long long)splitRemainingBytesWithMinimumLength:(unsigned long long)minimumLength {
+    @synchronized(self) {
+        if (_endOffset <= _offset || _endOffset - _offset < minimumLength * 2) {
+            return 0;
+        }
+
+        _endOffset = _offset + (_endOffset - _offset) / 2;
+
+        return _endOffset;
+    }
+}
+
+#pragma mark - NSOutputStream
+
+- (BOOL)hasSpaceAvailable {
+    return self.streamStatus == NSStreamStatusOpen;
+}
+
+- (NSInteger)write:(const uint8_t *)buffer
+         maxLength:(NSUInteger)length
+{
+    @synchronized(self) {
+        if (self.streamStatus != NSStreamStatusOpen) {
+            return -1;
+        }
+
+        NSUInteger numberOfBytesToWrite = (NSUInteger)MIN((unsigned long long)length, _endOffset > _offset ? _endOffset - _offset : 0);
+        NSUInteger numberOfBytesWritten = 0;
+        int fileDescriptor = [self.fileHandle fileDescriptor];
+
+        while (numberOfBytesWritten < numberOfBytesToWrite) {
+            ssize_t result = pwrite(fileDescriptor, buffer + numberOfBytesWritten, numberOfBytesToWrite - numberOfBytesWritten, (off_t)(_offset + numberOfBytesWritten));
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                self.streamError = [[NSError alloc] initWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+                self.streamStatus = NSStreamStatusError;
+
+                return -1;
+            }
+
+            numberOfBytesWritten += (NSUInteger)result;
+        }
+
+        _offset += numberOfBytesWritten;
+
+        // Bytes past the end offset belong to another range, and are consumed without being written
+        return (NSInteger)length;
+    }
+}
+
+#pragma mark - NSStream
+
+- (void)open {
+    if (self.streamStatus == NSStreamStatusOpen) {
+        return;
+    }
+
+    self.streamStatus = NSStreamStatusOpen;
+}
+
+- (void)close {
+    self.streamStatus = NSStreamStatusClosed;
+}
+
+- (id)propertyForKey:(__unused NSString *)key {
+    return nil;
+}
+
+- (BOOL)setProperty:(__unused id)property
+             forKey:(__unused NSString *)key
+{
+    return NO;
+}
+
+- (void)scheduleInRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+- (void)removeFromRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+@end
+
+#pragma mark -
+
+@interface AFAmazonS3ByteRange : NSObject
+@property (readwrite, nonatomic, assign) unsigned long long firstByte;
+@property (readwrite, nonatomic, assign) unsigned long long endByte;
+@property (readwrite, nonatomic, assign) unsigned long long reportedOffset;
+@property (readwrite, nonatomic, assign) NSUInteger retryCount;
+@property (readwrite, nonatomic, strong) AFAmazonS3FileRangeOutputStream *outputStream;
+@property (readwrite, nonatomic, weak) AFHTTPRequestOperation *operation;
+@end
+
+@implementation AFAmazonS3ByteRange
+@end
+
+#pragma mark -
+
+@interface AFAmazonS3ByteRangeDownload ()
+@property (readwrite, nonatomic, copy) NSString *path;
+@property (readwrite, nonatomic, copy) NSString *destinationFilePath;
+@property (readwrite, nonatomic, copy) NSString *ETag;
+@property (readwrite, nonatomic, assign) unsigned long long contentLength;
+@property (readwrite, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+@property (readwrite, nonatomic, assign, getter = isFinished) BOOL finished;
+@property (readwrite, nonatomic, strong) NSHTTPURLResponse *response;
+@property (readwrite, nonatomic, strong) NSFileHandle *fileHandle;
+@property (readwrite, nonatomic, strong) NSMutableArray *pendingRanges;
+@property (readwrite, nonatomic, strong) NSMutableArray *rangesInFlight;
+@property (readwrite, nonatomic, copy) NSArray *journaledRanges;
+@property (readwrite, nonatomic, assign) long long totalBytesRead;
+@property (readwrite, nonatomic, strong) dispatch_queue_t processingQueue;
+@property (readwrite, nonatomic, copy) void (^progress)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead);
+@property (readwrite, nonatomic, copy) void (^success)(id responseObject);
+@property (readwrite, nonatomic, copy) void (^failure)(NSError *error);
+@end
+
+@implementation AFAmazonS3ByteRangeDownload
+
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                           path:(NSString *)path
+            destinationFilePath:(NSString *)destinationFilePath
+{
+    NSParameterAssert(manager);
+    NSParameterAssert(path);
+    NSParameterAssert(destinationFilePath);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.manager = manager;
+    self.path = path;
+    self.destinationFilePath = destinationFilePath;
+
+    self.rangeSize = manager.byteRangeDownloadSize;
+    self.maximumConcurrentRanges = manager.maximumConcurrentByteRangeDownloads;
+    self.maximumRangeRetryCount = manager.maximumByteRangeDownloadRetryCount;
+
+    [self commonInit];
+
+    return self;
+}
+
+- (void)commonInit {
+    self.pendingRanges = [NSMutableArray array];
+    self.rangesInFlight = [NSMutableArray array];
+
+    self.processingQueue = dispatch_queue_create("com.alamofire.networking.s3.byte-range-download", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(self.processingQueue, AFAmazonS3ByteRangeDownloadProcessingQueueKey, (__bridge void *)self, NULL);
+}
+
++ (instancetype)byteRangeDownloadWithJournalAtPath:(NSString *)journalPath
+                                           manager:(AFAmazonS3Manager *)manager
+                                             error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(journalPath);
+    NSParameterAssert(manager);
+
+    NSData *data = [NSData dataWithContentsOfFile:journalPath options:0 error:error];
+    if (!data) {
+        return nil;
+    }
+
+    AFAmazonS3ByteRangeDownload *download = nil;
+    @try {
+        NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+        unarchiver.requiresSecureCoding = YES;
+        download = [unarchiver decodeObjectOfClass:self forKey:NSKeyedArchiveRootObjectKey];
+        [unarchiver finishDecoding];
+    } @catch (__unused NSException *exception) {
+        download = nil;
+    }
+
+    if (!download) {
+        if (error) {
+            *error = [[NSError alloc] initWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSFilePathErrorKey: journalPath}];
+        }
+
+        return nil;
+    }
+
+    download.manager = manager;
+    download.journalPath = journalPath;
+
+    return download;
+}
+
+- (void)startWithProgress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                  success:(void (^)(id responseObject))success
+                  failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(self.manager);
+
+    self.progress = progress;
+    self.success = success;
+    self.failure = failure;
+
+    [self.manager headObjectWithPath:self.path success:^(NSHTTPURLResponse *response) {
+        dispatch_async(self.processingQueue, ^{
+            [self prepareWithResponse:response];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self finishWithError:error];
+        });
+    }];
+}
+
+- (void)cancel {
+    dispatch_async(self.processingQueue, ^{
+        if (self.finished) {
+            return;
+        }
+
+        self.cancelled = YES;
+
+        NSDictionary *userInfo = @{
+                                   NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Download cancelled", @"AFAmazonS3Manager", nil)
+                                   };
+
+        [self failWithError:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCancelled userInfo:userInfo]];
+    });
+}
+
+#pragma mark -
+
+- (void)prepareWithResponse:(NSHTTPURLResponse *)response {
+    if (self.finished) {
+        return;
+    }
+
+    NSString *ETag = [[AFAmazonS3ResponseObject responseObject:response] ETag];
+    NSString *contentLengthString = response.allHeaderFields[@"Content-Length"];
+    unsigned long long contentLength = contentLengthString ? strtoull([contentLengthString UTF8String], NULL, 10) : (unsigned long long)MAX([response expectedContentLength], 0LL);
+
+    // Bytes already in the destination file are only kept if they belong to the same version of the object
+    NSArray *journaledRanges = self.journaledRanges;
+    self.journaledRanges = nil;
+    if (journaledRanges && ETag && [ETag isEqualToString:self.ETag] && contentLength == self.contentLength) {
+        NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:self.destinationFilePath error:nil];
+        if (!attributes || [attributes fileSize] != contentLength) {
+            journaledRanges = nil;
+        }
+    } else {
+        journaledRanges = nil;
+    }
+
+    self.response = response;
+    self.ETag = ETag;
+    self.contentLength = contentLength;
+
+    if (!journaledRanges && ![[NSFileManager defaultManager] createFileAtPath:self.destinationFilePath contents:nil attributes:nil]) {
+        [self finishWithError:[[NSError alloc] initWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: self.destinationFilePath}]];
+        return;
+    }
+
+    int fileDescriptor = open([self.destinationFilePath fileSystemRepresentation], O_RDWR);
+    if (fileDescriptor == -1) {
+        [self finishWithError:[[NSError alloc] initWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey: self.destinationFilePath}]];
+        return;
+    }
+
+    // Range output streams retain the file handle, so the descriptor stays valid until the last of them is released
+    self.fileHandle = [[NSFileHandle alloc] initWithFileDescriptor:fileDescriptor closeOnDealloc:YES];
+
+    if (journaledRanges) {
+        unsigned long long remainingLength = 0;
+        for (NSArray *journaledRange in journaledRanges) {
+            AFAmazonS3ByteRange *range = [[AFAmazonS3ByteRange alloc] init];
+            range.firstByte = [[journaledRange firstObject] unsignedLongLongValue];
+            range.endByte = MIN([[journaledRange lastObject] unsignedLongLongValue], self.contentLength);
+            if (range.firstByte >= range.endByte) {
+                continue;
+            }
+
+            [self.pendingRanges addObject:range];
+            remainingLength += range.endByte - range.firstByte;
+        }
+
+        self.totalBytesRead = (long long)(self.contentLength - MIN(remainingLength, self.contentLength));
+    } else {
+        NSError *error = nil;
+        if (!AFPreallocateFileWithDescriptor(fileDescriptor, self.contentLength, &error)) {
+            [self finishWithError:error];
+            return;
+        }
+
+        unsigned long long rangeSize = MAX(self.rangeSize, 1ULL);
+        for (unsigned long long offset = 0; offset < self.contentLength; offset += rangeSize) {
+            AFAmazonS3ByteRange *range = [[AFAmazonS3ByteRange alloc] init];
+            range.firstByte = offset;
+            range.endByte = MIN(offset + rangeSize, self.contentLength);
+            [self.pendingRanges addObject:range];
+        }
+    }
+
+    [self writeJournal];
+    [self fetchNextRanges];
+}
+
+- (NSArray *)remainingRanges {
+    NSMutableArray *mutableRanges = [NSMutableArray arrayWithCapacity:[self.pendingRanges count] + [self.rangesInFlight count]];
+    // Bytes of a range in flight have not been verified yet, so the whole range is recorded as remaining
+    for (AFAmazonS3ByteRange *range in self.rangesInFlight) {
+        unsigned long long offset = range.firstByte;
+        unsigned long long endOffset = range.outputStream ? range.outputStream.endOffset : range.endByte;
+        if (offset < endOffset) {
+            [mutableRanges addObject:@[@(offset), @(endOffset)]];
+        }
+    }
+
+    for (AFAmazonS3ByteRange *range in self.pendingRanges) {
+        [mutableRanges addObject:@[@(range.firstByte), @(range.endByte)]];
+    }
+
+    return mutableRanges;
+}
+
+- (void)writeJournal {
+    if (!self.journalPath || !self.fileHandle) {
+        return;
+    }
+
+    // Bytes written before a range is left out of the journal must reach the disk before the journal does
+    [self.fileHandle synchronizeFile];
+    [[NSKeyedArchiver archivedDataWithRootObject:self] writeToFile:self.journalPath atomically:YES];
+}
+
+- (void)removeJournal {
+    if (!self.journalPath) {
+        return;
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:self.journalPath error:nil];
+}
+
+- (void)fetchNextRanges {
+    if (self.finished) {
+        return;
+    }
+
+    while ([self.rangesInFlight count] < MAX(self.maximumConcurrentRanges, (NSUInteger)1)) {
+        if ([self.pendingRanges count] == 0 && ![self splitLargestRangeInFlight]) {
+            break;
+        }
+
+        AFAmazonS3ByteRange *range = [self.pendingRanges firstObject];
+        [self.pendingRanges removeObjectAtIndex:0];
+
+        [self fetchRange:range];
+    }
+
+    if ([self.rangesInFlight count] == 0 && [self.pendingRanges count] == 0) {
+        [self finishWithError:nil];
+    }
+}
+
+- (BOOL)splitLargestRangeInFlight {
+    AFAmazonS3ByteRange *largestRange = nil;
+    unsigned long long largestRemainingLength = 0;
+    for (AFAmazonS3ByteRange *range in self.rangesInFlight) {
+        unsigned long long offset = range.outputStream.offset;
+        unsigned long long endOffset = range.outputStream.endOffset;
+        if (endOffset > offset && endOffset - offset > largestRemainingLength) {
+            largestRange = range;
+            largestRemainingLength = endOffset - offset;
+        }
+    }
+
+    unsigned long long splitOffset = [largestRange.outputStream splitRemainingBytesWithMinimumLength:AFAmazonS3MinimumByteRangeSplitLength];
+    if (splitOffset == 0) {
+        return NO;
+    }
+
+    AFAmazonS3ByteRange *range = [[AFAmazonS3ByteRange alloc] init];
+    range.firstByte = splitOffset;
+    range.endByte = largestRange.endByte;
+    largestRange.endByte = splitOffset;
+    [self.pendingRanges addObject:range];
+
+    return YES;
+}
+
+- (void)fetchRange:(AFAmazonS3ByteRange *)range {
+    range.outputStream = [[AFAmazonS3FileRangeOutputStream alloc] initWithFileHandle:self.fileHandle offset:range.firstByte endOffset:range.endByte];
+    range.reportedOffset = range.firstByte;
+    [self.rangesInFlight addObject:range];
+
+    range.operation = [self.manager getObjectWithPath:self.path firstByte:range.firstByte lastByte:range.endByte - 1 outputStream:range.outputStream progress:^(__unused NSUInteger bytesRead, __unused long long totalBytesRead, __unused long long totalBytesExpectedToRead) {
+        dispatch_async(self.processingQueue, ^{
+            [self rangeDidReceiveBytes:range];
+        });
+    } success:^(id responseObject) {
+        dispatch_async(self.processingQueue, ^{
+            [self range:range didFinishWithResponseObject:responseObject];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self range:range didFailWithError:error];
+        });
+    }];
+}
+
+- (void)reportProgressForRange:(AFAmazonS3ByteRange *)range {
+    unsigned long long offset = range.outputStream.offset;
+    if (offset <= range.reportedOffset) {
+        return;
+    }
+
+    NSUInteger bytesRead = (NSUInteger)(offset - range.reportedOffset);
+    range.reportedOffset = offset;
+    self.totalBytesRead += bytesRead;
+
+    void (^progress)(NSUInteger, long long, long long) = self.progress;
+    if (progress) {
+        long long total = self.totalBytesRead;
+        long long expected = (long long)self.contentLength;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            progress(bytesRead, total, expected);
+        });
+    }
+}
+
+- (void)rangeDidReceiveBytes:(AFAmazonS3ByteRange *)range {
+    if (self.finished || ![self.rangesInFlight containsObject:range]) {
+        return;
+    }
+
+    [self reportProgressForRange:range];
+
+    // A range that was split reaches its end before its response does
+    if (range.outputStream.offset >= range.outputStream.endOffset) {
+        NSError *error = [self errorForRangeResponse:range.operation.response];
+        if (error) {
+            [self failWithError:error];
+            return;
+        }
+
+        [self.rangesInFlight removeObject:range];
+        [range.operation cancel];
+
+        [self writeJournal];
+        [self fetchNextRanges];
+    }
+}
+
+- (NSError *)errorForRangeResponse:(NSHTTPURLResponse *)response {
+    NSString *description = nil;
+    NSString *ETag = [[AFAmazonS3ResponseObject responseObject:response] ETag];
+    if ([response statusCode] != 206) {
+        description = NSLocalizedStringFromTable(@"Byte range not honored by server", @"AFAmazonS3Manager", nil);
+    } else if (self.ETag && ETag && ![ETag isEqualToString:self.ETag]) {
+        description = NSLocalizedStringFromTable(@"Object changed during download", @"AFAmazonS3Manager", nil);
+    }
+
+    if (!description) {
+        return nil;
+    }
+
+    return [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorBadServerResponse userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+- (void)range:(AFAmazonS3ByteRange *)range
+didFinishWithResponseObject:(id)responseObject
+{
+    if (self.finished || ![self.rangesInFlight containsObject:range]) {
+        return;
+    }
+
+    [self reportProgressForRange:range];
+
+    if ([responseObject isKindOfClass:[AFAmazonS3ResponseObject class]]) {
+        NSError *error = [self errorForRangeResponse:[(AFAmazonS3ResponseObject *)responseObject originalResponse]];
+        if (error) {
+            [self failWithError:error];
+            return;
+        }
+    }
+
+    if (range.outputStream.offset < range.outputStream.endOffset) {
+        [self range:range didFailWithError:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil]];
+        return;
+    }
+
+    [self.rangesInFlight removeObject:range];
+    [self writeJournal];
+    [self fetchNextRanges];
+}
+
+- (void)range:(AFAmazonS3ByteRange *)range
+didFailWithError:(NSError *)error
+{
+    if (self.finished || ![self.rangesInFlight containsObject:range]) {
+        return;
+    }
+
+    [self reportProgressForRange:range];
+    [self.rangesInFlight removeObject:range];
+
+    // Bytes of a failed attempt are not trusted, so the range is fetched again from where the attempt started
+    unsigned long long endOffset = range.outputStream.endOffset;
+    self.totalBytesRead -= (long long)(range.reportedOffset - range.firstByte);
+
+    if (range.firstByte < endOffset) {
+        if (range.retryCount >= self.maximumRangeRetryCount) {
+            [self failWithError:error];
+            return;
+        }
+
+        AFAmazonS3ByteRange *remainingRange = [[AFAmazonS3ByteRange alloc] init];
+        remainingRange.firstByte = range.firstByte;
+        remainingRange.endByte = endOffset;
+        remainingRange.retryCount = range.retryCount + 1;
+        [self.pendingRanges insertObject:remainingRange atIndex:0];
+    }
+
+    [self fetchNextRanges];
+}
+
+- (void)failWithError:(NSError *)error {
+    for (AFAmazonS3ByteRange *range in self.rangesInFlight) {
+        [range.operation cancel];
+    }
+
+    // A journaled download keeps the bytes it has written so that it can be resumed, unless it was cancelled
+    if (self.cancelled) {
+        [self removeJournal];
+    } else {
+        [self writeJournal];
+    }
+
+    [self.rangesInFlight removeAllObjects];
+    [self.pendingRanges removeAllObjects];
+
+    [self finishWithError:error];
+}
+
+- (void)finishWithError:(NSError *)error {
+    if (self.finished) {
+        return;
+    }
+
+    self.finished = YES;
+
+    if (!error) {
+        [self removeJournal];
+    }
+
+    self.fileHandle = nil;
+
+    id responseObject = self.response ? [AFAmazonS3ResponseObject responseObject:self.response] : nil;
+    void (^success)(id) = self.success;
+    void (^failure)(NSError *) = self.failure;
+
+    self.progress = nil;
+    self.success = nil;
+    self.failure = nil;
+
+    dispatch_async(self.manager.completionQueue ?: dispatch_get_main_queue(), ^{
+        if (error) {
+            if (failure) {
+                failure(error);
+            }
+        } else {
+            if (success) {
+                success(responseObject);
+            }
+        }
+    });
+}
+
+#pragma mark - NSSecureCoding
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (id)initWithCoder:(NSCoder *)decoder {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.path = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(path))];
+    self.destinationFilePath = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(destinationFilePath))];
+    self.ETag = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(ETag))];
+    self.journalPath = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(journalPath))];
+    self.contentLength = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(contentLength))] unsignedLongLongValue];
+    self.rangeSize = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(rangeSize))] unsignedLongLongValue];
+    self.maximumConcurrentRanges = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumConcurrentRanges))] unsignedIntegerValue];
+    self.maximumRangeRetryCount = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumRangeRetryCount))] unsignedIntegerValue];
+    self.journaledRanges = [decoder decodeObjectOfClasses:[NSSet setWithObjects:[NSArray class], [NSNumber class], nil] forKey:NSStringFromSelector(@selector(remainingRanges))];
+
+    if (!self.path || !self.destinationFilePath) {
+        return nil;
+    }
+
+    [self commonInit];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    void (^encode)(void) = ^{
+        [coder encodeObject:self.path forKey:NSStringFromSelector(@selector(path))];
+        [coder encodeObject:self.destinationFilePath forKey:NSStringFromSelector(@selector(destinationFilePath))];
+        [coder encodeObject:self.ETag forKey:NSStringFromSelector(@selector(ETag))];
+        [coder encodeObject:self.journalPath forKey:NSStringFromSelector(@selector(journalPath))];
+        [coder encodeObject:@(self.contentLength) forKey:NSStringFromSelector(@selector(contentLength))];
+        [coder encodeObject:@(self.rangeSize) forKey:NSStringFromSelector(@selector(rangeSize))];
+        [coder encodeObject:@(self.maximumConcurrentRanges) forKey:NSStringFromSelector(@selector(maximumConcurrentRanges))];
+        [coder encodeObject:@(self.maximumRangeRetryCount) forKey:NSStringFromSelector(@selector(maximumRangeRetryCount))];
+
+        // Ranges are only recorded once the object has been inspected
+        if (self.fileHandle) {
+            [coder encodeObject:[self remainingRanges] forKey:NSStringFromSelector(@selector(remainingRanges))];
+        } else if (self.journaledRanges) {
+            [coder encodeObject:self.journaledRanges forKey:NSStringFromSelector(@selector(remainingRanges))];
+        }
+    };
+
+    // The state of the download is only changed on the processing queue, which is also where the journal is written
+    if (dispatch_get_specific(AFAmazonS3ByteRangeDownloadProcessingQueueKey) == (__bridge void *)self) {
+        encode();
+    } else {
+        dispatch_sync(self.processingQueue, encode);
+    }
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, path: %@, destinationFilePath: %@, ETag: %@, contentLength: %llu>", NSStringFromClass([self class]), self, self.path, self.destinationFilePath, self.ETag, self.contentLength];
+}
+
+@end
@@ -0,0 +1,83 @@
+// AFAmazonS3DigestStream.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ `AFAmazonS3DigestInputStream` computes the MD5 digest of the bytes read from another input stream as they are read, so that a streamed request body can be verified without reading it twice.
+ */
+@interface AFAmazonS3DigestInputStream : NSInputStream
+
+/**
+ The stream the bytes are read from.
+ */
+@property (readonly, nonatomic, strong) NSInputStream *inputStream;
+
+/**
+ The number of bytes read so far.
+ */
+@property (readonly, nonatomic, assign) unsigned long long numberOfBytesRead;
+
+/**
+ Initializes a stream that reads from the specified stream.
+
+ @param inputStream The stream to read from. Must not be `nil`.
+ */
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream;
+
+/**
+ Returns the MD5 digest of the bytes read so far.
+ */
+- (NSData *)MD5Digest;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFAmazonS3DigestOutputStream` computes the MD5 digest of the bytes written to another output stream as they are written, so that a response body can be verified as it is received.
+ */
+@interface AFAmazonS3DigestOutputStream : NSOutputStream
+
+/**
+ The stream the bytes are written to.
+ */
+@property (readonly, nonatomic, strong) NSOutputStream *outputStream;
+
+/**
+ The number of bytes written so far.
+ */
+@property (readonly, nonatomic, assign) unsigned long long numberOfBytesWritten;
+
+/**
+ Initializes a stream that writes to the specified stream.
+
+ @param outputStream The stream to write to. Must not be `nil`.
+ */
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream;
+
+/**
+ Returns the MD5 digest of the bytes written so far.
+ */
+- (NSData *)MD5Digest;
+
+@end
@@ -0,0 +1,251 @@
+// AFAmazonS3DigestStream.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3DigestStream.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+static NSData * AFMD5DigestFromContext(const CC_MD5_CTX *context) {
+    // The context is finalized as a copy, so that the digest can be read while hashing continues
+    CC_MD5_CTX finalContext = *context;
+
+    unsigned char digest[CC_MD5_DIGEST_LENGTH];
+    CC_MD5_Final(digest, &finalContext);
+
+    return [NSData dataWithBytes:digest length:CC_MD5_DIGEST_LENGTH];
+}
+
+@interface AFAmazonS3DigestInputStream ()
+@property (readwrite, nonatomic, strong) NSInputStream *inputStream;
+@property (readwrite, nonatomic, assign) unsigned long long numberOfBytesRead;
+@property (readwrite, nonatomic, assign) NSStreamStatus streamStatus;
+@property (readwrite, nonatomic, strong) NSError *streamError;
+@end
+
+@implementation AFAmazonS3DigestInputStream {
+    CC_MD5_CTX _MD5Context;
+}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wimplicit-atomic-properties"
+@synthesize delegate;
+#pragma clang diagnostic pop
+@synthesize streamStatus;
+@synthesize streamError;
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream {
+    NSParameterAssert(inputStream);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.inputStream = inputStream;
+    CC_MD5_Init(&_MD5Context);
+
+    return self;
+}
+
+- (NSData *)MD5Digest {
+    return AFMD5DigestFromContext(&_MD5Context);
+}
+
+#pragma mark - NSInputStream
+
+- (NSInteger)read:(uint8_t *)buffer
+        maxLength:(NSUInteger)length
+{
+    if ([self streamStatus] == NSStreamStatusClosed) {
+        return 0;
+    }
+
+    NSInteger numberOfBytesRead = [self.inputStream read:buffer maxLength:length];
+    if (numberOfBytesRead > 0) {
+        CC_MD5_Update(&_MD5Context, buffer, (CC_LONG)numberOfBytesRead);
+        self.numberOfBytesRead += (unsigned long long)numberOfBytesRead;
+    } else if (numberOfBytesRead == 0) {
+        self.streamStatus = NSStreamStatusAtEnd;
+    } else {
+        self.streamError = [self.inputStream streamError];
+        self.streamStatus = NSStreamStatusError;
+    }
+
+    return numberOfBytesRead;
+}
+
+- (BOOL)getBuffer:(__unused uint8_t **)buffer
+           length:(__unused NSUInteger *)len
+{
+    return NO;
+}
+
+- (BOOL)hasBytesAvailable {
+    return [self streamStatus] == NSStreamStatusOpen;
+}
+
+#pragma mark - NSStream
+
+- (void)open {
+    if (self.streamStatus == NSStreamStatusOpen) {
+        return;
+    }
+
+    self.streamStatus = NSStreamStatusOpen;
+
+    [self.inputStream open];
+}
+
+- (void)close {
+    self.streamStatus = NSStreamStatusClosed;
+
+    [self.inputStream close];
+}
+
+- (id)propertyForKey:(__unused NSString *)key {
+    return nil;
+}
+
+- (BOOL)setProperty:(__unused id)property
+             forKey:(__unused NSString *)key
+{
+    return NO;
+}
+
+- (void)scheduleInRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+- (void)removeFromRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+#pragma mark - Undocumented CFReadStream Bridged Methods
+
+- (void)_scheduleInCFRunLoop:(__unused CFRunLoopRef)aRunLoop
+                     forMode:(__unused CFStringRef)aMode
+{}
+
+- (void)_unscheduleFromCFRunLoop:(__unused CFRunLoopRef)aRunLoop
+                         forMode:(__unused CFStringRef)aMode
+{}
+
+- (BOOL)_setCFClientFlags:(__unused CFOptionFlags)inFlags
+                 callback:(__unused CFReadStreamClientCallBack)inCallback
+                  context:(__unused CFStreamClientContext *)inContext {
+    return NO;
+}
+
+@end
+
+#pragma mark -
+
+@interface AFAmazonS3DigestOutputStream ()
+@property (readwrite, nonatomic, strong) NSOutputStream *outputStream;
+@property (readwrite, nonatomic, assign) unsigned long long numberOfBytesWritten;
+@end
+
+@implementation AFAmazonS3DigestOutputStream {
+    CC_MD5_CTX _MD5Context;
+}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wimplicit-atomic-properties"
+@synthesize delegate;
+#pragma clang diagnostic pop
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream {
+    NSParameterAssert(outputStream);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.outputStream = outputStream;
+    CC_MD5_Init(&_MD5Context);
+
+    return self;
+}
+
+- (NSData *)MD5Digest {
+    return AFMD5DigestFromContext(&_MD5Context);
+}
+
+#pragma mark - NSOutputStream
+
+- (NSInteger)write:(const uint8_t *)buffer
+         maxLength:(NSUInteger)length
+{
+    NSInteger numberOfBytesWritten = [self.outputStream write:buffer maxLength:length];
+    if (numberOfBytesWritten > 0) {
+        // Only the bytes the destination accepted are hashed, since the rest will be written again
+        CC_MD5_Update(&_MD5Context, buffer, (CC_LONG)numberOfBytesWritten);
+        self.numberOfBytesWritten += (unsigned long long)numberOfBytesWritten;
+    }
+
+    return numberOfBytesWritten;
+}
+
+- (BOOL)hasSpaceAvailable {
+    return [self.outputStream hasSpaceAvailable];
+}
+
+#pragma mark - NSStream
+
+- (void)open {
+    [self.outputStream open];
+}
+
+- (void)close {
+    [self.outputStream close];
+}
+
+- (NSStreamStatus)streamStatus {
+    return [self.outputStream streamStatus];
+}
+
+- (NSError *)streamError {
+    return [self.outputStream streamError];
+}
+
+- (id)propertyForKey:(NSString *)key {
+    return [self.outputStream propertyForKey:key];
+}
+
+- (BOOL)setProperty:(id)property
+             forKey:(NSString *)key
+{
+    return [self.outputStream setProperty:property forKey:key];
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)aRunLoop
+                  forMode:(NSString *)mode
+{
+    [self.outputStream scheduleInRunLoop:aRunLoop forMode:mode];
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)aRunLoop
+                  forMode:(NSString *)mode
+{
+    [self.outputStream removeFromRunLoop:aRunLoop forMode:mode];
+}
+
+@end
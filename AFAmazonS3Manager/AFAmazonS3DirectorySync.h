@@ -0,0 +1,136 @@
+// AFAmazonS3DirectorySync.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class AFAmazonS3Manager;
+
+/**
+ The direction in which a directory is synchronized.
+
+ - `AFAmazonS3DirectorySyncUpload`: The objects under the prefix are brought up to date with the local directory.
+ - `AFAmazonS3DirectorySyncDownload`: The local directory is brought up to date with the objects under the prefix.
+ */
+typedef NS_ENUM(NSInteger, AFAmazonS3DirectorySyncDirection) {
+    AFAmazonS3DirectorySyncUpload = 0,
+    AFAmazonS3DirectorySyncDownload,
+};
+
+/**
+ `AFAmazonS3DirectorySync` mirrors a local directory to the objects under a key prefix, or the objects under a key prefix to a local directory.
+
+ @discussion The prefix is listed once, and each object is recorded in an index keyed by its path relative to the prefix. The local directory is then walked, and each file is looked up in the index. A file is transferred if it has no object, if its size differs from the size of its object, or if the source is more recent than the destination. Only the files that need to be transferred cause requests, so unchanged files cost no more than their line in the listing.
+
+ Transfers are started as the directory is walked, and at most `maximumConcurrentOperations` are in flight at once. The walk is paused while every slot is in use, so the memory used by a sync is proportional to the number of objects under the prefix, rather than to the number of files to transfer or to their contents. Files larger than the manager's `multipartUploadPartSize` are sent with a multipart upload, and objects larger than its `byteRangeDownloadSize` are fetched with a byte-range download.
+
+ Downloaded files are written to a hidden directory inside the local directory, and moved into place once complete, with their modification date set to that of their object. Objects whose key, relative to the prefix, has a leading `/`, an empty component, or a `.` or `..` component are never transferred or deleted, and are reported as errors. An object is not downloaded either if an existing parent of its local path is a symbolic link, or is not a directory, since a link inside the directory could otherwise lead the download outside of it.
+ */
+@interface AFAmazonS3DirectorySync : NSObject
+
+/**
+ The manager used to send requests.
+ */
+@property (readonly, nonatomic, strong) AFAmazonS3Manager *manager;
+
+/**
+ The path of the local directory.
+ */
+@property (readonly, nonatomic, copy) NSString *directoryPath;
+
+/**
+ The key prefix under which objects are mirrored. A trailing `/` is added to a prefix that does not have one.
+ */
+@property (readonly, nonatomic, copy) NSString *prefix;
+
+/**
+ The direction in which the directory is synchronized.
+ */
+@property (readonly, nonatomic, assign) AFAmazonS3DirectorySyncDirection direction;
+
+/**
+ Whether items at the destination that have no counterpart at the source are deleted. Objects are deleted with Multi-Object Delete, up to 1000 at a time. Local directories are left in place. `NO` by default.
+ */
+@property (nonatomic, assign) BOOL deletesExtraneousItems;
+
+/**
+ Whether a file with the same size as its object, but with a more recent modification date at the source, is compared with the `ETag` of the object before being transferred. The file is read to compute its MD5 digest, and is not transferred if the digest matches. Objects uploaded in parts have an `ETag` that is not a digest of their contents, and are always transferred. `NO` by default.
+ */
+@property (nonatomic, assign) BOOL comparesETags;
+
+/**
+ The maximum number of transfers and delete requests in flight at once. `8` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumConcurrentOperations;
+
+/**
+ The number of files uploaded.
+ */
+@property (readonly, nonatomic, assign) NSUInteger numberOfUploadedFiles;
+
+/**
+ The number of files downloaded.
+ */
+@property (readonly, nonatomic, assign) NSUInteger numberOfDownloadedFiles;
+
+/**
+ The number of objects or local files deleted.
+ */
+@property (readonly, nonatomic, assign) NSUInteger numberOfDeletedItems;
+
+/**
+ The number of files that were already up to date.
+ */
+@property (readonly, nonatomic, assign) NSUInteger numberOfUnchangedFiles;
+
+/**
+ Whether the sync has been cancelled.
+ */
+@property (readonly, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+
+/**
+ Initializes a sync between a local directory and the objects under a key prefix.
+
+ @param manager The manager used to send requests. Must not be `nil`.
+ @param directoryPath The path of the local directory. Must not be `nil`. When downloading, the directory is created if it does not exist.
+ @param prefix The key prefix under which objects are mirrored. If `nil`, the whole bucket is mirrored.
+ @param direction The direction in which the directory is synchronized.
+ */
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                  directoryPath:(NSString *)directoryPath
+                         prefix:(NSString *)prefix
+                      direction:(AFAmazonS3DirectorySyncDirection)direction;
+
+/**
+ Lists the objects under the prefix, walks the local directory, and transfers the files that are out of date.
+
+ @param success A block object to be executed once every transfer has finished. This block has no return value and takes a single argument: an `NSError` object for each file that could not be transferred or deleted, keyed by its path relative to the directory.
+ @param failure A block object to be executed when the objects could not be listed, or the local directory could not be read. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+ */
+- (void)startWithSuccess:(void (^)(NSDictionary *errorsByPath))success
+                 failure:(void (^)(NSError *error))failure;
+
+/**
+ Cancels the listing and any transfers in flight. The failure block is called with an `NSURLErrorCancelled` error.
+ */
+- (void)cancel;
+
+@end
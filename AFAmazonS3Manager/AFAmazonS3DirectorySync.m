@@ -0,0 +1,624 @@
+// AFAmazonS3DirectorySync.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3DirectorySync.h"
+#import "AFAmazonS3Manager.h"
+#import "AFAmazonS3ObjectEnumerator.h"
+#import "AFAmazonS3ResponseSerializer.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/stat.h>
+
+static NSUInteger const AFAmazonS3MaximumNumberOfKeysPerDeleteRequest = 1000;
+
+static NSString * AFMD5HexStringForFileAtPath(NSString *path) {
+    NSInputStream *inputStream = [NSInputStream inputStreamWithFileAtPath:path];
+    [inputStream open];
+
+    CC_MD5_CTX context;
+    CC_MD5_Init(&context);
+
+    uint8_t buffer[64 * 1024];
+    NSInteger numberOfBytesRead = 0;
+    while ((numberOfBytesRead = [inputStream read:buffer maxLength:sizeof(buffer)]) > 0) {
+        CC_MD5_Update(&context, buffer, (CC_LONG)numberOfBytesRead);
+    }
+
+    [inputStream close];
+
+    if (numberOfBytesRead < 0) {
+        return nil;
+    }
+
+    unsigned char digest[CC_MD5_DIGEST_LENGTH];
+    CC_MD5_Final(digest, &context);
+
+    NSMutableString *mutableString = [NSMutableString stringWithCapacity:CC_MD5_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_MD5_DIGEST_LENGTH; i++) {
+        [mutableString appendFormat:@"%02x", digest[i]];
+    }
+
+    return mutableString;
+}
+
+static BOOL AFRelativePathIsContainedInDirectory(NSString *relativePath) {
+    if ([relativePath length] == 0 || [relativePath hasPrefix:@"/"]) {
+        return NO;
+    }
+
+    for (NSString *component in [relativePath componentsSeparatedByString:@"/"]) {
+        if ([component length] == 0 || [component isEqualToString:@"."] || [component isEqualToString:@".."]) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+// Existing parents of a path are checked with `lstat` rather than followed, since a symbolic link would lead outside of the directory
+static BOOL AFRelativePathHasNoSymbolicLinkParents(NSString *directoryPath, NSString *relativePath) {
+    NSArray *components = [relativePath componentsSeparatedByString:@"/"];
+    NSString *path = directoryPath;
+    for (NSUInteger idx = 0; idx + 1 < [components count]; idx++) {
+        path = [path stringByAppendingPathComponent:components[idx]];
+
+        struct stat status;
+        if (lstat([path fileSystemRepresentation], &status) != 0) {
+            // Missing parents are created as plain directories
+            return errno == ENOENT;
+        }
+
+        if (!S_ISDIR(status.st_mode)) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+@interface AFAmazonS3DirectorySync ()
+@property (readwrite, nonatomic, strong) AFAmazonS3Manager *manager;
+@property (readwrite, nonatomic, copy) NSString *directoryPath;
+@property (readwrite, nonatomic, copy) NSString *prefix;
+@property (readwrite, nonatomic, assign) AFAmazonS3DirectorySyncDirection direction;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfUploadedFiles;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfDownloadedFiles;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfDeletedItems;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfUnchangedFiles;
+@property (readwrite, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+@property (readwrite, nonatomic, assign, getter = isFinished) BOOL finished;
+@property (readwrite, nonatomic, strong) AFAmazonS3ObjectEnumerator *objectEnumerator;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *objectSummariesByRelativePath;
+@property (readwrite, nonatomic, strong) NSDirectoryEnumerator *directoryEnumerator;
+@property (readwrite, nonatomic, strong) NSEnumerator *remainingRelativePathEnumerator;
+@property (readwrite, nonatomic, strong) NSMutableArray *pendingDeletePaths;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *operationsByIdentifier;
+@property (readwrite, nonatomic, assign) NSUInteger nextOperationIdentifier;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *errorsByPath;
+@property (readwrite, nonatomic, copy) NSString *temporaryDirectoryName;
+@property (readwrite, nonatomic, strong) dispatch_queue_t processingQueue;
+@property (readwrite, nonatomic, copy) void (^success)(NSDictionary *errorsByPath);
+@property (readwrite, nonatomic, copy) void (^failure)(NSError *error);
+@end
+
+@implementation AFAmazonS3DirectorySync
+
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                  directoryPath:(NSString *)directoryPath
+                         prefix:(NSString *)prefix
+                      direction:(AFAmazonS3DirectorySyncDirection)direction
+{
+    NSParameterAssert(manager);
+    NSParameterAssert(directoryPath);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    if ([prefix length] > 0 && ![prefix hasSuffix:@"/"]) {
+        prefix = [prefix stringByAppendingString:@"/"];
+    }
+
+    self.manager = manager;
+    self.directoryPath = directoryPath;
+    self.prefix = prefix ?: @"";
+    self.direction = direction;
+
+    self.maximumConcurrentOperations = 8;
+
+    self.objectSummariesByRelativePath = [NSMutableDictionary dictionary];
+    self.pendingDeletePaths = [NSMutableArray array];
+    self.operationsByIdentifier = [NSMutableDictionary dictionary];
+    self.errorsByPath = [NSMutableDictionary dictionary];
+    self.temporaryDirectoryName = [@".AFAmazonS3DirectorySync-" stringByAppendingString:[[NSUUID UUID] UUIDString]];
+
+    self.processingQueue = dispatch_queue_create("com.alamofire.networking.s3.directory-sync", DISPATCH_QUEUE_SERIAL);
+
+    return self;
+}
+
+- (void)startWithSuccess:(void (^)(NSDictionary *errorsByPath))success
+                 failure:(void (^)(NSError *error))failure
+{
+    self.success = success;
+    self.failure = failure;
+
+    NSUInteger prefixLength = [self.prefix length];
+    AFAmazonS3ObjectEnumerator *objectEnumerator = [[AFAmazonS3ObjectEnumerator alloc] initWithManager:self.manager prefix:([self.prefix length] > 0 ? self.prefix : nil) delimiter:nil];
+    self.objectEnumerator = objectEnumerator;
+
+    [objectEnumerator startWithPageBlock:^(AFAmazonS3ListBucketResult *page, __unused BOOL *stop) {
+        NSArray *objects = page.objects;
+        dispatch_async(self.processingQueue, ^{
+            if (self.finished) {
+                return;
+            }
+
+            for (AFAmazonS3ObjectSummary *summary in objects) {
+                // Keys ending in a delimiter are folder placeholders created by the S3 console, and have no local counterpart
+                if ([summary.key length] <= prefixLength || [summary.key hasSuffix:@"/"]) {
+                    continue;
+                }
+
+                // Keys may contain components that would resolve outside of the directory, so they are never mapped to a local path
+                NSString *relativePath = [summary.key substringFromIndex:prefixLength];
+                if (!AFRelativePathIsContainedInDirectory(relativePath)) {
+                    NSDictionary *userInfo = @{
+                                               NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Object key does not map to a path inside the directory", @"AFAmazonS3Manager", nil),
+                                               NSFilePathErrorKey: relativePath
+                                               };
+
+                    self.errorsByPath[relativePath] = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorBadURL userInfo:userInfo];
+                    continue;
+                }
+
+                self.objectSummariesByRelativePath[relativePath] = summary;
+            }
+        });
+    } success:^(__unused NSUInteger numberOfObjects) {
+        dispatch_async(self.processingQueue, ^{
+            [self beginWalkingDirectory];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self finishWithError:error];
+        });
+    }];
+}
+
+- (void)cancel {
+    dispatch_async(self.processingQueue, ^{
+        if (self.finished) {
+            return;
+        }
+
+        self.cancelled = YES;
+
+        [self.objectEnumerator cancel];
+
+        for (id operation in [self.operationsByIdentifier allValues]) {
+            if ([operation isKindOfClass:[NSArray class]]) {
+                [operation makeObjectsPerformSelector:@selector(cancel)];
+            } else if (operation != [NSNull null]) {
+                [operation cancel];
+            }
+        }
+
+        NSDictionary *userInfo = @{
+                                   NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Directory sync cancelled", @"AFAmazonS3Manager", nil)
+                                   };
+
+        [self finishWithError:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCancelled userInfo:userInfo]];
+    });
+}
+
+#pragma mark -
+
+- (NSString *)temporaryDirectoryPath {
+    return [self.directoryPath stringByAppendingPathComponent:self.temporaryDirectoryName];
+}
+
+- (void)beginWalkingDirectory {
+    if (self.finished) {
+        return;
+    }
+
+    self.objectEnumerator = nil;
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (self.direction == AFAmazonS3DirectorySyncDownload) {
+        NSError *error = nil;
+        if (![fileManager createDirectoryAtPath:[self temporaryDirectoryPath] withIntermediateDirectories:YES attributes:nil error:&error]) {
+            [self finishWithError:error];
+            return;
+        }
+    }
+
+    BOOL isDirectory = NO;
+    if (![fileManager fileExistsAtPath:self.directoryPath isDirectory:&isDirectory] || !isDirectory) {
+        [self finishWithError:[[NSError alloc] initWithDomain:NSCocoaErrorDomain code:NSFileReadNoSuchFileError userInfo:@{NSFilePathErrorKey: self.directoryPath}]];
+        return;
+    }
+
+    self.directoryEnumerator = [fileManager enumeratorAtPath:self.directoryPath];
+
+    [self startNextOperations];
+}
+
+- (void)startNextOperations {
+    if (self.finished) {
+        return;
+    }
+
+    while ([self.operationsByIdentifier count] < MAX(self.maximumConcurrentOperations, (NSUInteger)1)) {
+        if (![self startNextOperation]) {
+            break;
+        }
+    }
+
+    if ([self.operationsByIdentifier count] == 0) {
+        [self finishWithError:nil];
+    }
+}
+
+- (BOOL)startNextOperation {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+
+    while (self.directoryEnumerator) {
+        NSString *relativePath = [self.directoryEnumerator nextObject];
+        if (!relativePath) {
+            self.directoryEnumerator = nil;
+
+            // Objects left in the index have no local file
+            if (self.direction == AFAmazonS3DirectorySyncDownload || self.deletesExtraneousItems) {
+                self.remainingRelativePathEnumerator = [self.objectSummariesByRelativePath keyEnumerator];
+            } else {
+                self.objectSummariesByRelativePath = nil;
+            }
+
+            break;
+        }
+
+        if ([relativePath isEqualToString:self.temporaryDirectoryName]) {
+            [self.directoryEnumerator skipDescendants];
+            continue;
+        }
+
+        NSDictionary *attributes = [self.directoryEnumerator fileAttributes];
+        if (![[attributes fileType] isEqualToString:NSFileTypeRegular]) {
+            continue;
+        }
+
+        AFAmazonS3ObjectSummary *summary = self.objectSummariesByRelativePath[relativePath];
+        if (summary) {
+            [self.objectSummariesByRelativePath removeObjectForKey:relativePath];
+
+            if (![self shouldTransferFileAtRelativePath:relativePath attributes:attributes objectSummary:summary]) {
+                self.numberOfUnchangedFiles++;
+                continue;
+            }
+
+            if (self.direction == AFAmazonS3DirectorySyncUpload) {
+                [self uploadFileAtRelativePath:relativePath size:[attributes fileSize]];
+            } else {
+                [self downloadObjectWithSummary:summary relativePath:relativePath];
+            }
+
+            return YES;
+        }
+
+        if (self.direction == AFAmazonS3DirectorySyncUpload) {
+            [self uploadFileAtRelativePath:relativePath size:[attributes fileSize]];
+            return YES;
+        }
+
+        if (self.deletesExtraneousItems) {
+            NSError *error = nil;
+            if ([fileManager removeItemAtPath:[self.directoryPath stringByAppendingPathComponent:relativePath] error:&error]) {
+                self.numberOfDeletedItems++;
+            } else {
+                self.errorsByPath[relativePath] = error;
+            }
+        }
+    }
+
+    while (self.remainingRelativePathEnumerator) {
+        NSString *relativePath = [self.remainingRelativePathEnumerator nextObject];
+        if (!relativePath) {
+            self.remainingRelativePathEnumerator = nil;
+            self.objectSummariesByRelativePath = nil;
+            break;
+        }
+
+        if (self.direction == AFAmazonS3DirectorySyncDownload) {
+            [self downloadObjectWithSummary:self.objectSummariesByRelativePath[relativePath] relativePath:relativePath];
+            return YES;
+        }
+
+        [self.pendingDeletePaths addObject:relativePath];
+        if ([self.pendingDeletePaths count] >= AFAmazonS3MaximumNumberOfKeysPerDeleteRequest) {
+            [self deletePendingPaths];
+            return YES;
+        }
+    }
+
+    if ([self.pendingDeletePaths count] > 0) {
+        [self deletePendingPaths];
+        return YES;
+    }
+
+    return NO;
+}
+
+- (BOOL)shouldTransferFileAtRelativePath:(NSString *)relativePath
+                              attributes:(NSDictionary *)attributes
+                           objectSummary:(AFAmazonS3ObjectSummary *)summary
+{
+    if ([attributes fileSize] != summary.size) {
+        return YES;
+    }
+
+    NSDate *sourceDate = self.direction == AFAmazonS3DirectorySyncUpload ? [attributes fileModificationDate] : summary.lastModified;
+    NSDate *destinationDate = self.direction == AFAmazonS3DirectorySyncUpload ? summary.lastModified : [attributes fileModificationDate];
+    if (!sourceDate || !destinationDate || [sourceDate compare:destinationDate] != NSOrderedDescending) {
+        return NO;
+    }
+
+    if (!self.comparesETags) {
+        return YES;
+    }
+
+    NSString *ETag = [[summary.ETag stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\""]] lowercaseString];
+    if ([ETag length] != CC_MD5_DIGEST_LENGTH * 2 || [ETag rangeOfString:@"-"].location != NSNotFound) {
+        return YES;
+    }
+
+    NSString *filePath = [self.directoryPath stringByAppendingPathComponent:relativePath];
+    if (![ETag isEqualToString:AFMD5HexStringForFileAtPath(filePath)]) {
+        return YES;
+    }
+
+    // The file is the same as its object; bringing the dates in line spares the digest on the next sync
+    if (self.direction == AFAmazonS3DirectorySyncDownload) {
+        [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate: summary.lastModified} ofItemAtPath:filePath error:nil];
+    }
+
+    return NO;
+}
+
+- (NSNumber *)beginOperation {
+    NSNumber *identifier = @(self.nextOperationIdentifier++);
+    self.operationsByIdentifier[identifier] = [NSNull null];
+
+    return identifier;
+}
+
+- (void)setOperation:(id)operation
+       forIdentifier:(NSNumber *)identifier
+{
+    // An operation that could not be created is nil, and has already dispatched its failure
+    if (operation && self.operationsByIdentifier[identifier]) {
+        self.operationsByIdentifier[identifier] = operation;
+    }
+}
+
+- (void)operationWithIdentifier:(NSNumber *)identifier
+            didFinishWithErrors:(NSDictionary *)errorsByPath
+{
+    if (self.finished) {
+        return;
+    }
+
+    [self.operationsByIdentifier removeObjectForKey:identifier];
+    [self.errorsByPath addEntriesFromDictionary:errorsByPath];
+
+    [self startNextOperations];
+}
+
+- (void)uploadFileAtRelativePath:(NSString *)relativePath
+                            size:(unsigned long long)size
+{
+    NSNumber *identifier = [self beginOperation];
+    NSString *filePath = [self.directoryPath stringByAppendingPathComponent:relativePath];
+    NSString *destinationPath = [self.prefix stringByAppendingString:relativePath];
+
+    void (^success)(id) = ^(__unused id responseObject) {
+        dispatch_async(self.processingQueue, ^{
+            if (!self.finished) {
+                self.numberOfUploadedFiles++;
+            }
+
+            [self operationWithIdentifier:identifier didFinishWithErrors:nil];
+        });
+    };
+
+    void (^failure)(NSError *) = ^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self operationWithIdentifier:identifier didFinishWithErrors:@{relativePath: error}];
+        });
+    };
+
+    if (size > self.manager.multipartUploadPartSize) {
+        [self setOperation:[self.manager multipartUploadObjectWithFile:filePath destinationPath:destinationPath parameters:nil progress:nil success:success failure:failure] forIdentifier:identifier];
+    } else {
+        [self setOperation:[self.manager putObjectWithFile:filePath destinationPath:destinationPath parameters:nil progress:nil success:success failure:failure] forIdentifier:identifier];
+    }
+}
+
+- (void)downloadObjectWithSummary:(AFAmazonS3ObjectSummary *)summary
+                     relativePath:(NSString *)relativePath
+{
+    NSNumber *identifier = [self beginOperation];
+    NSString *temporaryFilePath = [[self temporaryDirectoryPath] stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+    void (^success)(id) = ^(__unused id responseObject) {
+        dispatch_async(self.processingQueue, ^{
+            if (self.finished) {
+                return;
+            }
+
+            NSError *error = nil;
+            if ([self moveDownloadedFileAtPath:temporaryFilePath toRelativePath:relativePath modificationDate:summary.lastModified error:&error]) {
+                self.numberOfDownloadedFiles++;
+                [self operationWithIdentifier:identifier didFinishWithErrors:nil];
+            } else {
+                [[NSFileManager defaultManager] removeItemAtPath:temporaryFilePath error:nil];
+                [self operationWithIdentifier:identifier didFinishWithErrors:@{relativePath: error}];
+            }
+        });
+    };
+
+    void (^failure)(NSError *) = ^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [[NSFileManager defaultManager] removeItemAtPath:temporaryFilePath error:nil];
+            [self operationWithIdentifier:identifier didFinishWithErrors:@{relativePath: error}];
+        });
+    };
+
+    if (summary.size > self.manager.byteRangeDownloadSize) {
+        [self setOperation:[self.manager downloadObjectWithPath:summary.key destinationFilePath:temporaryFilePath progress:nil success:success failure:failure] forIdentifier:identifier];
+    } else {
+        NSOutputStream *outputStream = [NSOutputStream outputStreamToFileAtPath:temporaryFilePath append:NO];
+        [self setOperation:[self.manager getObjectWithPath:summary.key outputStream:outputStream progress:nil success:success failure:failure] forIdentifier:identifier];
+    }
+}
+
+- (BOOL)moveDownloadedFileAtPath:(NSString *)temporaryFilePath
+                  toRelativePath:(NSString *)relativePath
+                modificationDate:(NSDate *)modificationDate
+                           error:(NSError * __autoreleasing *)error
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *filePath = [self.directoryPath stringByAppendingPathComponent:relativePath];
+
+    if (!AFRelativePathHasNoSymbolicLinkParents(self.directoryPath, relativePath)) {
+        if (error) {
+            NSDictionary *userInfo = @{
+                                       NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Object key does not map to a path inside the directory", @"AFAmazonS3Manager", nil),
+                                       NSFilePathErrorKey: relativePath
+                                       };
+
+            *error = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorBadURL userInfo:userInfo];
+        }
+
+        return NO;
+    }
+
+    if (modificationDate && ![fileManager setAttributes:@{NSFileModificationDate: modificationDate} ofItemAtPath:temporaryFilePath error:error]) {
+        return NO;
+    }
+
+    if (![fileManager createDirectoryAtPath:[filePath stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:error]) {
+        return NO;
+    }
+
+    // A symbolic link at the destination is replaced rather than followed, including one whose target is missing
+    if ([fileManager attributesOfItemAtPath:filePath error:nil] && ![fileManager removeItemAtPath:filePath error:error]) {
+        return NO;
+    }
+
+    return [fileManager moveItemAtPath:temporaryFilePath toPath:filePath error:error];
+}
+
+- (void)deletePendingPaths {
+    NSNumber *identifier = [self beginOperation];
+    NSUInteger prefixLength = [self.prefix length];
+
+    NSMutableArray *mutablePaths = [NSMutableArray arrayWithCapacity:[self.pendingDeletePaths count]];
+    for (NSString *relativePath in self.pendingDeletePaths) {
+        [mutablePaths addObject:[self.prefix stringByAppendingString:relativePath]];
+    }
+    [self.pendingDeletePaths removeAllObjects];
+
+    NSArray *operations = [self.manager deleteObjectsWithPaths:mutablePaths success:^(NSArray *deletedPaths, NSDictionary *errorsByPath) {
+        NSMutableDictionary *mutableErrorsByRelativePath = [NSMutableDictionary dictionaryWithCapacity:[errorsByPath count]];
+        [errorsByPath enumerateKeysAndObjectsUsingBlock:^(NSString *path, NSError *error, __unused BOOL *stop) {
+            mutableErrorsByRelativePath[[path length] >= prefixLength ? [path substringFromIndex:prefixLength] : path] = error;
+        }];
+
+        dispatch_async(self.processingQueue, ^{
+            if (!self.finished) {
+                self.numberOfDeletedItems += [deletedPaths count];
+            }
+
+            [self operationWithIdentifier:identifier didFinishWithErrors:mutableErrorsByRelativePath];
+        });
+    } failure:^(NSError *error) {
+        NSMutableDictionary *mutableErrorsByRelativePath = [NSMutableDictionary dictionaryWithCapacity:[mutablePaths count]];
+        for (NSString *path in mutablePaths) {
+            mutableErrorsByRelativePath[[path substringFromIndex:prefixLength]] = error;
+        }
+
+        dispatch_async(self.processingQueue, ^{
+            [self operationWithIdentifier:identifier didFinishWithErrors:mutableErrorsByRelativePath];
+        });
+    }];
+
+    [self setOperation:operations forIdentifier:identifier];
+}
+
+- (void)finishWithError:(NSError *)error {
+    if (self.finished) {
+        return;
+    }
+
+    self.finished = YES;
+
+    self.objectEnumerator = nil;
+    self.directoryEnumerator = nil;
+    self.remainingRelativePathEnumerator = nil;
+    self.objectSummariesByRelativePath = nil;
+    [self.pendingDeletePaths removeAllObjects];
+    [self.operationsByIdentifier removeAllObjects];
+
+    if (self.direction == AFAmazonS3DirectorySyncDownload) {
+        [[NSFileManager defaultManager] removeItemAtPath:[self temporaryDirectoryPath] error:nil];
+    }
+
+    NSDictionary *errorsByPath = [self.errorsByPath copy];
+    void (^success)(NSDictionary *) = self.success;
+    void (^failure)(NSError *) = self.failure;
+
+    self.success = nil;
+    self.failure = nil;
+
+    dispatch_async(self.manager.completionQueue ?: dispatch_get_main_queue(), ^{
+        if (error) {
+            if (failure) {
+                failure(error);
+            }
+        } else {
+            if (success) {
+                success(errorsByPath);
+            }
+        }
+    });
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, directoryPath: %@, prefix: %@, direction: %ld, uploaded: %lu, downloaded: %lu, deleted: %lu, unchanged: %lu>", NSStringFromClass([self class]), self, self.directoryPath, self.prefix, (long)self.direction, (unsigned long)self.numberOfUploadedFiles, (unsigned long)self.numberOfDownloadedFiles, (unsigned long)self.numberOfDeletedItems, (unsigned long)self.numberOfUnchangedFiles];
+}
+
+@end
@@ -22,6 +22,15 @@
 
 #import "AFHTTPRequestOperationManager.h"
 #import "AFAmazonS3RequestSerializer.h"
+#import "AFAmazonS3DirectorySync.h"
+
+@class AFAmazonS3MultipartUpload;
+@class AFAmazonS3ByteRangeDownload;
+@class AFAmazonS3ListBucketResult;
+@class AFAmazonS3ObjectEnumerator;
+@class AFAmazonS3ObjectCache;
+@class AFAmazonS3RequestScheduler;
+@class AFAmazonS3Metrics;
 
 /**
  AFAmazonS3Manager` is an `AFHTTPRequestOperationManager` subclass for interacting with the Amazon S3 webservice API (http://aws.amazon.com/s3/).
@@ -40,6 +49,71 @@
  */
 @property (nonatomic, strong) AFAmazonS3RequestSerializer <AFURLRequestSerialization> * requestSerializer;
 
+/**
+ The size, in bytes, of each range fetched by a byte-range download. `8 MB` by default.
+ */
+@property (nonatomic, assign) unsigned long long byteRangeDownloadSize;
+
+/**
+ The maximum number of ranges a byte-range download fetches at once. `4` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumConcurrentByteRangeDownloads;
+
+/**
+ The number of times a failed range is retried before a byte-range download fails. `3` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumByteRangeDownloadRetryCount;
+
+/**
+ Whether files uploaded with `postObjectWithFile:...` and `putObjectWithFile:...` are streamed from disk rather than read into memory before the request is sent. `NO` by default.
+
+ @discussion When `YES`, the request body is read from the file as it is sent, with `Content-Length` taken from the file attributes, so memory use does not grow with the size of the file and the calling thread does not block on reading it.
+ */
+@property (nonatomic, assign) BOOL shouldStreamFileUploads;
+
+/**
+ Whether the integrity of uploaded and downloaded objects is verified using MD5 digests. `NO` by default.
+
+ @discussion When `YES`, objects uploaded from memory with `putObjectWithFile:...` and parts uploaded with `uploadPartWithData:...` are sent with `Content-MD5`, which S3 checks before storing them. Streamed uploads and downloads with `getObjectWithPath:...` are hashed as the bytes pass through, and checked against the `ETag` of the object once the transfer finishes. A mismatch fails with an error with code `NSURLErrorCannotDecodeContentData`. Objects whose `ETag` is not an MD5 digest, such as those uploaded in parts or encrypted with KMS or customer-provided keys, are not checked, nor are byte ranges.
+ */
+@property (nonatomic, assign) BOOL shouldVerifyObjectIntegrity;
+
+/**
+ The size, in bytes, of each part sent by a multipart upload. `AFAmazonS3DefaultMultipartUploadPartSize` (8 MB) by default. Values smaller than `AFAmazonS3MinimumMultipartUploadPartSize` (5 MB) are rejected by S3 for all but the last part.
+
+ @discussion Parts are read from disk only when they are about to be sent, so the memory used by a multipart upload is bounded by `multipartUploadPartSize` multiplied by `maximumConcurrentMultipartUploadParts`.
+ */
+@property (nonatomic, assign) unsigned long long multipartUploadPartSize;
+
+/**
+ The maximum number of parts a multipart upload sends at once. `4` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumConcurrentMultipartUploadParts;
+
+/**
+ The number of times a failed part is retried before a multipart upload is aborted. `3` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumMultipartUploadPartRetryCount;
+
+/**
+ The cache used to answer repeated reads made with `getObjectWithPath:progress:success:failure:`. `nil` by default, which disables caching.
+
+ @discussion Cached objects are validated with `If-None-Match` requests, or returned without a request within the cache's freshness interval. Objects uploaded or deleted through this manager are removed from the cache.
+ */
+@property (nonatomic, strong) AFAmazonS3ObjectCache *objectCache;
+
+/**
+ The scheduler that admits request operations to the operation queue, limiting the concurrency of each bucket prefix and retrying failed idempotent requests. `nil` by default, which adds operations directly to the operation queue, without retries.
+
+ @discussion To enable scheduling, set this to a scheduler created with the manager's operation queue, as in `manager.scheduler = [[AFAmazonS3RequestScheduler alloc] initWithOperationQueue:manager.operationQueue]`.
+ */
+@property (nonatomic, strong) AFAmazonS3RequestScheduler *scheduler;
+
+/**
+ The collector that records the timing, size and outcome of each request sent by this manager. `nil` by default, which disables recording.
+ */
+@property (nonatomic, strong) AFAmazonS3Metrics *metrics;
+
 /**
  Initializes and returns a newly allocated Amazon S3 client with specified credentials.
 
@@ -128,6 +202,80 @@
                                  success:(void (^)(id responseObject))success
                                  failure:(void (^)(NSError *error))failure;
 
+/**
+ Lists one page of the objects in the bucket, using ListObjectsV2.
+
+ @param prefix If specified, only keys beginning with this prefix are listed.
+ @param delimiter If specified, keys that contain the delimiter after the prefix are rolled up into common prefixes.
+ @param continuationToken The `nextContinuationToken` of the previous page, or `nil` to list the first page.
+ @param maxKeys The maximum number of keys to list, up to `1000`. Pass `0` for the server default.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the parsed page.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+ */
+- (AFHTTPRequestOperation *)listObjectsWithPrefix:(NSString *)prefix
+                                        delimiter:(NSString *)delimiter
+                                continuationToken:(NSString *)continuationToken
+                                          maxKeys:(NSUInteger)maxKeys
+                                          success:(void (^)(AFAmazonS3ListBucketResult *result))success
+                                          failure:(void (^)(NSError *error))failure;
+
+/**
+ Lists one page of the objects in the bucket, using the original ListObjects operation, for S3-compatible servers that do not support ListObjectsV2.
+
+ @param prefix If specified, only keys beginning with this prefix are listed.
+ @param delimiter If specified, keys that contain the delimiter after the prefix are rolled up into common prefixes.
+ @param marker The `nextMarker` of the previous page, or `nil` to list the first page.
+ @param maxKeys The maximum number of keys to list, up to `1000`. Pass `0` for the server default.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the parsed page.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+ */
+- (AFHTTPRequestOperation *)listObjectsWithPrefix:(NSString *)prefix
+                                        delimiter:(NSString *)delimiter
+                                           marker:(NSString *)marker
+                                          maxKeys:(NSUInteger)maxKeys
+                                          success:(void (^)(AFAmazonS3ListBucketResult *result))success
+                                          failure:(void (^)(NSError *error))failure;
+
+/**
+ Lists every object in the bucket one page at a time, requesting each page while the previous one is being processed.
+
+ @param prefix If specified, only keys beginning with this prefix are listed.
+ @param delimiter If specified, keys that contain the delimiter after the prefix are rolled up into common prefixes.
+ @param block A block object to be executed for each page. This block has no return value and takes two arguments: the page, and a reference to a Boolean value that may be set to `YES` to stop the enumeration. This block will execute on the main thread.
+ @param success A block object to be executed when every page has been listed, or the enumeration was stopped. This block has no return value and takes a single argument: the number of objects listed.
+ @param failure A block object to be executed when a page could not be listed. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The enumerator that was started.
+ */
+- (AFAmazonS3ObjectEnumerator *)enumerateObjectsWithPrefix:(NSString *)prefix
+                                                 delimiter:(NSString *)delimiter
+                                                usingBlock:(void (^)(AFAmazonS3ListBucketResult *page, BOOL *stop))block
+                                                   success:(void (^)(NSUInteger numberOfObjects))success
+                                                   failure:(void (^)(NSError *error))failure;
+
+/**
+ Synchronizes a local directory with the objects under a key prefix, listing the prefix once and transferring only the files that are missing or out of date.
+
+ @param directoryPath The path of the local directory. Must not be `nil`.
+ @param prefix The key prefix under which objects are mirrored. If `nil`, the whole bucket is mirrored.
+ @param direction Whether the objects are brought up to date with the directory, or the directory with the objects.
+ @param success A block object to be executed once every transfer has finished. This block has no return value and takes a single argument: an `NSError` object for each file that could not be transferred, keyed by its path relative to the directory.
+ @param failure A block object to be executed when the objects could not be listed, or the local directory could not be read. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The directory sync that was started.
+
+ @discussion Items at the destination with no counterpart at the source are left in place. To delete them, create an `AFAmazonS3DirectorySync` with `deletesExtraneousItems` set to `YES`.
+ */
+- (AFAmazonS3DirectorySync *)syncDirectoryAtPath:(NSString *)directoryPath
+                                          prefix:(NSString *)prefix
+                                       direction:(AFAmazonS3DirectorySyncDirection)direction
+                                         success:(void (^)(NSDictionary *errorsByPath))success
+                                         failure:(void (^)(NSError *error))failure;
+
 ///----------------------------------------------
 /// @name Object Operations
 ///----------------------------------------------
@@ -148,10 +296,12 @@
 
  @param path The object path. Must not be `nil`.
  @param progress A block object to be called when an undetermined number of bytes have been downloaded from the server. This block has no return value and takes three arguments: the number of bytes read since the last time the download progress block was called, the total bytes read, and the total bytes expected to be read during the request, as initially determined by the expected content size of the `NSHTTPURLResponse` object. This block may be called multiple times, and will execute on the main thread.
- @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the response object from the server.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes two arguments: the response object from the server, and the object data.
  @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
  
- @return The operation that was enqueued
+ @return The operation that was enqueued, or `nil` if the object was returned from `objectCache` without a request
+
+ @discussion When `objectCache` is set, an object that is already cached is requested with `If-None-Match`, and a `304 Not Modified` response is passed to `success` with the cached data.
  */
 - (AFHTTPRequestOperation *)getObjectWithPath:(NSString *)path
                                      progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
@@ -175,6 +325,65 @@
                                       success:(void (^)(id responseObject))success
                                       failure:(void (^)(NSError *error))failure;
 
+/**
+ Gets a range of bytes of an object for a user that has read access to the object.
+
+ @param path The object path. Must not be `nil`.
+ @param firstByte The position of the first byte to get.
+ @param lastByte The position of the last byte to get, inclusive. Must not be less than `firstByte`.
+ @param outputStream The `NSOutputStream` object receiving data from the request. If `nil`, data is accumulated in memory. Only the body of a `206 Partial Content` response for the requested range is written to it.
+ @param progress A block object to be called when an undetermined number of bytes have been downloaded from the server. This block has no return value and takes three arguments: the number of bytes read since the last time the download progress block was called, the total bytes read, and the total bytes expected to be read during the request, as initially determined by the expected content size of the `NSHTTPURLResponse` object. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued
+ */
+- (AFHTTPRequestOperation *)getObjectWithPath:(NSString *)path
+                                    firstByte:(unsigned long long)firstByte
+                                     lastByte:(unsigned long long)lastByte
+                                 outputStream:(NSOutputStream *)outputStream
+                                     progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                      success:(void (^)(id responseObject))success
+                                      failure:(void (^)(NSError *error))failure;
+
+/**
+ Downloads an object into a local file by fetching byte ranges of the object in parallel. The object size is determined with a `HEAD` request, the destination file is preallocated to that size, and each range is written at its offset in the file as it arrives.
+
+ @param path The object path. Must not be `nil`.
+ @param destinationFilePath The path of the local file to write. Any existing file at this path is replaced. Must not be `nil`.
+ @param progress A block object to be called as ranges are downloaded from the server. This block has no return value and takes three arguments: the number of bytes read since the last time the download progress block was called, the total bytes read across all ranges, and the size of the object. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the whole object has been written to the destination file. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the object could not be downloaded. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The byte-range download that was started.
+ */
+- (AFAmazonS3ByteRangeDownload *)downloadObjectWithPath:(NSString *)path
+                                    destinationFilePath:(NSString *)destinationFilePath
+                                               progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                                success:(void (^)(id responseObject))success
+                                                failure:(void (^)(NSError *error))failure;
+
+/**
+ Downloads an object into a local file by fetching byte ranges of the object in parallel, recording the ranges that remain to be fetched in a journal so that an interrupted download can pick up where it left off.
+
+ @param path The object path. Must not be `nil`.
+ @param destinationFilePath The path of the local file to write. Must not be `nil`.
+ @param journalPath The path of the journal file. If a journal for the same object and destination file exists at this path, the download is resumed from it; otherwise a new download is started. Must not be `nil`.
+ @param progress A block object to be called as ranges are downloaded from the server. This block has no return value and takes three arguments: the number of bytes read since the last time the download progress block was called, the total bytes read across all ranges, including those read before the download was resumed, and the size of the object. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the whole object has been written to the destination file. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the object could not be downloaded. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The byte-range download that was started.
+
+ @discussion The journal is removed once the download succeeds or is cancelled.
+ */
+- (AFAmazonS3ByteRangeDownload *)downloadObjectWithPath:(NSString *)path
+                                    destinationFilePath:(NSString *)destinationFilePath
+                                            journalPath:(NSString *)journalPath
+                                               progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                                success:(void (^)(id responseObject))success
+                                                failure:(void (^)(NSError *error))failure;
+
 /**
  Adds an object to a bucket using forms.
 
@@ -228,6 +437,255 @@
                                          success:(void (^)(id responseObject))success
                                          failure:(void (^)(NSError *error))failure;
 
+/**
+ Deletes the specified objects, sending up to 1000 keys in each Multi-Object Delete request. All requests are enqueued on the operation queue at once.
+
+ @param paths The paths of the remote files to be deleted, relative to the bucket. Must not be `nil`.
+ @param success A block object to be executed once every request has finished. This block has no return value and takes two arguments: the paths that were deleted, and an `NSError` object for each path that could not be deleted, keyed by path. Paths in a request that failed outright are each given that request's error.
+ @param failure A block object to be executed if a request could not be created. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operations that were enqueued on operationQueue
+
+ @discussion S3 reports a key that does not exist as deleted. Deleting a key again has no further effect, so a batch that fails with a server error or a transient connection error is retried by `requestScheduler`, like the idempotent requests.
+ */
+- (NSArray *)deleteObjectsWithPaths:(NSArray *)paths
+                            success:(void (^)(NSArray *deletedPaths, NSDictionary *errorsByPath))success
+                            failure:(void (^)(NSError *error))failure;
+
+/**
+ Copies an object of up to 5 GB within the bucket with a single request, without transferring its contents through the client.
+
+ @param sourcePath The path of the object to copy, relative to the bucket. Must not be `nil`.
+ @param destinationPath The destination path for the copy. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the request, such as `x-amz-metadata-directive`.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+
+ @discussion If `parameters` include `Content-Type` or any `x-amz-meta-` field, `x-amz-metadata-directive` is set to `REPLACE`, unless it is already set, so that the copy takes the new metadata instead of the source's. S3 may report a failure to copy the object in the body of a `200 OK` response. Such responses are passed to `failure`.
+ */
+- (AFHTTPRequestOperation *)putObjectCopyWithSourcePath:(NSString *)sourcePath
+                                        destinationPath:(NSString *)destinationPath
+                                             parameters:(NSDictionary *)parameters
+                                                success:(void (^)(id responseObject))success
+                                                failure:(void (^)(NSError *error))failure;
+
+/**
+ Copies an object within the bucket on the server. The source is inspected with a `HEAD` request; objects up to 5 GB are copied with a single request, and larger objects are copied in parts with Upload Part - Copy, sending up to `maximumConcurrentMultipartUploadParts` parts at once.
+
+ @param sourcePath The path of the object to copy, relative to the bucket. Must not be `nil`.
+ @param destinationPath The destination path for the copy. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the copy request, or of the initiating request of a copy in parts.
+ @param progress A block object to be called as parts are copied. This block has no return value and takes three arguments: the number of bytes copied since the last time the progress block was called, the total bytes copied, and the size of the object. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the copy has been completed by the server. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the object could not be copied. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The multipart upload performing the copy.
+ */
+- (AFAmazonS3MultipartUpload *)copyObjectWithPath:(NSString *)sourcePath
+                                  destinationPath:(NSString *)destinationPath
+                                       parameters:(NSDictionary *)parameters
+                                         progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                          success:(void (^)(id responseObject))success
+                                          failure:(void (^)(NSError *error))failure;
+
+/**
+ Moves an object within the bucket by copying it on the server, as with `-copyObjectWithPath:destinationPath:parameters:progress:success:failure:`, then deleting the source.
+
+ @param sourcePath The path of the object to move, relative to the bucket. Must not be `nil`.
+ @param destinationPath The destination path of the object. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the copy request, or of the initiating request of a copy in parts.
+ @param progress A block object to be called as parts are copied. This block has no return value and takes three arguments: the number of bytes copied since the last time the progress block was called, the total bytes copied, and the size of the object. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the source has been deleted. This block has no return value and takes a single argument: the response object from the copy.
+ @param failure A block object to be executed when the object could not be copied, or the source could not be deleted. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The multipart upload performing the copy.
+
+ @discussion The source is only deleted once the copy has succeeded. If the source cannot then be deleted, the object exists at both paths.
+ */
+- (AFAmazonS3MultipartUpload *)moveObjectWithPath:(NSString *)sourcePath
+                                  destinationPath:(NSString *)destinationPath
+                                       parameters:(NSDictionary *)parameters
+                                         progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                          success:(void (^)(id responseObject))success
+                                          failure:(void (^)(NSError *error))failure;
+
+/**
+ Returns pre-signed URL strings for the objects at the specified paths, which can be handed to clients without credentials.
+
+ @param paths The object paths, relative to `baseURL`. Must not be `nil`.
+ @param method The HTTP method the URLs are signed for: `GET`, `HEAD`, `PUT` or `DELETE`.
+ @param expiration The expiration of the URLs. If `nil`, defaults to 1 hour from when method is called.
+ @param error The error that occured while signing the URLs.
+
+ @return The URL strings, in the order of `paths`, or `nil` if no credentials have been set.
+
+ @see `AFAmazonS3RequestSerializer -preSignedURLStringsWithBaseURL:paths:method:expiration:error:`
+ */
+- (NSArray *)preSignedURLStringsForPaths:(NSArray *)paths
+                                  method:(NSString *)method
+                              expiration:(NSDate *)expiration
+                                   error:(NSError * __autoreleasing *)error;
+
+///----------------------------------
+/// @name Multipart Upload Operations
+///----------------------------------
+
+/**
+ Uploads a file in parts, sending up to `maximumConcurrentMultipartUploadParts` parts at once on the operation queue. Failed parts are retried up to `maximumMultipartUploadPartRetryCount` times; if a part still cannot be sent, the upload is aborted.
+
+ @param path The path to the local file. Must not be `nil`.
+ @param destinationPath The destination path for the remote file, including its name. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the initiating request.
+ @param progress A block object to be called as parts are uploaded to the server. This block has no return value and takes three arguments: the number of bytes written since the last time the upload progress block was called, the total bytes written across all parts, and the size of the file. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the upload has been completed by the server. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the upload could not be completed. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The multipart upload that was started.
+ */
+- (AFAmazonS3MultipartUpload *)multipartUploadObjectWithFile:(NSString *)path
+                                             destinationPath:(NSString *)destinationPath
+                                                  parameters:(NSDictionary *)parameters
+                                                    progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                                     success:(void (^)(id responseObject))success
+                                                     failure:(void (^)(NSError *error))failure;
+
+/**
+ Uploads a file in parts, recording the upload ID and the parts that have been sent in a journal so that an interrupted upload can pick up where it left off.
+
+ @param path The path to the local file. Must not be `nil`.
+ @param destinationPath The destination path for the remote file, including its name. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the initiating request. Ignored when the upload is resumed.
+ @param journalPath The path of the journal file. If a journal for the same file and destination path exists at this path, the upload is resumed from it; otherwise a new upload is started. Must not be `nil`.
+ @param progress A block object to be called as parts are uploaded to the server. This block has no return value and takes three arguments: the number of bytes written since the last time the upload progress block was called, the total bytes written across all parts, including those sent before the upload was resumed, and the size of the file. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the upload has been completed by the server. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the upload could not be completed. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The multipart upload that was started.
+
+ @discussion An upload that fails keeps its parts on the server and its journal on disk. The journal is removed once the upload is completed or cancelled.
+ */
+- (AFAmazonS3MultipartUpload *)multipartUploadObjectWithFile:(NSString *)path
+                                             destinationPath:(NSString *)destinationPath
+                                                  parameters:(NSDictionary *)parameters
+                                                 journalPath:(NSString *)journalPath
+                                                    progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                                     success:(void (^)(id responseObject))success
+                                                     failure:(void (^)(NSError *error))failure;
+
+/**
+ Initiates a multipart upload and returns its upload ID.
+
+ @param path The destination path for the remote file, including its name. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the request.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the upload ID assigned by the server.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+ */
+- (AFHTTPRequestOperation *)initiateMultipartUploadWithPath:(NSString *)path
+                                                 parameters:(NSDictionary *)parameters
+                                                    success:(void (^)(NSString *uploadID))success
+                                                    failure:(void (^)(NSError *error))failure;
+
+/**
+ Uploads a part of a multipart upload.
+
+ @param data The part data. Must not be `nil`.
+ @param path The destination path for the remote file, including its name. Must not be `nil`.
+ @param uploadID The upload ID returned when the upload was initiated. Must not be `nil`.
+ @param partNumber The part number, between `1` and `10000`.
+ @param progress A block object to be called when an undetermined number of bytes have been uploaded to the server. This block has no return value and takes three arguments: the number of bytes written since the last time the upload progress block was called, the total bytes written, and the total bytes expected to be written during the request. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the `ETag` of the uploaded part.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+ */
+- (AFHTTPRequestOperation *)uploadPartWithData:(NSData *)data
+                                          path:(NSString *)path
+                                      uploadID:(NSString *)uploadID
+                                    partNumber:(NSUInteger)partNumber
+                                      progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                       success:(void (^)(NSString *ETag))success
+                                       failure:(void (^)(NSError *error))failure;
+
+/**
+ Uploads a part of a multipart upload by copying a byte range of an existing object on the server.
+
+ @param sourcePath The path of the object to copy from, relative to the bucket. Must not be `nil`.
+ @param destinationPath The destination path for the remote file, including its name. Must not be `nil`.
+ @param uploadID The upload ID returned when the upload was initiated. Must not be `nil`.
+ @param partNumber The part number, between `1` and `10000`.
+ @param firstByte The offset of the first byte of the range to copy.
+ @param lastByte The offset of the last byte of the range to copy, inclusive.
+ @param sourceETag If specified, the part is only copied if the source object still has this `ETag`.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the `ETag` of the copied part.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+ */
+- (AFHTTPRequestOperation *)uploadPartCopyWithSourcePath:(NSString *)sourcePath
+                                         destinationPath:(NSString *)destinationPath
+                                                uploadID:(NSString *)uploadID
+                                              partNumber:(NSUInteger)partNumber
+                                               firstByte:(unsigned long long)firstByte
+                                                lastByte:(unsigned long long)lastByte
+                                              sourceETag:(NSString *)sourceETag
+                                                 success:(void (^)(NSString *ETag))success
+                                                 failure:(void (^)(NSError *error))failure;
+
+/**
+ Completes a multipart upload by assembling previously uploaded parts.
+
+ @param path The destination path for the remote file, including its name. Must not be `nil`.
+ @param uploadID The upload ID returned when the upload was initiated. Must not be `nil`.
+ @param partETags The `ETag` of each uploaded part, keyed by part number. Must not be `nil`.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+
+ @discussion S3 may report a failure to assemble the parts in the body of a `200 OK` response. Such responses are passed to `failure`.
+ */
+- (AFHTTPRequestOperation *)completeMultipartUploadWithPath:(NSString *)path
+                                                   uploadID:(NSString *)uploadID
+                                                  partETags:(NSDictionary *)partETags
+                                                    success:(void (^)(id responseObject))success
+                                                    failure:(void (^)(NSError *error))failure;
+
+/**
+ Lists the parts that have been uploaded for a multipart upload.
+
+ @param path The destination path for the remote file, including its name. Must not be `nil`.
+ @param uploadID The upload ID returned when the upload was initiated. Must not be `nil`.
+ @param partNumberMarker The part number after which listing begins, or `0` to list from the first part.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes two arguments: an array of dictionaries with the `PartNumber`, `ETag`, `Size`, and `LastModified` of each part, and the marker to pass to list the next page of parts, or `0` if there are no more parts.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+ */
+- (AFHTTPRequestOperation *)listPartsWithPath:(NSString *)path
+                                     uploadID:(NSString *)uploadID
+                             partNumberMarker:(NSUInteger)partNumberMarker
+                                      success:(void (^)(NSArray *parts, NSUInteger nextPartNumberMarker))success
+                                      failure:(void (^)(NSError *error))failure;
+
+/**
+ Aborts a multipart upload, freeing the storage used by any previously uploaded parts.
+
+ @param path The destination path for the remote file, including its name. Must not be `nil`.
+ @param uploadID The upload ID returned when the upload was initiated. Must not be `nil`.
+ @param success A block object to be executed when the request operation finishes successfully. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the request operation finishes unsuccessfully, or that finishes successfully, but encountered an error while parsing the response data. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+
+ @return The operation that was enqueued on operationQueue
+ */
+- (AFHTTPRequestOperation *)abortMultipartUploadWithPath:(NSString *)path
+                                                uploadID:(NSString *)uploadID
+                                                 success:(void (^)(id responseObject))success
+                                                 failure:(void (^)(NSError *error))failure;
+
 @end
 
 ///----------------
@@ -242,4 +700,16 @@
  */
 extern NSString * const AFAmazonS3ManagerErrorDomain;
 
+/**
+ ## Multipart Upload Part Sizes
+
+ `AFAmazonS3MinimumMultipartUploadPartSize`
+ The smallest part size S3 accepts for all but the last part of a multipart upload (5 MB).
+
+ `AFAmazonS3DefaultMultipartUploadPartSize`
+ The default value of `multipartUploadPartSize` (8 MB).
+ */
+extern unsigned long long const AFAmazonS3MinimumMultipartUploadPartSize;
+extern unsigned long long const AFAmazonS3DefaultMultipartUploadPartSize;
+
 @compatibility_alias AFAmazonS3Client AFAmazonS3Manager;
@@ -22,66 +22,1442 @@
 
 #import "AFAmazonS3Manager.h"
 #import "AFAmazonS3ResponseSerializer.h"
+#import "AFAmazonS3MultipartUpload.h"
+#import "AFAmazonS3ByteRangeDownload.h"
+#import "AFAmazonS3ObjectEnumerator.h"
+#import "AFAmazonS3ObjectCache.h"
+#import "AFAmazonS3RequestScheduler.h"
+#import "AFAmazonS3Metrics.h"
+#import "AFAmazonS3DigestStream.h"
+
+#import <CommonCrypto/CommonDigest.h>
 
 NSString * const AFAmazonS3ManagerErrorDomain = @"com.alamofire.networking.s3.error";
 
-static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
-    return [path stringByReplacingOccurrencesOfString:@" " withString:@"+"];
+unsigned long long const AFAmazonS3MinimumMultipartUploadPartSize = 5 * 1024 * 1024;
+unsigned long long const AFAmazonS3DefaultMultipartUploadPartSize = 8 * 1024 * 1024;
+
+static NSUInteger const AFAmazonS3MaximumDeleteObjectsRequestKeyCount = 1000;
+
+static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
+    return [path stringByReplacingOccurrencesOfString:@" " withString:@"+"];
+}
+
+static NSString * AFPercentEscapedStringFromString(NSString *string) {
+    static NSString * const kAFCharactersToBeEscaped = @":/?&=;+!@#$()',*";
+
+    return (__bridge_transfer NSString *)CFURLCreateStringByAddingPercentEscapes(kCFAllocatorDefault, (__bridge CFStringRef)string, NULL, (__bridge CFStringRef)kAFCharactersToBeEscaped, kCFStringEncodingUTF8);
+}
+
+static NSString * AFCopySourceStringFromBucketAndPath(NSString *bucket, NSString *path) {
+    static NSString * const kAFCharactersToBeEscaped = @":?&=;+!@#$()',*";
+
+    // The key is escaped as in a URL, keeping the slashes between its components
+    NSString *key = [path hasPrefix:@"/"] ? [path substringFromIndex:1] : path;
+    NSString *escapedKey = (__bridge_transfer NSString *)CFURLCreateStringByAddingPercentEscapes(kCFAllocatorDefault, (__bridge CFStringRef)key, NULL, (__bridge CFStringRef)kAFCharactersToBeEscaped, kCFStringEncodingUTF8);
+
+    return [NSString stringWithFormat:@"/%@/%@", bucket, escapedKey];
+}
+
+// S3 copies the source's metadata unless told otherwise, silently dropping any Content-Type or user metadata sent with the copy
+static BOOL AFCopyHeaderFieldsReplaceMetadata(NSDictionary *headerFields) {
+    for (NSString *field in headerFields) {
+        NSString *lowercaseField = [field lowercaseString];
+        if ([lowercaseField isEqualToString:@"x-amz-metadata-directive"]) {
+            return NO;
+        }
+    }
+
+    for (NSString *field in headerFields) {
+        NSString *lowercaseField = [field lowercaseString];
+        if ([lowercaseField isEqualToString:@"content-type"] || [lowercaseField hasPrefix:@"x-amz-meta-"]) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+static NSString * AFXMLEscapedStringFromString(NSString *string) {
+    NSMutableString *mutableString = [string mutableCopy];
+    [mutableString replaceOccurrencesOfString:@"&" withString:@"&amp;" options:0 range:NSMakeRange(0, [mutableString length])];
+    [mutableString replaceOccurrencesOfString:@"<" withString:@"&lt;" options:0 range:NSMakeRange(0, [mutableString length])];
+    [mutableString replaceOccurrencesOfString:@">" withString:@"&gt;" options:0 range:NSMakeRange(0, [mutableString length])];
+    [mutableString replaceOccurrencesOfString:@"\"" withString:@"&quot;" options:0 range:NSMakeRange(0, [mutableString length])];
+    [mutableString replaceOccurrencesOfString:@"'" withString:@"&apos;" options:0 range:NSMakeRange(0, [mutableString length])];
+
+    return mutableString;
+}
+
+#pragma mark -
+
+/**
+ Collects the text of leaf elements from an S3 XML response without building a document tree. Leaves inside a record element (such as `Part` or `Contents`) are gathered into one dictionary per record; all other leaves are gathered into `values`.
+ */
+@interface AFAmazonS3XMLRecordParser : NSObject <NSXMLParserDelegate>
+@property (readonly, nonatomic, copy) NSString *recordElementName;
+@property (readonly, nonatomic, copy) NSString *rootElementName;
+@property (readonly, nonatomic, strong) NSMutableArray *records;
+@property (readonly, nonatomic, strong) NSMutableDictionary *values;
+
+- (instancetype)initWithRecordElementName:(NSString *)recordElementName;
+- (BOOL)parseData:(NSData *)data;
+@end
+
+@interface AFAmazonS3XMLRecordParser ()
+@property (readwrite, nonatomic, copy) NSString *rootElementName;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *currentRecord;
+@property (readwrite, nonatomic, strong) NSMutableString *currentText;
+@end
+
+@implementation AFAmazonS3XMLRecordParser
+
+- (instancetype)initWithRecordElementName:(NSString *)recordElementName {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    _recordElementName = [recordElementName copy];
+    _records = [NSMutableArray array];
+    _values = [NSMutableDictionary dictionary];
+
+    return self;
+}
+
+- (BOOL)parseData:(NSData *)data {
+    if ([data length] == 0) {
+        return NO;
+    }
+
+    NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
+    parser.delegate = self;
+
+    return [parser parse];
+}
+
+#pragma mark - NSXMLParserDelegate
+
+- (void)parser:(__unused NSXMLParser *)parser
+didStartElement:(NSString *)elementName
+  namespaceURI:(__unused NSString *)namespaceURI
+ qualifiedName:(__unused NSString *)qualifiedName
+    attributes:(__unused NSDictionary *)attributes
+{
+    if (!self.rootElementName) {
+        self.rootElementName = elementName;
+    }
+
+    if ([elementName isEqualToString:self.recordElementName]) {
+        self.currentRecord = [NSMutableDictionary dictionary];
+    }
+
+    self.currentText = [NSMutableString string];
+}
+
+- (void)parser:(__unused NSXMLParser *)parser
+ didEndElement:(NSString *)elementName
+  namespaceURI:(__unused NSString *)namespaceURI
+ qualifiedName:(__unused NSString *)qualifiedName
+{
+    if (self.currentRecord && [elementName isEqualToString:self.recordElementName]) {
+        [self.records addObject:self.currentRecord];
+        self.currentRecord = nil;
+    } else if (self.currentText) {
+        NSMutableDictionary *mutableValues = self.currentRecord ?: self.values;
+        mutableValues[elementName] = [self.currentText copy];
+    }
+
+    self.currentText = nil;
+}
+
+- (void)parser:(__unused NSXMLParser *)parser
+foundCharacters:(NSString *)string
+{
+    [self.currentText appendString:string];
+}
+
+@end
+
+#pragma mark -
+
+/**
+ Passes the body of a ranged `GET` to another output stream only if the response is `206 Partial Content` for the requested range. The bodies of error responses, and of `200 OK` responses from servers that ignored the `Range` header field, are consumed without being written.
+ */
+@interface AFAmazonS3PartialContentOutputStream : NSOutputStream
+@property (readonly, nonatomic, strong) NSOutputStream *outputStream;
+@property (readonly, nonatomic, assign) unsigned long long firstByte;
+@property (readwrite, nonatomic, weak) AFHTTPRequestOperation *operation;
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream
+                           firstByte:(unsigned long long)firstByte;
+@end
+
+@implementation AFAmazonS3PartialContentOutputStream
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wimplicit-atomic-properties"
+@synthesize delegate;
+#pragma clang diagnostic pop
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream
+                           firstByte:(unsigned long long)firstByte
+{
+    NSParameterAssert(outputStream);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    _outputStream = outputStream;
+    _firstByte = firstByte;
+
+    return self;
+}
+
+- (BOOL)acceptsResponse:(NSHTTPURLResponse *)response {
+    if ([response statusCode] != 206) {
+        return NO;
+    }
+
+    NSString *contentRange = [response allHeaderFields][@"Content-Range"];
+
+    return !contentRange || [contentRange hasPrefix:[NSString stringWithFormat:@"bytes %llu-", self.firstByte]];
+}
+
+#pragma mark - NSOutputStream
+
+- (NSInteger)write:(const uint8_t *)buffer
+         maxLength:(NSUInteger)length
+{
+    // The response is set by the operation before any of its body is written
+    if (![self acceptsResponse:self.operation.response]) {
+        return (NSInteger)length;
+    }
+
+    return [self.outputStream write:buffer maxLength:length];
+}
+
+- (BOOL)hasSpaceAvailable {
+    return [self.outputStream hasSpaceAvailable];
+}
+
+#pragma mark - NSStream
+
+- (void)open {
+    [self.outputStream open];
+}
+
+- (void)close {
+    [self.outputStream close];
+}
+
+- (NSStreamStatus)streamStatus {
+    return [self.outputStream streamStatus];
+}
+
+- (NSError *)streamError {
+    return [self.outputStream streamError];
+}
+
+- (id)propertyForKey:(NSString *)key {
+    return [self.outputStream propertyForKey:key];
+}
+
+- (BOOL)setProperty:(id)property
+             forKey:(NSString *)key
+{
+    return [self.outputStream setProperty:property forKey:key];
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)aRunLoop
+                  forMode:(NSString *)mode
+{
+    [self.outputStream scheduleInRunLoop:aRunLoop forMode:mode];
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)aRunLoop
+                  forMode:(NSString *)mode
+{
+    [self.outputStream removeFromRunLoop:aRunLoop forMode:mode];
+}
+
+@end
+
+#pragma mark -
+
+/**
+ The operation enqueued for the first attempt of a request, and returned to the caller. A retry is a new operation, so this operation keeps the attempt in flight, and cancelling it cancels that attempt and prevents any further ones, even once this operation has finished.
+ */
+@interface AFAmazonS3RequestOperation : AFHTTPRequestOperation
+- (BOOL)isRetryCancelled;
+- (BOOL)setRetryOperation:(AFHTTPRequestOperation *)retryOperation;
+@end
+
+@implementation AFAmazonS3RequestOperation {
+    BOOL _retryCancelled;
+    __weak AFHTTPRequestOperation *_retryOperation;
+}
+
+- (BOOL)isRetryCancelled {
+    @synchronized(self) {
+        return _retryCancelled;
+    }
+}
+
+- (BOOL)setRetryOperation:(AFHTTPRequestOperation *)retryOperation {
+    @synchronized(self) {
+        if (_retryCancelled) {
+            return NO;
+        }
+
+        _retryOperation = retryOperation;
+
+        return YES;
+    }
+}
+
+#pragma mark - NSOperation
+
+- (void)cancel {
+    AFHTTPRequestOperation *retryOperation = nil;
+    @synchronized(self) {
+        _retryCancelled = YES;
+        retryOperation = _retryOperation;
+    }
+
+    [retryOperation cancel];
+    [super cancel];
+}
+
+@end
+
+static NSError * AFAmazonS3ErrorFromErrorValues(NSDictionary *values) {
+    NSMutableDictionary *mutableUserInfo = [NSMutableDictionary dictionary];
+    mutableUserInfo[NSLocalizedDescriptionKey] = values[@"Message"] ?: NSLocalizedStringFromTable(@"Request failed", @"AFAmazonS3Manager", nil);
+    if (values[@"Code"]) {
+        mutableUserInfo[NSLocalizedFailureReasonErrorKey] = values[@"Code"];
+    }
+
+    return [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorBadServerResponse userInfo:mutableUserInfo];
+}
+
+static NSError * AFAmazonS3ErrorFromXMLResponseData(NSData *data) {
+    AFAmazonS3XMLRecordParser *parser = [[AFAmazonS3XMLRecordParser alloc] initWithRecordElementName:nil];
+    if (![parser parseData:data] || ![parser.rootElementName isEqualToString:@"Error"]) {
+        return nil;
+    }
+
+    return AFAmazonS3ErrorFromErrorValues(parser.values);
+}
+
+static long long AFNumberOfBytesTransferredByOperation(AFHTTPRequestOperation *operation) {
+    NSURLRequest *request = operation.request;
+    NSHTTPURLResponse *response = operation.response;
+    if (!response) {
+        return NSURLResponseUnknownLength;
+    }
+
+    long long requestLength = request.HTTPBodyStream ? [[request valueForHTTPHeaderField:@"Content-Length"] longLongValue] : (long long)[request.HTTPBody length];
+    long long responseLength = [request.HTTPMethod isEqualToString:@"HEAD"] ? 0 : [response expectedContentLength];
+    if (responseLength == NSURLResponseUnknownLength) {
+        return NSURLResponseUnknownLength;
+    }
+
+    return requestLength + responseLength;
+}
+
+static NSString * AFContentMD5StringFromData(NSData *data) {
+    unsigned char digest[CC_MD5_DIGEST_LENGTH];
+    CC_MD5([data bytes], (CC_LONG)[data length], digest);
+
+    return AFAmazonS3Base64EncodedStringFromData([NSData dataWithBytes:digest length:CC_MD5_DIGEST_LENGTH]);
+}
+
+static NSError * AFAmazonS3IntegrityErrorFromResponse(NSHTTPURLResponse *response, NSData *MD5Digest) {
+    if ([response statusCode] != 200) {
+        return nil;
+    }
+
+    NSDictionary *headerFields = [response allHeaderFields];
+
+    // Objects encrypted with KMS or customer-provided keys, and objects uploaded in parts, have ETags that are not the MD5 digest of their content
+    NSString *encryption = headerFields[@"x-amz-server-side-encryption"];
+    if ([encryption hasPrefix:@"aws:kms"] || headerFields[@"x-amz-server-side-encryption-customer-algorithm"]) {
+        return nil;
+    }
+
+    // Content encodings are decoded by the URL loading system before the body is written
+    NSString *contentEncoding = headerFields[@"Content-Encoding"];
+    if ([contentEncoding length] > 0 && ![contentEncoding isEqualToString:@"identity"]) {
+        return nil;
+    }
+
+    NSString *ETag = [[headerFields[@"ETag"] stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\""]] lowercaseString];
+    if ([ETag length] != CC_MD5_DIGEST_LENGTH * 2) {
+        return nil;
+    }
+
+    NSString *digest = AFAmazonS3HexEncodedStringFromData(MD5Digest);
+    if ([digest isEqualToString:ETag]) {
+        return nil;
+    }
+
+    NSDictionary *userInfo = @{
+                               NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Object integrity check failed", @"AFAmazonS3Manager", nil),
+                               NSLocalizedFailureReasonErrorKey: [NSString stringWithFormat:NSLocalizedStringFromTable(@"The MD5 digest of the transferred bytes (%@) does not match the ETag of the object (%@).", @"AFAmazonS3Manager", nil), digest, ETag],
+                               NSURLErrorFailingURLErrorKey: [response URL]
+                               };
+
+    return [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:userInfo];
+}
+
+#pragma mark -
+
+@interface AFAmazonS3Manager ()
+@property (readwrite, nonatomic, strong) NSURL *baseURL;
+@end
+
+@implementation AFAmazonS3Manager
+@synthesize baseURL = _s3_baseURL;
+@dynamic requestSerializer;
+
+- (instancetype)initWithBaseURL:(NSURL *)url {
+    self = [super initWithBaseURL:url];
+    if (!self) {
+        return nil;
+    }
+
+    self.requestSerializer = [AFAmazonS3RequestSerializer serializer];
+    self.responseSerializer = [AFAmazonS3ResponseSerializer serializer];
+
+    self.byteRangeDownloadSize = 8 * 1024 * 1024;
+    self.maximumConcurrentByteRangeDownloads = 4;
+    self.maximumByteRangeDownloadRetryCount = 3;
+
+    self.multipartUploadPartSize = AFAmazonS3DefaultMultipartUploadPartSize;
+    self.maximumConcurrentMultipartUploadParts = 4;
+    self.maximumMultipartUploadPartRetryCount = 3;
+
+    return self;
+}
+
+- (id)initWithAccessKeyID:(NSString *)accessKey
+                   secret:(NSString *)secret
+{
+    self = [self initWithBaseURL:nil];
+    if (!self) {
+        return nil;
+    }
+
+    [self.requestSerializer setAccessKeyID:accessKey secret:secret];
+
+    return self;
+}
+
+- (NSURL *)baseURL {
+    if (!_s3_baseURL) {
+        return self.requestSerializer.endpointURL;
+    }
+
+    return _s3_baseURL;
+}
+
+#pragma mark -
+
+- (NSMutableURLRequest *)requestWithMethod:(NSString *)method
+                                      path:(NSString *)path
+                                     query:(NSString *)query
+                              headerFields:(NSDictionary *)headerFields
+                                      body:(NSData *)body
+                                     error:(NSError * __autoreleasing *)error
+{
+    NSString *URLString = [[self.baseURL URLByAppendingPathComponent:path] absoluteString];
+    if (query) {
+        URLString = [URLString stringByAppendingFormat:@"?%@", query];
+    }
+
+    return [self.requestSerializer requestWithMethod:method URLString:URLString headerFields:headerFields body:body bodyStream:nil error:error];
+}
+
+- (NSString *)objectCacheKeyForPath:(NSString *)path {
+    if ([path hasPrefix:@"/"]) {
+        path = [path substringFromIndex:1];
+    }
+
+    return [[self.baseURL URLByAppendingPathComponent:path] absoluteString];
+}
+
+- (AFHTTPRequestOperation *)enqueueOperationWithRequest:(NSURLRequest *)request
+                                               priority:(NSOperationQueuePriority)priority
+                                              retryable:(BOOL)retryable
+                                          configuration:(void (^)(AFHTTPRequestOperation *operation))configuration
+                                                success:(void (^)(AFHTTPRequestOperation *operation, id responseObject))success
+                                                failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure
+{
+    return [self enqueueOperationWithRequest:request priority:priority retryable:retryable retryCount:0 originalOperation:nil configuration:configuration success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)enqueueOperationWithRequest:(NSURLRequest *)request
+                                               priority:(NSOperationQueuePriority)priority
+                                              retryable:(BOOL)retryable
+                                             retryCount:(NSUInteger)retryCount
+                                      originalOperation:(AFAmazonS3RequestOperation *)originalOperation
+                                          configuration:(void (^)(AFHTTPRequestOperation *operation))configuration
+                                                success:(void (^)(AFHTTPRequestOperation *operation, id responseObject))success
+                                                failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure
+{
+    AFAmazonS3RequestScheduler *scheduler = self.scheduler;
+    AFAmazonS3Metrics *metrics = self.metrics;
+    __block AFAmazonS3RequestOperation *retryHandle = originalOperation;
+
+    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        [scheduler operation:operation didFinishWithResponse:operation.response error:nil numberOfBytes:AFNumberOfBytesTransferredByOperation(operation)];
+        [metrics finishRecordingOperation:operation error:nil];
+
+        if (success) {
+            success(operation, responseObject);
+        }
+    } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+        [scheduler operation:operation didFinishWithResponse:operation.response error:error numberOfBytes:AFNumberOfBytesTransferredByOperation(operation)];
+        [metrics finishRecordingOperation:operation error:error];
+
+        // A request whose operation was cancelled by the caller is not attempted again
+        NSTimeInterval delay = 0.0;
+        if (retryable && ![retryHandle isRetryCancelled] && [scheduler shouldRetryRequest:operation.request response:operation.response error:error retryCount:retryCount delay:&delay]) {
+            AFAmazonS3RequestOperation *handle = retryHandle;
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                // The retry is signed again, since the signature of the original request includes its date
+                NSURLRequest *signedRequest = [self.requestSerializer requestBySettingAuthorizationHeadersForRequest:operation.request error:nil];
+                [self enqueueOperationWithRequest:signedRequest priority:operation.queuePriority retryable:retryable retryCount:retryCount + 1 originalOperation:handle configuration:configuration success:success failure:failure];
+            });
+
+            return;
+        }
+
+        if (failure) {
+            failure(operation, error);
+        }
+    }];
+
+    requestOperation.queuePriority = priority;
+
+    // The first attempt is the handle for all of them. A retry registered after the handle was cancelled is cancelled before it is enqueued, so that it finishes at once and reports the cancellation
+    if (!retryHandle && [requestOperation isKindOfClass:[AFAmazonS3RequestOperation class]]) {
+        retryHandle = (AFAmazonS3RequestOperation *)requestOperation;
+    } else if (retryHandle && ![retryHandle setRetryOperation:requestOperation]) {
+        [requestOperation cancel];
+    }
+
+    if (configuration) {
+        configuration(requestOperation);
+    }
+
+    if (metrics) {
+        [metrics startRecordingOperation:requestOperation bucket:self.requestSerializer.bucket retryCount:retryCount];
+    }
+
+    if (scheduler) {
+        [scheduler scheduleOperation:requestOperation forRequest:request];
+    } else {
+        [self.operationQueue addOperation:requestOperation];
+    }
+
+    return requestOperation;
+}
+
+- (AFHTTPRequestOperation *)enqueueS3RequestOperationWithMethod:(NSString *)method
+                                                           path:(NSString *)path
+                                                     parameters:(NSDictionary *)parameters
+                                                        success:(void (^)(id responseObject))success
+                                                        failure:(void (^)(NSError *error))failure
+{
+    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:method URLString:[[self.baseURL URLByAppendingPathComponent:path] absoluteString] parameters:parameters error:nil];
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityNormal retryable:YES configuration:nil success:^(__unused AFHTTPRequestOperation *operation, id responseObject) {
+        if (success) {
+            success(responseObject);
+        }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+
+#pragma mark Service Operations
+
+- (AFHTTPRequestOperation *)getServiceWithSuccess:(void (^)(id responseObject))success
+                                          failure:(void (^)(NSError *error))failure
+{
+    return [self enqueueS3RequestOperationWithMethod:@"GET" path:@"/" parameters:nil success:success failure:failure];
+}
+
+#pragma mark Bucket Operations
+
+- (AFHTTPRequestOperation *)getBucket:(NSString *)bucket
+                              success:(void (^)(id responseObject))success
+                              failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(bucket);
+
+    return [self enqueueS3RequestOperationWithMethod:@"GET" path:bucket parameters:nil success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)putBucket:(NSString *)bucket
+                           parameters:(NSDictionary *)parameters
+                              success:(void (^)(id responseObject))success
+                              failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(bucket);
+    
+    return [self enqueueS3RequestOperationWithMethod:@"PUT" path:bucket parameters:parameters success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)deleteBucket:(NSString *)bucket
+                                 success:(void (^)(id responseObject))success
+                                 failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(bucket);
+    
+    return [self enqueueS3RequestOperationWithMethod:@"DELETE" path:bucket parameters:nil success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)listObjectsWithPrefix:(NSString *)prefix
+                                        delimiter:(NSString *)delimiter
+                                continuationToken:(NSString *)continuationToken
+                                          maxKeys:(NSUInteger)maxKeys
+                                          success:(void (^)(AFAmazonS3ListBucketResult *result))success
+                                          failure:(void (^)(NSError *error))failure
+{
+    NSMutableArray *mutableQueryItems = [NSMutableArray arrayWithObject:@"list-type=2"];
+    if (continuationToken) {
+        [mutableQueryItems addObject:[@"continuation-token=" stringByAppendingString:AFPercentEscapedStringFromString(continuationToken)]];
+    }
+
+    return [self listObjectsWithQueryItems:mutableQueryItems prefix:prefix delimiter:delimiter maxKeys:maxKeys success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)listObjectsWithPrefix:(NSString *)prefix
+                                        delimiter:(NSString *)delimiter
+                                           marker:(NSString *)marker
+                                          maxKeys:(NSUInteger)maxKeys
+                                          success:(void (^)(AFAmazonS3ListBucketResult *result))success
+                                          failure:(void (^)(NSError *error))failure
+{
+    NSMutableArray *mutableQueryItems = [NSMutableArray array];
+    if (marker) {
+        [mutableQueryItems addObject:[@"marker=" stringByAppendingString:AFPercentEscapedStringFromString(marker)]];
+    }
+
+    return [self listObjectsWithQueryItems:mutableQueryItems prefix:prefix delimiter:delimiter maxKeys:maxKeys success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)listObjectsWithQueryItems:(NSMutableArray *)mutableQueryItems
+                                               prefix:(NSString *)prefix
+                                            delimiter:(NSString *)delimiter
+                                              maxKeys:(NSUInteger)maxKeys
+                                              success:(void (^)(AFAmazonS3ListBucketResult *result))success
+                                              failure:(void (^)(NSError *error))failure
+{
+    if (prefix) {
+        [mutableQueryItems addObject:[@"prefix=" stringByAppendingString:AFPercentEscapedStringFromString(prefix)]];
+    }
+
+    if (delimiter) {
+        [mutableQueryItems addObject:[@"delimiter=" stringByAppendingString:AFPercentEscapedStringFromString(delimiter)]];
+    }
+
+    if (maxKeys > 0) {
+        [mutableQueryItems addObject:[NSString stringWithFormat:@"max-keys=%lu", (unsigned long)maxKeys]];
+    }
+
+    NSString *query = [mutableQueryItems count] > 0 ? [mutableQueryItems componentsJoinedByString:@"&"] : nil;
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"GET" path:@"/" query:query headerFields:nil body:nil error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
+
+        return nil;
+    }
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityHigh retryable:YES configuration:^(AFHTTPRequestOperation *operation) {
+        // Pages are parsed by the response serializer, off the completion queue
+        operation.responseSerializer = [AFAmazonS3ListBucketResponseSerializer serializer];
+    } success:^(__unused AFHTTPRequestOperation *operation, id responseObject) {
+        if (success) {
+            success(responseObject);
+        }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFAmazonS3ObjectEnumerator *)enumerateObjectsWithPrefix:(NSString *)prefix
+                                                 delimiter:(NSString *)delimiter
+                                                usingBlock:(void (^)(AFAmazonS3ListBucketResult *page, BOOL *stop))block
+                                                   success:(void (^)(NSUInteger numberOfObjects))success
+                                                   failure:(void (^)(NSError *error))failure
+{
+    AFAmazonS3ObjectEnumerator *enumerator = [[AFAmazonS3ObjectEnumerator alloc] initWithManager:self prefix:prefix delimiter:delimiter];
+    [enumerator startWithPageBlock:block success:success failure:failure];
+
+    return enumerator;
+}
+
+- (AFAmazonS3DirectorySync *)syncDirectoryAtPath:(NSString *)directoryPath
+                                          prefix:(NSString *)prefix
+                                       direction:(AFAmazonS3DirectorySyncDirection)direction
+                                         success:(void (^)(NSDictionary *errorsByPath))success
+                                         failure:(void (^)(NSError *error))failure
+{
+    AFAmazonS3DirectorySync *sync = [[AFAmazonS3DirectorySync alloc] initWithManager:self directoryPath:directoryPath prefix:prefix direction:direction];
+    [sync startWithSuccess:success failure:failure];
+
+    return sync;
+}
+
+#pragma mark Object Operations
+
+- (AFHTTPRequestOperation *)headObjectWithPath:(NSString *)path
+                                       success:(void (^)(NSHTTPURLResponse *response))success
+                                       failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(path);
+
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
+
+    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:@"HEAD" URLString:[[self.baseURL URLByAppendingPathComponent:path] absoluteString] parameters:nil error:nil];
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityHigh retryable:YES configuration:nil success:^(AFHTTPRequestOperation *operation, __unused id responseObject) {
+        if (success) {
+            success(operation.response);
+        }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFHTTPRequestOperation *)getObjectWithPath:(NSString *)path
+                                     progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                      success:(void (^)(id responseObject, NSData *responseData))success
+                                      failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(path);
+
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
+
+    AFAmazonS3ObjectCache *objectCache = self.objectCache;
+    NSString *cacheKey = objectCache ? [self objectCacheKeyForPath:path] : nil;
+
+    // A write or delete of the object after this point discards the body this request downloads
+    NSUInteger cacheGeneration = cacheKey ? [objectCache generationForKey:cacheKey] : 0;
+
+    BOOL fresh = NO;
+    NSString *cachedETag = cacheKey ? [objectCache ETagForKey:cacheKey fresh:&fresh] : nil;
+    if (cachedETag && fresh) {
+        NSData *data = [objectCache dataForKey:cacheKey];
+        if (data) {
+            NSDictionary *headerFields = @{
+                                           @"ETag": cachedETag,
+                                           @"Content-Length": [NSString stringWithFormat:@"%lu", (unsigned long)[data length]]
+                                           };
+
+            NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:cacheKey] statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:headerFields];
+            dispatch_async(self.completionQueue ?: dispatch_get_main_queue(), ^{
+                if (success) {
+                    success([AFAmazonS3ResponseObject responseObject:response], data);
+                }
+            });
+
+            return nil;
+        }
+
+        cachedETag = nil;
+    }
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"GET" path:path query:nil headerFields:(cachedETag ? @{@"If-None-Match": cachedETag} : nil) body:nil error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
+
+        return nil;
+    }
+
+    BOOL shouldVerifyObjectIntegrity = self.shouldVerifyObjectIntegrity;
+    __block AFAmazonS3DigestOutputStream *digestStream = nil;
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityHigh retryable:YES configuration:^(AFHTTPRequestOperation *operation) {
+        if (shouldVerifyObjectIntegrity) {
+            // Each attempt writes to a new stream, since a retry receives the whole body again
+            digestStream = [[AFAmazonS3DigestOutputStream alloc] initWithOutputStream:[NSOutputStream outputStreamToMemory]];
+            operation.outputStream = digestStream;
+        }
+
+        [operation setDownloadProgressBlock:progress];
+    } success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        NSError *integrityError = digestStream ? AFAmazonS3IntegrityErrorFromResponse(operation.response, [digestStream MD5Digest]) : nil;
+        if (integrityError) {
+            if (failure) {
+                failure(integrityError);
+            }
+
+            return;
+        }
+
+        if (objectCache) {
+            NSData *responseData = operation.responseData;
+            NSString *ETag = operation.response.allHeaderFields[@"ETag"];
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+                [objectCache storeData:responseData ETag:ETag forKey:cacheKey generation:cacheGeneration];
+            });
+        }
+
+        if (success) {
+            success(responseObject, operation.responseData);
+        }
+    } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+        // `304 Not Modified` is not an acceptable status code for the response serializer, so it arrives here
+        if (cachedETag && operation.response.statusCode == 304) {
+            NSData *data = [objectCache dataForKey:cacheKey];
+            if (data) {
+                [objectCache markObjectAsValidatedForKey:cacheKey];
+
+                if (success) {
+                    success([AFAmazonS3ResponseObject responseObject:operation.response], data);
+                }
+            } else {
+                // The object was evicted while the request was in flight, so it is requested again in full
+                [self getObjectWithPath:path progress:progress success:success failure:failure];
+            }
+
+            return;
+        }
+
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFHTTPRequestOperation *)getObjectWithPath:(NSString *)path
+                                 outputStream:(NSOutputStream *)outputStream
+                                     progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                      success:(void (^)(id responseObject))success
+                                      failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(path);
+
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
+
+    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:@"GET" URLString:[[self.baseURL URLByAppendingPathComponent:path] absoluteString] parameters:nil error:nil];
+    AFAmazonS3DigestOutputStream *digestStream = nil;
+    if (self.shouldVerifyObjectIntegrity) {
+        digestStream = [[AFAmazonS3DigestOutputStream alloc] initWithOutputStream:outputStream ?: [NSOutputStream outputStreamToMemory]];
+    }
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityNormal retryable:NO configuration:^(AFHTTPRequestOperation *operation) {
+        operation.outputStream = digestStream ?: outputStream;
+
+        [operation setDownloadProgressBlock:progress];
+    } success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        // The bytes have already been written to the output stream, so a mismatch can only be reported
+        NSError *integrityError = digestStream ? AFAmazonS3IntegrityErrorFromResponse(operation.response, [digestStream MD5Digest]) : nil;
+        if (integrityError) {
+            if (failure) {
+                failure(integrityError);
+            }
+
+            return;
+        }
+
+        if (success) {
+            success(responseObject);
+        }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFHTTPRequestOperation *)getObjectWithPath:(NSString *)path
+                                    firstByte:(unsigned long long)firstByte
+                                     lastByte:(unsigned long long)lastByte
+                                 outputStream:(NSOutputStream *)outputStream
+                                     progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                      success:(void (^)(id responseObject))success
+                                      failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(path);
+    NSParameterAssert(lastByte >= firstByte);
+
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
+
+    NSDictionary *headerFields = @{@"Range": [NSString stringWithFormat:@"bytes=%llu-%llu", firstByte, lastByte]};
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"GET" path:path query:nil headerFields:headerFields body:nil error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
+
+        return nil;
+    }
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityLow retryable:NO configuration:^(AFHTTPRequestOperation *operation) {
+        if (outputStream) {
+            AFAmazonS3PartialContentOutputStream *partialContentStream = [[AFAmazonS3PartialContentOutputStream alloc] initWithOutputStream:outputStream firstByte:firstByte];
+            partialContentStream.operation = operation;
+            operation.outputStream = partialContentStream;
+        }
+
+        [operation setDownloadProgressBlock:progress];
+    } success:^(__unused AFHTTPRequestOperation *operation, id responseObject) {
+        if (success) {
+            success(responseObject);
+        }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFAmazonS3ByteRangeDownload *)downloadObjectWithPath:(NSString *)path
+                                    destinationFilePath:(NSString *)destinationFilePath
+                                               progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                                success:(void (^)(id responseObject))success
+                                                failure:(void (^)(NSError *error))failure
+{
+    AFAmazonS3ByteRangeDownload *download = [[AFAmazonS3ByteRangeDownload alloc] initWithManager:self path:path destinationFilePath:destinationFilePath];
+    [download startWithProgress:progress success:success failure:failure];
+
+    return download;
+}
+
+- (AFAmazonS3ByteRangeDownload *)downloadObjectWithPath:(NSString *)path
+                                    destinationFilePath:(NSString *)destinationFilePath
+                                            journalPath:(NSString *)journalPath
+                                               progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
+                                                success:(void (^)(id responseObject))success
+                                                failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(journalPath);
+
+    AFAmazonS3ByteRangeDownload *download = nil;
+    if ([[NSFileManager defaultManager] fileExistsAtPath:journalPath]) {
+        download = [AFAmazonS3ByteRangeDownload byteRangeDownloadWithJournalAtPath:journalPath manager:self error:nil];
+        if (![download.path isEqualToString:path] || ![download.destinationFilePath isEqualToString:destinationFilePath]) {
+            download = nil;
+        }
+    }
+
+    if (!download) {
+        download = [[AFAmazonS3ByteRangeDownload alloc] initWithManager:self path:path destinationFilePath:destinationFilePath];
+        download.journalPath = journalPath;
+    }
+
+    [download startWithProgress:progress success:success failure:failure];
+
+    return download;
+}
+
+- (AFHTTPRequestOperation *)postObjectWithFile:(NSString *)path
+                               destinationPath:(NSString *)destinationPath
+                                    parameters:(NSDictionary *)parameters
+                                      progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                       success:(void (^)(id responseObject))success
+                                       failure:(void (^)(NSError *error))failure
+{
+    return [self setObjectWithMethod:@"POST" file:path destinationPath:destinationPath parameters:parameters progress:progress success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)putObjectWithFile:(NSString *)path
+                              destinationPath:(NSString *)destinationPath
+                                   parameters:(NSDictionary *)parameters
+                                     progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                      success:(void (^)(id responseObject))success
+                                      failure:(void (^)(NSError *error))failure
+{
+    return [self setObjectWithMethod:@"PUT" file:path destinationPath:destinationPath parameters:parameters progress:progress success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)setObjectWithMethod:(NSString *)method
+                                           file:(NSString *)filePath
+                                destinationPath:(NSString *)destinationPath
+                                     parameters:(NSDictionary *)parameters
+                                       progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                        success:(void (^)(id responseObject))success
+                                        failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(method);
+    NSParameterAssert(filePath);
+    NSParameterAssert(destinationPath);
+
+    NSURL *fileURL = [NSURL fileURLWithPath:filePath];
+    NSURLResponse *response = nil;
+    NSData *data = nil;
+    unsigned long long fileSize = 0;
+
+    if (self.shouldStreamFileUploads) {
+        NSError *fileError = nil;
+        NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&fileError];
+
+        if (!attributes) {
+            if (failure) {
+                failure(fileError);
+            }
+
+            return nil;
+        }
+
+        fileSize = [attributes fileSize];
+    } else {
+        NSMutableURLRequest *fileRequest = [NSMutableURLRequest requestWithURL:fileURL];
+        fileRequest.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+
+        NSError *fileError = nil;
+        data = [NSURLConnection sendSynchronousRequest:fileRequest returningResponse:&response error:&fileError];
+
+        if (fileError || !response || !data) {
+            if (failure) {
+                failure(fileError);
+            }
+
+            return nil;
+        }
+    }
+
+    destinationPath = AFPathByEscapingSpacesWithPlusSigns(destinationPath);
+
+    if (self.objectCache) {
+        [self.objectCache removeObjectForKey:[self objectCacheKeyForPath:destinationPath]];
+    }
+
+    NSMutableURLRequest *request = nil;
+    AFAmazonS3DigestInputStream *digestStream = nil;
+    if ([method compare:@"POST" options:NSCaseInsensitiveSearch] == NSOrderedSame) {
+        NSError *requestError = nil;
+        __block NSError *fileError = nil;
+        request = [self.requestSerializer multipartFormRequestWithMethod:method URLString:[[self.baseURL URLByAppendingPathComponent:destinationPath] absoluteString] parameters:parameters constructingBodyWithBlock:^(id <AFMultipartFormData> formData) {
+            if (![parameters valueForKey:@"key"]) {
+                [formData appendPartWithFormData:[[filePath lastPathComponent] dataUsingEncoding:NSUTF8StringEncoding] name:@"key"];
+            }
+
+            if (data) {
+                [formData appendPartWithFileData:data name:@"file" fileName:[filePath lastPathComponent] mimeType:[response MIMEType]];
+            } else {
+                NSError *appendError = nil;
+                if (![formData appendPartWithFileURL:fileURL name:@"file" error:&appendError]) {
+                    fileError = appendError;
+                }
+            }
+        } error:&requestError];
+
+        requestError = requestError ?: fileError;
+        if (requestError || !request) {
+            if (failure) {
+                failure(requestError);
+            }
+
+            return nil;
+        }
+    } else {
+        // S3 expects parameters as headers for PUT requests
+        NSMutableDictionary *mutableHeaderFields = [NSMutableDictionary dictionaryWithDictionary:parameters ?: @{}];
+        NSInputStream *bodyStream = nil;
+        if (data) {
+            if (self.shouldVerifyObjectIntegrity) {
+                mutableHeaderFields[@"Content-MD5"] = AFContentMD5StringFromData(data);
+            }
+        } else {
+            // `Content-MD5` would need a second pass over the file, so the digest is computed as the body is sent and checked against the `ETag` instead
+            if (self.shouldVerifyObjectIntegrity) {
+                digestStream = [[AFAmazonS3DigestInputStream alloc] initWithInputStream:[NSInputStream inputStreamWithURL:fileURL]];
+            }
+
+            bodyStream = digestStream ?: [NSInputStream inputStreamWithURL:fileURL];
+            mutableHeaderFields[@"Content-Length"] = [NSString stringWithFormat:@"%llu", fileSize];
+        }
+
+        NSError *requestError = nil;
+        request = [self.requestSerializer requestWithMethod:method URLString:[[self.baseURL URLByAppendingPathComponent:destinationPath] absoluteString] headerFields:mutableHeaderFields body:data bodyStream:bodyStream error:&requestError];
+        if (!request) {
+            if (failure) {
+                failure(requestError);
+            }
+
+            return nil;
+        }
+    }
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityLow retryable:YES configuration:^(AFHTTPRequestOperation *operation) {
+        [operation setUploadProgressBlock:progress];
+    } success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        NSError *integrityError = digestStream ? AFAmazonS3IntegrityErrorFromResponse(operation.response, [digestStream MD5Digest]) : nil;
+        if (integrityError) {
+            if (failure) {
+                failure(integrityError);
+            }
+
+            return;
+        }
+
+        if (success) {
+            success(responseObject);
+        }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFHTTPRequestOperation *)deleteObjectWithPath:(NSString *)path
+                                         success:(void (^)(id responseObject))success
+                                         failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(path);
+
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
+
+    if (self.objectCache) {
+        [self.objectCache removeObjectForKey:[self objectCacheKeyForPath:path]];
+    }
+
+    return [self enqueueS3RequestOperationWithMethod:@"DELETE" path:path parameters:nil success:success failure:failure];
+}
+
+- (AFHTTPRequestOperation *)putObjectCopyWithSourcePath:(NSString *)sourcePath
+                                        destinationPath:(NSString *)destinationPath
+                                             parameters:(NSDictionary *)parameters
+                                                success:(void (^)(id responseObject))success
+                                                failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(sourcePath);
+    NSParameterAssert(destinationPath);
+    NSParameterAssert(self.requestSerializer.bucket);
+
+    destinationPath = AFPathByEscapingSpacesWithPlusSigns(destinationPath);
+
+    if (self.objectCache) {
+        [self.objectCache removeObjectForKey:[self objectCacheKeyForPath:destinationPath]];
+    }
+
+    NSMutableDictionary *mutableHeaderFields = [NSMutableDictionary dictionaryWithDictionary:parameters ?: @{}];
+    mutableHeaderFields[@"x-amz-copy-source"] = AFCopySourceStringFromBucketAndPath(self.requestSerializer.bucket, sourcePath);
+    if (AFCopyHeaderFieldsReplaceMetadata(mutableHeaderFields)) {
+        mutableHeaderFields[@"x-amz-metadata-directive"] = @"REPLACE";
+    }
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"PUT" path:destinationPath query:nil headerFields:mutableHeaderFields body:nil error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
+
+        return nil;
+    }
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityNormal retryable:YES configuration:nil success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        NSError *error = AFAmazonS3ErrorFromXMLResponseData(operation.responseData);
+        if (error) {
+            if (failure) {
+                failure(error);
+            }
+        } else {
+            if (success) {
+                success(responseObject);
+            }
+        }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFAmazonS3MultipartUpload *)copyObjectWithPath:(NSString *)sourcePath
+                                  destinationPath:(NSString *)destinationPath
+                                       parameters:(NSDictionary *)parameters
+                                         progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                          success:(void (^)(id responseObject))success
+                                          failure:(void (^)(NSError *error))failure
+{
+    AFAmazonS3MultipartUpload *upload = [[AFAmazonS3MultipartUpload alloc] initWithManager:self copySourcePath:sourcePath destinationPath:destinationPath parameters:parameters];
+    [upload startWithProgress:progress success:success failure:failure];
+
+    return upload;
+}
+
+- (AFAmazonS3MultipartUpload *)moveObjectWithPath:(NSString *)sourcePath
+                                  destinationPath:(NSString *)destinationPath
+                                       parameters:(NSDictionary *)parameters
+                                         progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                          success:(void (^)(id responseObject))success
+                                          failure:(void (^)(NSError *error))failure
+{
+    return [self copyObjectWithPath:sourcePath destinationPath:destinationPath parameters:parameters progress:progress success:^(id responseObject) {
+        [self deleteObjectWithPath:sourcePath success:^(__unused id deleteResponseObject) {
+            if (success) {
+                success(responseObject);
+            }
+        } failure:failure];
+    } failure:failure];
+}
+
+- (NSArray *)deleteObjectsWithPaths:(NSArray *)paths
+                            success:(void (^)(NSArray *deletedPaths, NSDictionary *errorsByPath))success
+                            failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(paths);
+
+    // Keys are sent in the request body rather than the URL, so they are neither escaped nor prefixed with a slash
+    NSMutableArray *mutablePaths = [NSMutableArray arrayWithCapacity:[paths count]];
+    NSMutableDictionary *mutablePathsByKey = [NSMutableDictionary dictionaryWithCapacity:[paths count]];
+    for (NSString *path in paths) {
+        NSString *key = [path hasPrefix:@"/"] ? [path substringFromIndex:1] : path;
+        if (!mutablePathsByKey[key]) {
+            mutablePathsByKey[key] = path;
+            [mutablePaths addObject:path];
+        }
+
+        if (self.objectCache) {
+            [self.objectCache removeObjectForKey:[self objectCacheKeyForPath:AFPathByEscapingSpacesWithPlusSigns(path)]];
+        }
+    }
+
+    NSMutableArray *mutableRequests = [NSMutableArray array];
+    NSMutableArray *mutableBatches = [NSMutableArray array];
+    for (NSUInteger location = 0; location < [mutablePaths count]; location += AFAmazonS3MaximumDeleteObjectsRequestKeyCount) {
+        NSArray *batch = [mutablePaths subarrayWithRange:NSMakeRange(location, MIN(AFAmazonS3MaximumDeleteObjectsRequestKeyCount, [mutablePaths count] - location))];
+
+        NSMutableString *mutableXMLString = [NSMutableString stringWithString:@"<Delete><Quiet>true</Quiet>"];
+        for (NSString *path in batch) {
+            NSString *key = [path hasPrefix:@"/"] ? [path substringFromIndex:1] : path;
+            [mutableXMLString appendFormat:@"<Object><Key>%@</Key></Object>", AFXMLEscapedStringFromString(key)];
+        }
+        [mutableXMLString appendString:@"</Delete>"];
+
+        NSData *body = [mutableXMLString dataUsingEncoding:NSUTF8StringEncoding];
+
+        NSDictionary *headerFields = @{
+                                       @"Content-Type": @"application/xml",
+                                       @"Content-MD5": AFContentMD5StringFromData(body)
+                                       };
+
+        NSError *requestError = nil;
+        NSMutableURLRequest *request = [self requestWithMethod:@"POST" path:@"/" query:@"delete" headerFields:headerFields body:body error:&requestError];
+        if (!request) {
+            if (failure) {
+                failure(requestError);
+            }
+
+            return nil;
+        }
+
+        [mutableRequests addObject:request];
+        [mutableBatches addObject:batch];
+    }
+
+    if ([mutableBatches count] == 0) {
+        dispatch_async(self.completionQueue ?: dispatch_get_main_queue(), ^{
+            if (success) {
+                success(@[], @{});
+            }
+        });
+
+        return @[];
+    }
+
+    NSMutableArray *mutableDeletedPaths = [NSMutableArray arrayWithCapacity:[mutablePaths count]];
+    NSMutableDictionary *mutableErrorsByPath = [NSMutableDictionary dictionary];
+    __block NSUInteger numberOfRemainingBatches = [mutableBatches count];
+
+    void (^finishBatch)(NSArray *, NSDictionary *) = ^(NSArray *batch, NSDictionary *errorsByPath) {
+        BOOL finished = NO;
+        @synchronized(mutableErrorsByPath) {
+            for (NSString *path in batch) {
+                if (errorsByPath[path]) {
+                    mutableErrorsByPath[path] = errorsByPath[path];
+                } else {
+                    [mutableDeletedPaths addObject:path];
+                }
+            }
+
+            finished = --numberOfRemainingBatches == 0;
+        }
+
+        if (finished && success) {
+            success([mutableDeletedPaths copy], [mutableErrorsByPath copy]);
+        }
+    };
+
+    NSMutableArray *mutableOperations = [NSMutableArray arrayWithCapacity:[mutableRequests count]];
+    [mutableRequests enumerateObjectsUsingBlock:^(NSURLRequest *request, NSUInteger idx, __unused BOOL *stop) {
+        NSArray *batch = mutableBatches[idx];
+
+        AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityLow retryable:YES configuration:nil success:^(AFHTTPRequestOperation *operation, __unused id responseObject) {
+            // In quiet mode, the response lists only the keys that could not be deleted
+            AFAmazonS3XMLRecordParser *parser = [[AFAmazonS3XMLRecordParser alloc] initWithRecordElementName:@"Error"];
+            NSMutableDictionary *mutableBatchErrorsByPath = [NSMutableDictionary dictionary];
+            if (![parser parseData:operation.responseData] || ![parser.rootElementName isEqualToString:@"DeleteResult"]) {
+                NSError *error = AFAmazonS3ErrorFromXMLResponseData(operation.responseData);
+                if (!error) {
+                    NSDictionary *userInfo = @{
+                                               NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Missing delete result in response", @"AFAmazonS3Manager", nil)
+                                               };
+
+                    error = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotParseResponse userInfo:userInfo];
+                }
+
+                for (NSString *path in batch) {
+                    mutableBatchErrorsByPath[path] = error;
+                }
+            } else {
+                for (NSDictionary *record in parser.records) {
+                    NSString *path = record[@"Key"] ? mutablePathsByKey[record[@"Key"]] : nil;
+                    if (path) {
+                        mutableBatchErrorsByPath[path] = AFAmazonS3ErrorFromErrorValues(record);
+                    }
+                }
+            }
+
+            finishBatch(batch, mutableBatchErrorsByPath);
+        } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+            NSMutableDictionary *mutableBatchErrorsByPath = [NSMutableDictionary dictionaryWithCapacity:[batch count]];
+            for (NSString *path in batch) {
+                mutableBatchErrorsByPath[path] = error;
+            }
+
+            finishBatch(batch, mutableBatchErrorsByPath);
+        }];
+
+        [mutableOperations addObject:requestOperation];
+    }];
+
+    return [mutableOperations copy];
 }
 
-@interface AFAmazonS3Manager ()
-@property (readwrite, nonatomic, strong) NSURL *baseURL;
-@end
+- (NSArray *)preSignedURLStringsForPaths:(NSArray *)paths
+                                  method:(NSString *)method
+                              expiration:(NSDate *)expiration
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(paths);
 
-@implementation AFAmazonS3Manager
-@synthesize baseURL = _s3_baseURL;
-@dynamic requestSerializer;
+    return [self.requestSerializer preSignedURLStringsWithBaseURL:self.baseURL paths:paths method:method expiration:expiration error:error];
+}
 
-- (instancetype)initWithBaseURL:(NSURL *)url {
-    self = [super initWithBaseURL:url];
-    if (!self) {
-        return nil;
-    }
+#pragma mark Multipart Upload Operations
 
-    self.requestSerializer = [AFAmazonS3RequestSerializer serializer];
-    self.responseSerializer = [AFAmazonS3ResponseSerializer serializer];
+- (AFAmazonS3MultipartUpload *)multipartUploadObjectWithFile:(NSString *)path
+                                             destinationPath:(NSString *)destinationPath
+                                                  parameters:(NSDictionary *)parameters
+                                                    progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                                     success:(void (^)(id responseObject))success
+                                                     failure:(void (^)(NSError *error))failure
+{
+    AFAmazonS3MultipartUpload *upload = [[AFAmazonS3MultipartUpload alloc] initWithManager:self filePath:path destinationPath:destinationPath parameters:parameters];
+    [upload startWithProgress:progress success:success failure:failure];
 
-    return self;
+    return upload;
 }
 
-- (id)initWithAccessKeyID:(NSString *)accessKey
-                   secret:(NSString *)secret
+- (AFAmazonS3MultipartUpload *)multipartUploadObjectWithFile:(NSString *)path
+                                             destinationPath:(NSString *)destinationPath
+                                                  parameters:(NSDictionary *)parameters
+                                                 journalPath:(NSString *)journalPath
+                                                    progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                                     success:(void (^)(id responseObject))success
+                                                     failure:(void (^)(NSError *error))failure
 {
-    self = [self initWithBaseURL:nil];
-    if (!self) {
-        return nil;
+    NSParameterAssert(journalPath);
+
+    AFAmazonS3MultipartUpload *upload = nil;
+    if ([[NSFileManager defaultManager] fileExistsAtPath:journalPath]) {
+        upload = [AFAmazonS3MultipartUpload multipartUploadWithJournalAtPath:journalPath manager:self error:nil];
+        if (![upload.filePath isEqualToString:path] || ![upload.destinationPath isEqualToString:destinationPath]) {
+            upload = nil;
+        }
     }
 
-    [self.requestSerializer setAccessKeyID:accessKey secret:secret];
+    if (!upload) {
+        upload = [[AFAmazonS3MultipartUpload alloc] initWithManager:self filePath:path destinationPath:destinationPath parameters:parameters];
+        upload.journalPath = journalPath;
+    }
 
-    return self;
+    [upload startWithProgress:progress success:success failure:failure];
+
+    return upload;
 }
 
-- (NSURL *)baseURL {
-    if (!_s3_baseURL) {
-        return self.requestSerializer.endpointURL;
+- (AFHTTPRequestOperation *)initiateMultipartUploadWithPath:(NSString *)path
+                                                 parameters:(NSDictionary *)parameters
+                                                    success:(void (^)(NSString *uploadID))success
+                                                    failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(path);
+
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"POST" path:path query:@"uploads" headerFields:parameters body:nil error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
+
+        return nil;
     }
 
-    return _s3_baseURL;
-}
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityNormal retryable:NO configuration:nil success:^(AFHTTPRequestOperation *operation, __unused id responseObject) {
+        AFAmazonS3XMLRecordParser *parser = [[AFAmazonS3XMLRecordParser alloc] initWithRecordElementName:nil];
+        NSString *uploadID = [parser parseData:operation.responseData] ? parser.values[@"UploadId"] : nil;
+        if (uploadID) {
+            if (success) {
+                success(uploadID);
+            }
+        } else {
+            if (failure) {
+                NSError *error = AFAmazonS3ErrorFromXMLResponseData(operation.responseData);
+                if (!error) {
+                    NSDictionary *userInfo = @{
+                                               NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Missing upload ID in response", @"AFAmazonS3Manager", nil)
+                                               };
 
-#pragma mark -
+                    error = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotParseResponse userInfo:userInfo];
+                }
 
-- (AFHTTPRequestOperation *)enqueueS3RequestOperationWithMethod:(NSString *)method
-                                                           path:(NSString *)path
-                                                     parameters:(NSDictionary *)parameters
-                                                        success:(void (^)(id responseObject))success
-                                                        failure:(void (^)(NSError *error))failure
-{
-    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:method URLString:[[self.baseURL URLByAppendingPathComponent:path] absoluteString] parameters:parameters error:nil];
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(__unused AFHTTPRequestOperation *operation, id responseObject) {
-        if (success) {
-            success(responseObject);
+                failure(error);
+            }
         }
     } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
         if (failure) {
@@ -89,64 +1465,43 @@ static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
         }
     }];
 
-    [self.operationQueue addOperation:requestOperation];
-    
     return requestOperation;
 }
 
-
-#pragma mark Service Operations
-
-- (AFHTTPRequestOperation *)getServiceWithSuccess:(void (^)(id responseObject))success
-                                          failure:(void (^)(NSError *error))failure
-{
-    return [self enqueueS3RequestOperationWithMethod:@"GET" path:@"/" parameters:nil success:success failure:failure];
-}
-
-#pragma mark Bucket Operations
-
-- (AFHTTPRequestOperation *)getBucket:(NSString *)bucket
-                              success:(void (^)(id responseObject))success
-                              failure:(void (^)(NSError *error))failure
+- (AFHTTPRequestOperation *)uploadPartWithData:(NSData *)data
+                                          path:(NSString *)path
+                                      uploadID:(NSString *)uploadID
+                                    partNumber:(NSUInteger)partNumber
+                                      progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                                       success:(void (^)(NSString *ETag))success
+                                       failure:(void (^)(NSError *error))failure
 {
-    NSParameterAssert(bucket);
-
-    return [self enqueueS3RequestOperationWithMethod:@"GET" path:bucket parameters:nil success:success failure:failure];
-}
+    NSParameterAssert(data);
+    NSParameterAssert(path);
+    NSParameterAssert(uploadID);
+    NSParameterAssert(partNumber >= 1 && partNumber <= 10000);
 
-- (AFHTTPRequestOperation *)putBucket:(NSString *)bucket
-                           parameters:(NSDictionary *)parameters
-                              success:(void (^)(id responseObject))success
-                              failure:(void (^)(NSError *error))failure
-{
-    NSParameterAssert(bucket);
-    
-    return [self enqueueS3RequestOperationWithMethod:@"PUT" path:bucket parameters:parameters success:success failure:failure];
-}
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
 
-- (AFHTTPRequestOperation *)deleteBucket:(NSString *)bucket
-                                 success:(void (^)(id responseObject))success
-                                 failure:(void (^)(NSError *error))failure
-{
-    NSParameterAssert(bucket);
-    
-    return [self enqueueS3RequestOperationWithMethod:@"DELETE" path:bucket parameters:nil success:success failure:failure];
-}
+    NSString *query = [NSString stringWithFormat:@"partNumber=%lu&uploadId=%@", (unsigned long)partNumber, AFPercentEscapedStringFromString(uploadID)];
 
-#pragma mark Object Operations
+    NSDictionary *headerFields = self.shouldVerifyObjectIntegrity ? @{@"Content-MD5": AFContentMD5StringFromData(data)} : nil;
 
-- (AFHTTPRequestOperation *)headObjectWithPath:(NSString *)path
-                                       success:(void (^)(NSHTTPURLResponse *response))success
-                                       failure:(void (^)(NSError *error))failure
-{
-    NSParameterAssert(path);
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"PUT" path:path query:query headerFields:headerFields body:data error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
 
-    path = AFPathByEscapingSpacesWithPlusSigns(path);
+        return nil;
+    }
 
-    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:@"HEAD" URLString:[[self.baseURL URLByAppendingPathComponent:path] absoluteString] parameters:nil error:nil];
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, __unused id responseObject) {
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityLow retryable:YES configuration:^(AFHTTPRequestOperation *operation) {
+        [operation setUploadProgressBlock:progress];
+    } success:^(AFHTTPRequestOperation *operation, __unused id responseObject) {
         if (success) {
-            success(operation.response);
+            success(operation.response.allHeaderFields[@"ETag"]);
         }
     } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
         if (failure) {
@@ -154,24 +1509,68 @@ static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
         }
     }];
 
-    [self.operationQueue addOperation:requestOperation];
-    
     return requestOperation;
 }
 
-- (AFHTTPRequestOperation *)getObjectWithPath:(NSString *)path
-                                     progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
-                                      success:(void (^)(id responseObject, NSData *responseData))success
-                                      failure:(void (^)(NSError *error))failure
+- (AFHTTPRequestOperation *)uploadPartCopyWithSourcePath:(NSString *)sourcePath
+                                         destinationPath:(NSString *)destinationPath
+                                                uploadID:(NSString *)uploadID
+                                              partNumber:(NSUInteger)partNumber
+                                               firstByte:(unsigned long long)firstByte
+                                                lastByte:(unsigned long long)lastByte
+                                              sourceETag:(NSString *)sourceETag
+                                                 success:(void (^)(NSString *ETag))success
+                                                 failure:(void (^)(NSError *error))failure
 {
-    NSParameterAssert(path);
+    NSParameterAssert(sourcePath);
+    NSParameterAssert(destinationPath);
+    NSParameterAssert(uploadID);
+    NSParameterAssert(partNumber >= 1 && partNumber <= 10000);
+    NSParameterAssert(firstByte <= lastByte);
+    NSParameterAssert(self.requestSerializer.bucket);
 
-    path = AFPathByEscapingSpacesWithPlusSigns(path);
+    destinationPath = AFPathByEscapingSpacesWithPlusSigns(destinationPath);
 
-    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:@"GET" URLString:[[self.baseURL URLByAppendingPathComponent:path] absoluteString] parameters:nil error:nil];
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
-        if (success) {
-            success(responseObject, operation.responseData);
+    NSString *query = [NSString stringWithFormat:@"partNumber=%lu&uploadId=%@", (unsigned long)partNumber, AFPercentEscapedStringFromString(uploadID)];
+
+    NSMutableDictionary *mutableHeaderFields = [NSMutableDictionary dictionaryWithCapacity:3];
+    mutableHeaderFields[@"x-amz-copy-source"] = AFCopySourceStringFromBucketAndPath(self.requestSerializer.bucket, sourcePath);
+    mutableHeaderFields[@"x-amz-copy-source-range"] = [NSString stringWithFormat:@"bytes=%llu-%llu", firstByte, lastByte];
+    if (sourceETag) {
+        mutableHeaderFields[@"x-amz-copy-source-if-match"] = sourceETag;
+    }
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"PUT" path:destinationPath query:query headerFields:mutableHeaderFields body:nil error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
+
+        return nil;
+    }
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityLow retryable:YES configuration:nil success:^(AFHTTPRequestOperation *operation, __unused id responseObject) {
+        // The result of a copy is reported in the response body, which may be an error despite a 200 OK status
+        AFAmazonS3XMLRecordParser *parser = [[AFAmazonS3XMLRecordParser alloc] initWithRecordElementName:nil];
+        NSString *ETag = [parser parseData:operation.responseData] && [parser.rootElementName isEqualToString:@"CopyPartResult"] ? parser.values[@"ETag"] : nil;
+        if (ETag) {
+            if (success) {
+                success(ETag);
+            }
+        } else {
+            if (failure) {
+                NSError *error = AFAmazonS3ErrorFromXMLResponseData(operation.responseData);
+                if (!error) {
+                    NSDictionary *userInfo = @{
+                                               NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Missing ETag in response", @"AFAmazonS3Manager", nil)
+                                               };
+
+                    error = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotParseResponse userInfo:userInfo];
+                }
+
+                failure(error);
+            }
         }
     } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
         if (failure) {
@@ -179,27 +1578,60 @@ static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
         }
     }];
 
-    [requestOperation setDownloadProgressBlock:progress];
-
-    [self.operationQueue addOperation:requestOperation];
-    
     return requestOperation;
 }
 
-- (AFHTTPRequestOperation *)getObjectWithPath:(NSString *)path
-                                 outputStream:(NSOutputStream *)outputStream
-                                     progress:(void (^)(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead))progress
-                                      success:(void (^)(id responseObject))success
-                                      failure:(void (^)(NSError *error))failure
+- (AFHTTPRequestOperation *)completeMultipartUploadWithPath:(NSString *)path
+                                                   uploadID:(NSString *)uploadID
+                                                  partETags:(NSDictionary *)partETags
+                                                    success:(void (^)(id responseObject))success
+                                                    failure:(void (^)(NSError *error))failure
 {
     NSParameterAssert(path);
+    NSParameterAssert(uploadID);
+    NSParameterAssert(partETags);
 
     path = AFPathByEscapingSpacesWithPlusSigns(path);
 
-    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:@"GET" URLString:[[self.baseURL URLByAppendingPathComponent:path] absoluteString] parameters:nil error:nil];
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(__unused AFHTTPRequestOperation *operation, id responseObject) {
-        if (success) {
-            success(responseObject);
+    NSMutableString *mutableXMLString = [NSMutableString stringWithString:@"<CompleteMultipartUpload>"];
+    for (NSNumber *partNumber in [[partETags allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        NSString *ETag = partETags[partNumber];
+        if (![ETag hasPrefix:@"\""]) {
+            ETag = [NSString stringWithFormat:@"\"%@\"", ETag];
+        }
+
+        [mutableXMLString appendFormat:@"<Part><PartNumber>%@</PartNumber><ETag>%@</ETag></Part>", partNumber, AFXMLEscapedStringFromString(ETag)];
+    }
+    [mutableXMLString appendString:@"</CompleteMultipartUpload>"];
+
+    NSString *query = [@"uploadId=" stringByAppendingString:AFPercentEscapedStringFromString(uploadID)];
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"POST" path:path query:query headerFields:@{@"Content-Type": @"application/xml"} body:[mutableXMLString dataUsingEncoding:NSUTF8StringEncoding] error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
+        }
+
+        return nil;
+    }
+
+    AFAmazonS3ObjectCache *objectCache = self.objectCache;
+    NSString *cacheKey = objectCache ? [self objectCacheKeyForPath:path] : nil;
+
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityNormal retryable:NO configuration:nil success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        NSError *error = AFAmazonS3ErrorFromXMLResponseData(operation.responseData);
+        if (error) {
+            if (failure) {
+                failure(error);
+            }
+        } else {
+            // The object only changes once its parts are assembled, which may be long after the upload was started
+            [objectCache removeObjectForKey:cacheKey];
+
+            if (success) {
+                success(responseObject);
+            }
         }
     } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
         if (failure) {
@@ -207,96 +1639,89 @@ static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
         }
     }];
 
-    requestOperation.outputStream = outputStream;
-
-    [requestOperation setDownloadProgressBlock:progress];
-
-    [self.operationQueue addOperation:requestOperation];
-    
     return requestOperation;
 }
 
-- (AFHTTPRequestOperation *)postObjectWithFile:(NSString *)path
-                               destinationPath:(NSString *)destinationPath
-                                    parameters:(NSDictionary *)parameters
-                                      progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
-                                       success:(void (^)(id responseObject))success
-                                       failure:(void (^)(NSError *error))failure
-{
-    return [self setObjectWithMethod:@"POST" file:path destinationPath:destinationPath parameters:parameters progress:progress success:success failure:failure];
-}
-
-- (AFHTTPRequestOperation *)putObjectWithFile:(NSString *)path
-                              destinationPath:(NSString *)destinationPath
-                                   parameters:(NSDictionary *)parameters
-                                     progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
-                                      success:(void (^)(id responseObject))success
+- (AFHTTPRequestOperation *)listPartsWithPath:(NSString *)path
+                                     uploadID:(NSString *)uploadID
+                             partNumberMarker:(NSUInteger)partNumberMarker
+                                      success:(void (^)(NSArray *parts, NSUInteger nextPartNumberMarker))success
                                       failure:(void (^)(NSError *error))failure
 {
-    return [self setObjectWithMethod:@"PUT" file:path destinationPath:destinationPath parameters:parameters progress:progress success:success failure:failure];
-}
-
-- (AFHTTPRequestOperation *)setObjectWithMethod:(NSString *)method
-                                           file:(NSString *)filePath
-                                destinationPath:(NSString *)destinationPath
-                                     parameters:(NSDictionary *)parameters
-                                       progress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
-                                        success:(void (^)(id responseObject))success
-                                        failure:(void (^)(NSError *error))failure
-{
-    NSParameterAssert(method);
-    NSParameterAssert(filePath);
-    NSParameterAssert(destinationPath);
+    NSParameterAssert(path);
+    NSParameterAssert(uploadID);
 
-    NSMutableURLRequest *fileRequest = [NSMutableURLRequest requestWithURL:[NSURL fileURLWithPath:filePath]];
-    fileRequest.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
 
-    NSURLResponse *response = nil;
-    NSError *fileError = nil;
-    NSData *data = [NSURLConnection sendSynchronousRequest:fileRequest returningResponse:&response error:&fileError];
+    NSString *query = [NSString stringWithFormat:@"part-number-marker=%lu&uploadId=%@", (unsigned long)partNumberMarker, AFPercentEscapedStringFromString(uploadID)];
 
-    if (fileError || !response || !data) {
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"GET" path:path query:query headerFields:nil body:nil error:&requestError];
+    if (!request) {
         if (failure) {
-            failure(fileError);
+            failure(requestError);
         }
 
         return nil;
     }
 
-    destinationPath = AFPathByEscapingSpacesWithPlusSigns(destinationPath);
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityNormal retryable:YES configuration:nil success:^(AFHTTPRequestOperation *operation, __unused id responseObject) {
+        AFAmazonS3XMLRecordParser *parser = [[AFAmazonS3XMLRecordParser alloc] initWithRecordElementName:@"Part"];
+        if ([parser parseData:operation.responseData] && [parser.rootElementName isEqualToString:@"ListPartsResult"]) {
+            NSUInteger nextPartNumberMarker = 0;
+            if ([parser.values[@"IsTruncated"] isEqualToString:@"true"]) {
+                nextPartNumberMarker = (NSUInteger)[parser.values[@"NextPartNumberMarker"] integerValue];
+            }
 
-    NSMutableURLRequest *request = nil;
-    if ([method compare:@"POST" options:NSCaseInsensitiveSearch] == NSOrderedSame) {
-        NSError *requestError = nil;
-        request = [self.requestSerializer multipartFormRequestWithMethod:method URLString:[[self.baseURL URLByAppendingPathComponent:destinationPath] absoluteString] parameters:parameters constructingBodyWithBlock:^(id <AFMultipartFormData> formData) {
-            if (![parameters valueForKey:@"key"]) {
-                [formData appendPartWithFormData:[[filePath lastPathComponent] dataUsingEncoding:NSUTF8StringEncoding] name:@"key"];
+            if (success) {
+                success(parser.records, nextPartNumberMarker);
             }
+        } else {
+            if (failure) {
+                NSError *error = AFAmazonS3ErrorFromXMLResponseData(operation.responseData);
+                if (!error) {
+                    NSDictionary *userInfo = @{
+                                               NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Could not parse list of parts", @"AFAmazonS3Manager", nil)
+                                               };
 
-            [formData appendPartWithFileData:data name:@"file" fileName:[filePath lastPathComponent] mimeType:[response MIMEType]];
-        } error:&requestError];
+                    error = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotParseResponse userInfo:userInfo];
+                }
 
-        if (requestError || !request) {
-            if (failure) {
-                failure(requestError);
+                failure(error);
             }
-
-            return nil;
         }
-    } else {
-        request = [self.requestSerializer requestWithMethod:method URLString:[[self.baseURL URLByAppendingPathComponent:destinationPath] absoluteString] parameters:nil error:nil];
-        
-        // S3 expects parameters as headers for PUT requests
-        if (parameters != nil) {
-            for (id key in parameters) {
-                [request setValue:[parameters objectForKey:key] forHTTPHeaderField:key];
-            }
+    } failure:^(__unused AFHTTPRequestOperation *operation, NSError *error) {
+        if (failure) {
+            failure(error);
+        }
+    }];
+
+    return requestOperation;
+}
+
+- (AFHTTPRequestOperation *)abortMultipartUploadWithPath:(NSString *)path
+                                                uploadID:(NSString *)uploadID
+                                                 success:(void (^)(id responseObject))success
+                                                 failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(path);
+    NSParameterAssert(uploadID);
+
+    path = AFPathByEscapingSpacesWithPlusSigns(path);
+
+    NSString *query = [@"uploadId=" stringByAppendingString:AFPercentEscapedStringFromString(uploadID)];
+
+    NSError *requestError = nil;
+    NSMutableURLRequest *request = [self requestWithMethod:@"DELETE" path:path query:query headerFields:nil body:nil error:&requestError];
+    if (!request) {
+        if (failure) {
+            failure(requestError);
         }
-        
-        request.HTTPBody = data;
+
+        return nil;
     }
 
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(__unused AFHTTPRequestOperation *operation, id responseObject) {
+    AFHTTPRequestOperation *requestOperation = [self enqueueOperationWithRequest:request priority:NSOperationQueuePriorityNormal retryable:YES configuration:nil success:^(__unused AFHTTPRequestOperation *operation, id responseObject) {
         if (success) {
             success(responseObject);
         }
@@ -306,22 +1731,26 @@ static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
         }
     }];
 
-    [requestOperation setUploadProgressBlock:progress];
-
-    [self.operationQueue addOperation:requestOperation];
-    
     return requestOperation;
 }
 
-- (AFHTTPRequestOperation *)deleteObjectWithPath:(NSString *)path
-                                         success:(void (^)(id responseObject))success
-                                         failure:(void (^)(NSError *error))failure
+#pragma mark - AFHTTPRequestOperationManager
+
+- (AFHTTPRequestOperation *)HTTPRequestOperationWithRequest:(NSURLRequest *)request
+                                                    success:(void (^)(AFHTTPRequestOperation *operation, id responseObject))success
+                                                    failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure
 {
-    NSParameterAssert(path);
+    AFAmazonS3RequestOperation *operation = [[AFAmazonS3RequestOperation alloc] initWithRequest:request];
+    operation.responseSerializer = self.responseSerializer;
+    operation.shouldUseCredentialStorage = self.shouldUseCredentialStorage;
+    operation.credential = self.credential;
+    operation.securityPolicy = self.securityPolicy;
 
-    path = AFPathByEscapingSpacesWithPlusSigns(path);
+    [operation setCompletionBlockWithSuccess:success failure:failure];
+    operation.completionQueue = self.completionQueue;
+    operation.completionGroup = self.completionGroup;
 
-    return [self enqueueS3RequestOperationWithMethod:@"DELETE" path:path parameters:nil success:success failure:failure];
+    return operation;
 }
 
 #pragma mark - NSKeyValueObserving
@@ -338,6 +1767,29 @@ static NSString * AFPathByEscapingSpacesWithPlusSigns(NSString *path) {
     manager.requestSerializer = [self.requestSerializer copyWithZone:zone];
     manager.responseSerializer = [self.responseSerializer copyWithZone:zone];
 
+    manager.byteRangeDownloadSize = self.byteRangeDownloadSize;
+    manager.maximumConcurrentByteRangeDownloads = self.maximumConcurrentByteRangeDownloads;
+    manager.maximumByteRangeDownloadRetryCount = self.maximumByteRangeDownloadRetryCount;
+    manager.shouldStreamFileUploads = self.shouldStreamFileUploads;
+    manager.shouldVerifyObjectIntegrity = self.shouldVerifyObjectIntegrity;
+    manager.multipartUploadPartSize = self.multipartUploadPartSize;
+    manager.maximumConcurrentMultipartUploadParts = self.maximumConcurrentMultipartUploadParts;
+    manager.maximumMultipartUploadPartRetryCount = self.maximumMultipartUploadPartRetryCount;
+    manager.objectCache = self.objectCache;
+    manager.metrics = self.metrics;
+
+    // The copy has its own operation queue, so it is given its own scheduler with the same settings
+    if (self.scheduler) {
+        manager.scheduler = [[AFAmazonS3RequestScheduler alloc] initWithOperationQueue:manager.operationQueue];
+        manager.scheduler.initialConcurrencyPerPrefix = self.scheduler.initialConcurrencyPerPrefix;
+        manager.scheduler.minimumConcurrencyPerPrefix = self.scheduler.minimumConcurrencyPerPrefix;
+        manager.scheduler.maximumConcurrencyPerPrefix = self.scheduler.maximumConcurrencyPerPrefix;
+        manager.scheduler.latencyThreshold = self.scheduler.latencyThreshold;
+        manager.scheduler.maximumRetryCount = self.scheduler.maximumRetryCount;
+        manager.scheduler.retryBaseDelay = self.scheduler.retryBaseDelay;
+        manager.scheduler.maximumRetryDelay = self.scheduler.maximumRetryDelay;
+    }
+
     return manager;
 }
 
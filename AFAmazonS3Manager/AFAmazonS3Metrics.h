@@ -0,0 +1,159 @@
+// AFAmazonS3Metrics.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class AFURLConnectionOperation;
+
+/**
+ `AFAmazonS3RequestMetrics` describes a single request sent by an `AFAmazonS3Manager`. Each retry of a request is described separately.
+ */
+@interface AFAmazonS3RequestMetrics : NSObject
+
+/**
+ The kind of S3 operation, such as `GetObject`, `PutObject` or `UploadPart`.
+ */
+@property (readonly, nonatomic, copy) NSString *operationType;
+
+/**
+ The bucket the request was sent to, or the host if the request serializer has no bucket.
+ */
+@property (readonly, nonatomic, copy) NSString *bucket;
+
+/**
+ The HTTP method of the request.
+ */
+@property (readonly, nonatomic, copy) NSString *HTTPMethod;
+
+/**
+ The status code of the response, or `0` if no response was received.
+ */
+@property (readonly, nonatomic, assign) NSInteger statusCode;
+
+/**
+ The error the request failed with, if any.
+ */
+@property (readonly, nonatomic, strong) NSError *error;
+
+/**
+ The number of times the request had been retried before this attempt.
+ */
+@property (readonly, nonatomic, assign) NSUInteger retryCount;
+
+/**
+ The number of body bytes sent.
+ */
+@property (readonly, nonatomic, assign) long long numberOfBytesSent;
+
+/**
+ The number of body bytes received.
+ */
+@property (readonly, nonatomic, assign) long long numberOfBytesReceived;
+
+/**
+ The date the request was enqueued.
+ */
+@property (readonly, nonatomic, strong) NSDate *enqueueDate;
+
+/**
+ The time between enqueueing the request and its operation starting, which includes waiting for the scheduler and the operation queue.
+ */
+@property (readonly, nonatomic, assign) NSTimeInterval queueDuration;
+
+/**
+ The time between the operation starting and the response headers being received, which includes connecting, the TLS handshake, sending the request body and the server's processing time. `0` if no response was received.
+ */
+@property (readonly, nonatomic, assign) NSTimeInterval timeToFirstByte;
+
+/**
+ The time between the response headers being received and the operation finishing.
+ */
+@property (readonly, nonatomic, assign) NSTimeInterval transferDuration;
+
+/**
+ The time between enqueueing the request and its operation finishing.
+ */
+@property (readonly, nonatomic, assign) NSTimeInterval totalDuration;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFAmazonS3Metrics` records the timing, size and outcome of the requests sent by an `AFAmazonS3Manager`, and aggregates them by operation type and bucket.
+
+ ## Histograms
+
+ Durations are counted in histograms with logarithmic buckets, where the bucket at index `i` counts durations of less than `2^i` microseconds and at least half that. Histograms have a fixed size, so recording a request takes constant time and memory regardless of how many requests have been recorded.
+
+ ## Exporting
+
+ `snapshot` returns the aggregates as property list and JSON compatible objects, which can be sent to a monitoring service periodically. Individual requests can be exported as they finish with `requestMetricsBlock`.
+ */
+@interface AFAmazonS3Metrics : NSObject
+
+/**
+ A block called with the metrics of each request as it finishes, on a private serial queue.
+ */
+@property (nonatomic, copy) void (^requestMetricsBlock)(AFAmazonS3RequestMetrics *requestMetrics);
+
+///-----------------------
+/// @name Exporting Metrics
+///-----------------------
+
+/**
+ Returns the aggregated metrics of the requests finished so far, as an array with a dictionary for each operation type and bucket.
+
+ @discussion Each dictionary has the keys `operationType`, `bucket`, `requests`, `retries`, `errors`, `bytesSent`, `bytesReceived` and `statusCodes`, which maps status codes as strings to counts. The keys `queueDuration`, `timeToFirstByte`, `transferDuration` and `totalDuration` each map to a histogram dictionary with the keys `count`, `mean`, `maximum`, `p50`, `p90` and `p99` in seconds, where percentiles are the upper bound of the bucket they fall in, and `buckets`, an array of counts.
+ */
+- (NSArray *)snapshot;
+
+/**
+ Discards the aggregated metrics. Requests in flight are still recorded when they finish.
+ */
+- (void)reset;
+
+///-----------------------
+/// @name Recording Requests
+///-----------------------
+
+/**
+ Starts recording an operation before it is enqueued. Called by `AFAmazonS3Manager`.
+
+ @param operation The operation to record. Must not be `nil`.
+ @param bucket The bucket the request is sent to.
+ @param retryCount The number of times the request has already been retried.
+ */
+- (void)startRecordingOperation:(AFURLConnectionOperation *)operation
+                         bucket:(NSString *)bucket
+                     retryCount:(NSUInteger)retryCount;
+
+/**
+ Finishes recording an operation, adding it to the aggregates. Called by `AFAmazonS3Manager` once the operation has finished.
+
+ @param operation The finished operation.
+ @param error The error the operation finished with, if any.
+ */
+- (void)finishRecordingOperation:(AFURLConnectionOperation *)operation
+                           error:(NSError *)error;
+
+@end
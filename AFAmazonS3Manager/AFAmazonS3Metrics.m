@@ -0,0 +1,416 @@
+// AFAmazonS3Metrics.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3Metrics.h"
+#import "AFURLConnectionOperation.h"
+
+#define AFAmazonS3MetricsNumberOfHistogramBuckets 32
+
+static void * AFAmazonS3MetricsObservationContext = &AFAmazonS3MetricsObservationContext;
+
+typedef struct {
+    uint64_t counts[AFAmazonS3MetricsNumberOfHistogramBuckets];
+    uint64_t count;
+    NSTimeInterval sum;
+    NSTimeInterval maximum;
+} AFAmazonS3MetricsHistogram;
+
+static void AFHistogramAddDuration(AFAmazonS3MetricsHistogram *histogram, NSTimeInterval duration) {
+    duration = MAX(duration, 0.0);
+
+    uint64_t microseconds = (uint64_t)(duration * 1000000.0);
+    NSUInteger index = microseconds == 0 ? 0 : MIN((NSUInteger)(64 - __builtin_clzll(microseconds)), (NSUInteger)(AFAmazonS3MetricsNumberOfHistogramBuckets - 1));
+
+    histogram->counts[index]++;
+    histogram->count++;
+    histogram->sum += duration;
+    histogram->maximum = MAX(histogram->maximum, duration);
+}
+
+static NSTimeInterval AFHistogramPercentile(const AFAmazonS3MetricsHistogram *histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0.0;
+    }
+
+    uint64_t rank = (uint64_t)ceil(percentile * histogram->count);
+    uint64_t cumulativeCount = 0;
+    for (NSUInteger index = 0; index < AFAmazonS3MetricsNumberOfHistogramBuckets; index++) {
+        cumulativeCount += histogram->counts[index];
+        if (cumulativeCount >= rank) {
+            return MIN(ldexp(1.0, (int)index) / 1000000.0, histogram->maximum);
+        }
+    }
+
+    return histogram->maximum;
+}
+
+static NSDictionary * AFDictionaryFromHistogram(const AFAmazonS3MetricsHistogram *histogram) {
+    NSMutableArray *mutableCounts = [NSMutableArray arrayWithCapacity:AFAmazonS3MetricsNumberOfHistogramBuckets];
+    for (NSUInteger index = 0; index < AFAmazonS3MetricsNumberOfHistogramBuckets; index++) {
+        [mutableCounts addObject:@(histogram->counts[index])];
+    }
+
+    return @{
+             @"count": @(histogram->count),
+             @"mean": @(histogram->count > 0 ? histogram->sum / histogram->count : 0.0),
+             @"maximum": @(histogram->maximum),
+             @"p50": @(AFHistogramPercentile(histogram, 0.50)),
+             @"p90": @(AFHistogramPercentile(histogram, 0.90)),
+             @"p99": @(AFHistogramPercentile(histogram, 0.99)),
+             @"buckets": mutableCounts
+             };
+}
+
+static NSString * AFOperationTypeForRequest(NSURLRequest *request) {
+    NSString *method = [request.HTTPMethod uppercaseString];
+
+    NSMutableSet *mutableParameterNames = [NSMutableSet set];
+    for (NSString *pair in [[request.URL query] componentsSeparatedByString:@"&"]) {
+        [mutableParameterNames addObject:[[pair componentsSeparatedByString:@"="] firstObject]];
+    }
+
+    BOOL copy = [request valueForHTTPHeaderField:@"x-amz-copy-source"] != nil;
+
+    if ([mutableParameterNames containsObject:@"uploads"]) {
+        return [method isEqualToString:@"POST"] ? @"InitiateMultipartUpload" : @"ListMultipartUploads";
+    } else if ([mutableParameterNames containsObject:@"uploadId"]) {
+        if ([method isEqualToString:@"PUT"]) {
+            return copy ? @"UploadPartCopy" : @"UploadPart";
+        } else if ([method isEqualToString:@"POST"]) {
+            return @"CompleteMultipartUpload";
+        } else if ([method isEqualToString:@"DELETE"]) {
+            return @"AbortMultipartUpload";
+        }
+
+        return @"ListParts";
+    } else if ([mutableParameterNames containsObject:@"delete"] && [method isEqualToString:@"POST"]) {
+        return @"DeleteObjects";
+    }
+
+    if ([method isEqualToString:@"GET"]) {
+        NSString *path = [request.URL path];
+        if ([mutableParameterNames containsObject:@"list-type"] || [mutableParameterNames containsObject:@"prefix"] || [mutableParameterNames containsObject:@"marker"] || [path length] <= 1) {
+            return @"ListObjects";
+        }
+
+        return [request valueForHTTPHeaderField:@"Range"] ? @"GetObjectRange" : @"GetObject";
+    } else if ([method isEqualToString:@"HEAD"]) {
+        return @"HeadObject";
+    } else if ([method isEqualToString:@"PUT"]) {
+        return copy ? @"CopyObject" : @"PutObject";
+    } else if ([method isEqualToString:@"POST"]) {
+        return @"PostObject";
+    } else if ([method isEqualToString:@"DELETE"]) {
+        return @"DeleteObject";
+    }
+
+    return method ?: @"Unknown";
+}
+
+static long long AFNumberOfBytesSentByOperation(AFURLConnectionOperation *operation) {
+    NSURLRequest *request = operation.request;
+    if (request.HTTPBodyStream) {
+        return MAX([[request valueForHTTPHeaderField:@"Content-Length"] longLongValue], 0LL);
+    }
+
+    return (long long)[request.HTTPBody length];
+}
+
+static long long AFNumberOfBytesReceivedByOperation(AFURLConnectionOperation *operation, NSError *error) {
+    if ([[operation.request.HTTPMethod uppercaseString] isEqualToString:@"HEAD"]) {
+        return 0;
+    }
+
+    NSData *responseData = operation.responseData;
+    if (responseData) {
+        return (long long)[responseData length];
+    }
+
+    // Responses written to file streams are not kept in memory, but are complete when the operation succeeds
+    long long expectedContentLength = [operation.response expectedContentLength];
+    if (!error && expectedContentLength != NSURLResponseUnknownLength) {
+        return expectedContentLength;
+    }
+
+    return 0;
+}
+
+#pragma mark -
+
+@interface AFAmazonS3RequestMetrics ()
+@property (readwrite, nonatomic, copy) NSString *operationType;
+@property (readwrite, nonatomic, copy) NSString *bucket;
+@property (readwrite, nonatomic, copy) NSString *HTTPMethod;
+@property (readwrite, nonatomic, assign) NSInteger statusCode;
+@property (readwrite, nonatomic, strong) NSError *error;
+@property (readwrite, nonatomic, assign) NSUInteger retryCount;
+@property (readwrite, nonatomic, assign) long long numberOfBytesSent;
+@property (readwrite, nonatomic, assign) long long numberOfBytesReceived;
+@property (readwrite, nonatomic, strong) NSDate *enqueueDate;
+@property (readwrite, nonatomic, assign) CFAbsoluteTime enqueueTime;
+@property (readwrite, nonatomic, assign) CFAbsoluteTime startTime;
+@property (readwrite, nonatomic, assign) CFAbsoluteTime responseTime;
+@property (readwrite, nonatomic, assign) CFAbsoluteTime finishTime;
+@end
+
+@implementation AFAmazonS3RequestMetrics
+
+- (NSTimeInterval)queueDuration {
+    return self.startTime > 0 ? self.startTime - self.enqueueTime : self.finishTime - self.enqueueTime;
+}
+
+- (NSTimeInterval)timeToFirstByte {
+    return self.responseTime > 0 && self.startTime > 0 ? self.responseTime - self.startTime : 0.0;
+}
+
+- (NSTimeInterval)transferDuration {
+    return self.responseTime > 0 ? self.finishTime - self.responseTime : 0.0;
+}
+
+- (NSTimeInterval)totalDuration {
+    return self.finishTime - self.enqueueTime;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, operationType: %@, bucket: %@, statusCode: %ld, retryCount: %lu, totalDuration: %f>", NSStringFromClass([self class]), self, self.operationType, self.bucket, (long)self.statusCode, (unsigned long)self.retryCount, self.totalDuration];
+}
+
+@end
+
+#pragma mark -
+
+@interface AFAmazonS3MetricsAggregate : NSObject {
+@public
+    AFAmazonS3MetricsHistogram _queueDurationHistogram;
+    AFAmazonS3MetricsHistogram _timeToFirstByteHistogram;
+    AFAmazonS3MetricsHistogram _transferDurationHistogram;
+    AFAmazonS3MetricsHistogram _totalDurationHistogram;
+}
+@property (readwrite, nonatomic, copy) NSString *operationType;
+@property (readwrite, nonatomic, copy) NSString *bucket;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfRequests;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfRetries;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfErrors;
+@property (readwrite, nonatomic, assign) long long numberOfBytesSent;
+@property (readwrite, nonatomic, assign) long long numberOfBytesReceived;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *statusCodeCounts;
+@end
+
+@implementation AFAmazonS3MetricsAggregate
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.statusCodeCounts = [NSMutableDictionary dictionary];
+
+    return self;
+}
+
+- (void)addRequestMetrics:(AFAmazonS3RequestMetrics *)requestMetrics {
+    self.numberOfRequests++;
+    if (requestMetrics.retryCount > 0) {
+        self.numberOfRetries++;
+    }
+
+    if (requestMetrics.error) {
+        self.numberOfErrors++;
+    }
+
+    self.numberOfBytesSent += requestMetrics.numberOfBytesSent;
+    self.numberOfBytesReceived += requestMetrics.numberOfBytesReceived;
+
+    if (requestMetrics.statusCode > 0) {
+        NSString *statusCode = [@(requestMetrics.statusCode) stringValue];
+        self.statusCodeCounts[statusCode] = @([self.statusCodeCounts[statusCode] unsignedIntegerValue] + 1);
+    }
+
+    AFHistogramAddDuration(&_queueDurationHistogram, requestMetrics.queueDuration);
+    if (requestMetrics.responseTime > 0) {
+        AFHistogramAddDuration(&_timeToFirstByteHistogram, requestMetrics.timeToFirstByte);
+        AFHistogramAddDuration(&_transferDurationHistogram, requestMetrics.transferDuration);
+    }
+    AFHistogramAddDuration(&_totalDurationHistogram, requestMetrics.totalDuration);
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    return @{
+             @"operationType": self.operationType,
+             @"bucket": self.bucket,
+             @"requests": @(self.numberOfRequests),
+             @"retries": @(self.numberOfRetries),
+             @"errors": @(self.numberOfErrors),
+             @"bytesSent": @(self.numberOfBytesSent),
+             @"bytesReceived": @(self.numberOfBytesReceived),
+             @"statusCodes": [self.statusCodeCounts copy],
+             @"queueDuration": AFDictionaryFromHistogram(&_queueDurationHistogram),
+             @"timeToFirstByte": AFDictionaryFromHistogram(&_timeToFirstByteHistogram),
+             @"transferDuration": AFDictionaryFromHistogram(&_transferDurationHistogram),
+             @"totalDuration": AFDictionaryFromHistogram(&_totalDurationHistogram)
+             };
+}
+
+@end
+
+#pragma mark -
+
+@interface AFAmazonS3Metrics ()
+@property (readwrite, nonatomic, strong) NSMapTable *requestMetricsByOperation;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *aggregatesByKey;
+@property (readwrite, nonatomic, strong) dispatch_queue_t isolationQueue;
+@end
+
+@implementation AFAmazonS3Metrics
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.requestMetricsByOperation = [NSMapTable strongToStrongObjectsMapTable];
+    self.aggregatesByKey = [NSMutableDictionary dictionary];
+
+    self.isolationQueue = dispatch_queue_create("com.alamofire.networking.s3.metrics", DISPATCH_QUEUE_SERIAL);
+
+    return self;
+}
+
+#pragma mark -
+
+- (NSArray *)snapshot {
+    NSMutableArray *mutableAggregates = [NSMutableArray array];
+    dispatch_sync(self.isolationQueue, ^{
+        for (AFAmazonS3MetricsAggregate *aggregate in [self.aggregatesByKey allValues]) {
+            [mutableAggregates addObject:[aggregate dictionaryRepresentation]];
+        }
+    });
+
+    return mutableAggregates;
+}
+
+- (void)reset {
+    dispatch_async(self.isolationQueue, ^{
+        [self.aggregatesByKey removeAllObjects];
+    });
+}
+
+#pragma mark -
+
+- (void)startRecordingOperation:(AFURLConnectionOperation *)operation
+                         bucket:(NSString *)bucket
+                     retryCount:(NSUInteger)retryCount
+{
+    NSParameterAssert(operation);
+
+    AFAmazonS3RequestMetrics *requestMetrics = [[AFAmazonS3RequestMetrics alloc] init];
+    requestMetrics.operationType = AFOperationTypeForRequest(operation.request);
+    requestMetrics.bucket = bucket ?: ([operation.request.URL host] ?: @"");
+    requestMetrics.HTTPMethod = operation.request.HTTPMethod;
+    requestMetrics.retryCount = retryCount;
+    requestMetrics.numberOfBytesSent = AFNumberOfBytesSentByOperation(operation);
+    requestMetrics.enqueueDate = [NSDate date];
+    requestMetrics.enqueueTime = CFAbsoluteTimeGetCurrent();
+
+    dispatch_sync(self.isolationQueue, ^{
+        [self.requestMetricsByOperation setObject:requestMetrics forKey:operation];
+    });
+
+    // The operation has not been enqueued yet, so neither key path can change before it is observed
+    [operation addObserver:self forKeyPath:@"isExecuting" options:0 context:AFAmazonS3MetricsObservationContext];
+    [operation addObserver:self forKeyPath:@"response" options:0 context:AFAmazonS3MetricsObservationContext];
+}
+
+- (void)finishRecordingOperation:(AFURLConnectionOperation *)operation
+                           error:(NSError *)error
+{
+    CFAbsoluteTime finishTime = CFAbsoluteTimeGetCurrent();
+
+    [operation removeObserver:self forKeyPath:@"isExecuting" context:AFAmazonS3MetricsObservationContext];
+    [operation removeObserver:self forKeyPath:@"response" context:AFAmazonS3MetricsObservationContext];
+
+    NSInteger statusCode = [operation.response isKindOfClass:[NSHTTPURLResponse class]] ? [(NSHTTPURLResponse *)operation.response statusCode] : 0;
+    long long numberOfBytesReceived = AFNumberOfBytesReceivedByOperation(operation, error);
+
+    dispatch_async(self.isolationQueue, ^{
+        AFAmazonS3RequestMetrics *requestMetrics = [self.requestMetricsByOperation objectForKey:operation];
+        if (!requestMetrics) {
+            return;
+        }
+
+        [self.requestMetricsByOperation removeObjectForKey:operation];
+
+        requestMetrics.statusCode = statusCode;
+        requestMetrics.error = error;
+        requestMetrics.numberOfBytesReceived = numberOfBytesReceived;
+        requestMetrics.finishTime = finishTime;
+
+        NSString *key = [NSString stringWithFormat:@"%@ %@", requestMetrics.operationType, requestMetrics.bucket];
+        AFAmazonS3MetricsAggregate *aggregate = self.aggregatesByKey[key];
+        if (!aggregate) {
+            aggregate = [[AFAmazonS3MetricsAggregate alloc] init];
+            aggregate.operationType = requestMetrics.operationType;
+            aggregate.bucket = requestMetrics.bucket;
+            self.aggregatesByKey[key] = aggregate;
+        }
+
+        [aggregate addRequestMetrics:requestMetrics];
+
+        if (self.requestMetricsBlock) {
+            self.requestMetricsBlock(requestMetrics);
+        }
+    });
+}
+
+#pragma mark - NSKeyValueObserving
+
+- (void)observeValueForKeyPath:(NSString *)keyPath
+                      ofObject:(id)object
+                        change:(__unused NSDictionary *)change
+                       context:(void *)context
+{
+    if (context != AFAmazonS3MetricsObservationContext) {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+        return;
+    }
+
+    CFAbsoluteTime time = CFAbsoluteTimeGetCurrent();
+    AFURLConnectionOperation *operation = object;
+    BOOL started = [keyPath isEqualToString:@"isExecuting"] && [operation isExecuting];
+    BOOL responded = [keyPath isEqualToString:@"response"] && operation.response;
+    if (!started && !responded) {
+        return;
+    }
+
+    dispatch_async(self.isolationQueue, ^{
+        AFAmazonS3RequestMetrics *requestMetrics = [self.requestMetricsByOperation objectForKey:operation];
+        if (started && requestMetrics.startTime == 0) {
+            requestMetrics.startTime = time;
+        } else if (responded && requestMetrics.responseTime == 0) {
+            requestMetrics.responseTime = time;
+        }
+    });
+}
+
+@end
@@ -0,0 +1,154 @@
+// AFAmazonS3MultipartUpload.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class AFAmazonS3Manager;
+
+/**
+ `AFAmazonS3MultipartUpload` uploads a local file to S3 as a series of parts, using the Initiate, Upload Part, Complete, and Abort Multipart Upload operations of an `AFAmazonS3Manager`.
+
+ @discussion Parts are read from disk on a private queue immediately before they are sent, so at most `maximumConcurrentParts` parts are held in memory at once. A part that fails is retried on its own; if it fails more than `maximumPartRetryCount` times, the upload is aborted and the parts already sent are discarded by the server.
+
+ ## Resuming Uploads
+
+ When `journalPath` is set, the upload ID and the `ETag` of each completed part are archived to that path as the upload progresses, and an upload that fails is left on the server rather than aborted. An upload revived from its journal, or from any other archive, asks the server which parts it already has with List Parts, and sends only the rest. If the server no longer knows the upload, it is started again.
+
+ ## Copying Objects
+
+ An upload initialized with a copy source copies an existing object in the bucket on the server, without its bytes passing through the client. Objects up to 5 GB are copied with a single PUT Object - Copy request. Larger objects are copied in ranges with Upload Part - Copy, each range conditional on the `ETag` the source had when the copy began, so that a source replaced mid-copy fails the copy rather than mixing versions.
+ */
+@interface AFAmazonS3MultipartUpload : NSObject <NSSecureCoding>
+
+/**
+ The manager used to send requests. Uploads revived from an archive have no manager, and must be given one before they are started.
+ */
+@property (nonatomic, strong) AFAmazonS3Manager *manager;
+
+/**
+ The path to the local file being uploaded, or `nil` if an object is being copied.
+ */
+@property (readonly, nonatomic, copy) NSString *filePath;
+
+/**
+ The path of the object being copied, or `nil` if a local file is being uploaded.
+ */
+@property (readonly, nonatomic, copy) NSString *copySourcePath;
+
+/**
+ The destination path for the remote file, including its name.
+ */
+@property (readonly, nonatomic, copy) NSString *destinationPath;
+
+/**
+ The parameters set as HTTP header fields of the initiating request.
+ */
+@property (readonly, nonatomic, copy) NSDictionary *parameters;
+
+/**
+ The upload ID assigned by the server, or `nil` if the upload has not yet been initiated.
+ */
+@property (readonly, nonatomic, copy) NSString *uploadID;
+
+/**
+ The size of each part, in bytes. Defaults to the manager's `multipartUploadPartSize`, or to 512 MB when copying an object, since copied parts cost no client bandwidth. Changes made after the upload has started have no effect.
+
+ @discussion S3 allows at most 10,000 parts per upload, so the part size is increased as necessary for very large files.
+ */
+@property (nonatomic, assign) unsigned long long partSize;
+
+/**
+ The maximum number of parts sent at once. Defaults to the manager's `maximumConcurrentMultipartUploadParts`.
+ */
+@property (nonatomic, assign) NSUInteger maximumConcurrentParts;
+
+/**
+ The number of times a failed part is retried before the upload is aborted. Defaults to the manager's `maximumMultipartUploadPartRetryCount`.
+ */
+@property (nonatomic, assign) NSUInteger maximumPartRetryCount;
+
+/**
+ The path of the journal the state of the upload is written to as it progresses. `nil` by default. The journal is removed once the upload completes or is cancelled.
+ */
+@property (nonatomic, copy) NSString *journalPath;
+
+/**
+ Whether the upload has been cancelled.
+ */
+@property (readonly, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+
+/**
+ Initializes a multipart upload for the specified file.
+
+ @param manager The manager used to send requests. Must not be `nil`.
+ @param filePath The path to the local file. Must not be `nil`.
+ @param destinationPath The destination path for the remote file, including its name. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the initiating request.
+ */
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                       filePath:(NSString *)filePath
+                destinationPath:(NSString *)destinationPath
+                     parameters:(NSDictionary *)parameters;
+
+/**
+ Initializes a copy of an object in the manager's bucket.
+
+ @param manager The manager used to send requests. Must not be `nil`.
+ @param copySourcePath The path of the object to copy. Must not be `nil`.
+ @param destinationPath The destination path for the copy, including its name. Must not be `nil`.
+ @param parameters The parameters to be set as HTTP header fields of the copy request, or of the initiating request of a copy in parts. When copying in parts, the `Content-Type` and `x-amz-meta-` headers of the source are used unless `parameters` has a `Content-Type` or `x-amz-meta-` field, in any case, or an `x-amz-metadata-directive` of `REPLACE`, just as they would be for a single copy.
+ */
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                 copySourcePath:(NSString *)copySourcePath
+                destinationPath:(NSString *)destinationPath
+                     parameters:(NSDictionary *)parameters;
+
+/**
+ Revives an upload from the journal at the specified path.
+
+ @param journalPath The path of the journal. Must not be `nil`.
+ @param manager The manager used to send requests. Must not be `nil`.
+ @param error The error that occurred while reading the journal.
+
+ @return The upload, with its `journalPath` set, or `nil` if the journal could not be read.
+ */
++ (instancetype)multipartUploadWithJournalAtPath:(NSString *)journalPath
+                                         manager:(AFAmazonS3Manager *)manager
+                                           error:(NSError * __autoreleasing *)error;
+
+/**
+ Initiates the upload and begins sending parts, or resumes an upload revived from an archive. A copy first inspects its source with a `HEAD` request.
+
+ @param progress A block object to be called as parts are uploaded to the server. This block has no return value and takes three arguments: the number of bytes written since the last time the upload progress block was called, the total bytes written across all parts, and the size of the file. This block may be called multiple times, and will execute on the main thread.
+ @param success A block object to be executed when the upload has been completed by the server. This block has no return value and takes a single argument: the response object from the server.
+ @param failure A block object to be executed when the upload could not be completed. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+ */
+- (void)startWithProgress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                  success:(void (^)(id responseObject))success
+                  failure:(void (^)(NSError *error))failure;
+
+/**
+ Cancels any parts in flight and aborts the upload. The failure block is called with an `NSURLErrorCancelled` error.
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,726 @@
+// AFAmazonS3MultipartUpload.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3MultipartUpload.h"
+#import "AFAmazonS3Manager.h"
+#import "AFAmazonS3ResponseSerializer.h"
+
+static NSUInteger const AFAmazonS3MaximumNumberOfMultipartUploadParts = 10000;
+static unsigned long long const AFAmazonS3MaximumCopyObjectSize = 5ULL * 1024 * 1024 * 1024;
+static unsigned long long const AFAmazonS3DefaultMultipartCopyPartSize = 512 * 1024 * 1024;
+
+static void * AFAmazonS3MultipartUploadProcessingQueueKey = &AFAmazonS3MultipartUploadProcessingQueueKey;
+
+// Header fields are matched regardless of case, as with a single copy, where any Content-Type or user metadata replaces that of the source unless a directive is given
+static BOOL AFCopyParametersReplaceMetadata(NSDictionary *parameters) {
+    for (NSString *field in parameters) {
+        if ([field caseInsensitiveCompare:@"x-amz-metadata-directive"] == NSOrderedSame) {
+            return [[parameters[field] description] caseInsensitiveCompare:@"REPLACE"] == NSOrderedSame;
+        }
+    }
+
+    for (NSString *field in parameters) {
+        NSString *lowercaseField = [field lowercaseString];
+        if ([lowercaseField isEqualToString:@"content-type"] || [lowercaseField hasPrefix:@"x-amz-meta-"]) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+@interface AFAmazonS3MultipartUpload ()
+@property (readwrite, nonatomic, copy) NSString *filePath;
+@property (readwrite, nonatomic, copy) NSString *copySourcePath;
+@property (readwrite, nonatomic, copy) NSString *copySourceETag;
+@property (readwrite, nonatomic, copy) NSString *destinationPath;
+@property (readwrite, nonatomic, copy) NSDictionary *parameters;
+@property (readwrite, nonatomic, copy) NSString *uploadID;
+@property (readwrite, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+@property (readwrite, nonatomic, assign, getter = isCompleting) BOOL completing;
+@property (readwrite, nonatomic, assign, getter = isFinished) BOOL finished;
+@property (readwrite, nonatomic, assign) unsigned long long fileSize;
+@property (readwrite, nonatomic, strong) NSDate *fileModificationDate;
+@property (readwrite, nonatomic, strong) NSFileHandle *fileHandle;
+@property (readwrite, nonatomic, strong) NSMutableIndexSet *pendingPartNumbers;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *partETags;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *partRetryCounts;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *partBytesWritten;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *operationsByPartNumber;
+@property (readwrite, nonatomic, assign) long long totalBytesWritten;
+@property (readwrite, nonatomic, strong) dispatch_queue_t processingQueue;
+@property (readwrite, nonatomic, copy) void (^progress)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite);
+@property (readwrite, nonatomic, copy) void (^success)(id responseObject);
+@property (readwrite, nonatomic, copy) void (^failure)(NSError *error);
+@end
+
+@implementation AFAmazonS3MultipartUpload
+
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                       filePath:(NSString *)filePath
+                destinationPath:(NSString *)destinationPath
+                     parameters:(NSDictionary *)parameters
+{
+    NSParameterAssert(manager);
+    NSParameterAssert(filePath);
+    NSParameterAssert(destinationPath);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.manager = manager;
+    self.filePath = filePath;
+    self.destinationPath = destinationPath;
+    self.parameters = parameters;
+
+    self.partSize = manager.multipartUploadPartSize;
+    self.maximumConcurrentParts = manager.maximumConcurrentMultipartUploadParts;
+    self.maximumPartRetryCount = manager.maximumMultipartUploadPartRetryCount;
+
+    self.partETags = [NSMutableDictionary dictionary];
+    [self commonInit];
+
+    return self;
+}
+
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                 copySourcePath:(NSString *)copySourcePath
+                destinationPath:(NSString *)destinationPath
+                     parameters:(NSDictionary *)parameters
+{
+    NSParameterAssert(manager);
+    NSParameterAssert(copySourcePath);
+    NSParameterAssert(destinationPath);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.manager = manager;
+    self.copySourcePath = copySourcePath;
+    self.destinationPath = destinationPath;
+    self.parameters = parameters;
+
+    self.partSize = MAX(manager.multipartUploadPartSize, AFAmazonS3DefaultMultipartCopyPartSize);
+    self.maximumConcurrentParts = manager.maximumConcurrentMultipartUploadParts;
+    self.maximumPartRetryCount = manager.maximumMultipartUploadPartRetryCount;
+
+    self.partETags = [NSMutableDictionary dictionary];
+    [self commonInit];
+
+    return self;
+}
+
+- (void)commonInit {
+    self.partRetryCounts = [NSMutableDictionary dictionary];
+    self.partBytesWritten = [NSMutableDictionary dictionary];
+    self.operationsByPartNumber = [NSMutableDictionary dictionary];
+
+    self.processingQueue = dispatch_queue_create("com.alamofire.networking.s3.multipart-upload", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(self.processingQueue, AFAmazonS3MultipartUploadProcessingQueueKey, (__bridge void *)self, NULL);
+}
+
++ (instancetype)multipartUploadWithJournalAtPath:(NSString *)journalPath
+                                         manager:(AFAmazonS3Manager *)manager
+                                           error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(journalPath);
+    NSParameterAssert(manager);
+
+    NSData *data = [NSData dataWithContentsOfFile:journalPath options:0 error:error];
+    if (!data) {
+        return nil;
+    }
+
+    AFAmazonS3MultipartUpload *upload = nil;
+    @try {
+        NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+        unarchiver.requiresSecureCoding = YES;
+        upload = [unarchiver decodeObjectOfClass:self forKey:NSKeyedArchiveRootObjectKey];
+        [unarchiver finishDecoding];
+    } @catch (__unused NSException *exception) {
+        upload = nil;
+    }
+
+    if (!upload) {
+        if (error) {
+            *error = [[NSError alloc] initWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSFilePathErrorKey: journalPath}];
+        }
+
+        return nil;
+    }
+
+    upload.manager = manager;
+    upload.journalPath = journalPath;
+
+    return upload;
+}
+
+- (void)startWithProgress:(void (^)(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite))progress
+                  success:(void (^)(id responseObject))success
+                  failure:(void (^)(NSError *error))failure
+{
+    NSParameterAssert(self.manager);
+
+    self.progress = progress;
+    self.success = success;
+    self.failure = failure;
+
+    dispatch_async(self.processingQueue, ^{
+        if (self.copySourcePath) {
+            [self inspectCopySource];
+            return;
+        }
+
+        NSError *error = nil;
+        NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:self.filePath error:&error];
+        NSFileHandle *fileHandle = attributes ? [NSFileHandle fileHandleForReadingFromURL:[NSURL fileURLWithPath:self.filePath] error:&error] : nil;
+        if (!fileHandle) {
+            [self finishWithResponseObject:nil error:error];
+            return;
+        }
+
+        self.fileHandle = fileHandle;
+
+        if (self.uploadID) {
+            // Parts of a resumed upload are only valid for the file they were read from
+            if ([attributes fileSize] != self.fileSize || ![[attributes fileModificationDate] isEqualToDate:self.fileModificationDate]) {
+                NSDictionary *userInfo = @{
+                                           NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"File changed since upload began", @"AFAmazonS3Manager", nil),
+                                           NSFilePathErrorKey: self.filePath
+                                           };
+
+                [self finishWithResponseObject:nil error:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotOpenFile userInfo:userInfo]];
+                return;
+            }
+
+            [self resetPendingPartNumbers];
+            [self listPartsWithPartNumberMarker:0];
+            return;
+        }
+
+        self.fileSize = [attributes fileSize];
+        self.fileModificationDate = [attributes fileModificationDate];
+
+        [self initiateWithPartsOfFileSize];
+    });
+}
+
+- (void)cancel {
+    dispatch_async(self.processingQueue, ^{
+        if (self.finished) {
+            return;
+        }
+
+        self.cancelled = YES;
+
+        NSDictionary *userInfo = @{
+                                   NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Multipart upload cancelled", @"AFAmazonS3Manager", nil)
+                                   };
+
+        [self abortWithError:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCancelled userInfo:userInfo]];
+    });
+}
+
+#pragma mark -
+
+- (void)initiateWithPartsOfFileSize {
+    unsigned long long partSize = MAX(self.partSize, 1ULL);
+    if ((self.fileSize + partSize - 1) / partSize > AFAmazonS3MaximumNumberOfMultipartUploadParts) {
+        partSize = (self.fileSize + AFAmazonS3MaximumNumberOfMultipartUploadParts - 1) / AFAmazonS3MaximumNumberOfMultipartUploadParts;
+    }
+    self.partSize = partSize;
+
+    [self resetPendingPartNumbers];
+    [self initiate];
+}
+
+- (void)inspectCopySource {
+    [self.manager headObjectWithPath:self.copySourcePath success:^(NSHTTPURLResponse *response) {
+        dispatch_async(self.processingQueue, ^{
+            [self prepareCopyWithSourceResponse:response];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self finishWithResponseObject:nil error:error];
+        });
+    }];
+}
+
+- (void)prepareCopyWithSourceResponse:(NSHTTPURLResponse *)response {
+    if (self.finished) {
+        return;
+    }
+
+    NSString *ETag = [[AFAmazonS3ResponseObject responseObject:response] ETag];
+    NSString *contentLength = response.allHeaderFields[@"Content-Length"];
+    unsigned long long size = contentLength ? strtoull([contentLength UTF8String], NULL, 10) : (unsigned long long)MAX([response expectedContentLength], 0LL);
+
+    if (self.uploadID) {
+        // Parts of a resumed copy are only valid for the version of the object they were copied from
+        if (size != self.fileSize || ![ETag isEqualToString:self.copySourceETag]) {
+            NSDictionary *userInfo = @{
+                                       NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Object changed since copy began", @"AFAmazonS3Manager", nil)
+                                       };
+
+            [self finishWithResponseObject:nil error:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorBadServerResponse userInfo:userInfo]];
+            return;
+        }
+
+        [self resetPendingPartNumbers];
+        [self listPartsWithPartNumberMarker:0];
+        return;
+    }
+
+    self.fileSize = size;
+    self.copySourceETag = ETag;
+
+    if (size <= AFAmazonS3MaximumCopyObjectSize) {
+        [self copyWholeObject];
+        return;
+    }
+
+    // Unlike a single copy, a copy in parts does not carry over the source's content type and metadata
+    if (!AFCopyParametersReplaceMetadata(self.parameters)) {
+        NSMutableDictionary *mutableParameters = [NSMutableDictionary dictionaryWithDictionary:self.parameters ?: @{}];
+        [[response allHeaderFields] enumerateKeysAndObjectsUsingBlock:^(NSString *field, id value, __unused BOOL *stop) {
+            if ([field caseInsensitiveCompare:@"Content-Type"] == NSOrderedSame || [[field lowercaseString] hasPrefix:@"x-amz-meta-"]) {
+                // As with a copy directive, the source's value takes the place of the parameter, whatever its case
+                for (NSString *parameterField in [mutableParameters allKeys]) {
+                    if ([parameterField caseInsensitiveCompare:field] == NSOrderedSame) {
+                        [mutableParameters removeObjectForKey:parameterField];
+                    }
+                }
+
+                mutableParameters[field] = value;
+            }
+        }];
+        self.parameters = mutableParameters;
+    }
+
+    [self initiateWithPartsOfFileSize];
+}
+
+- (void)copyWholeObject {
+    AFHTTPRequestOperation *operation = [self.manager putObjectCopyWithSourcePath:self.copySourcePath destinationPath:self.destinationPath parameters:self.parameters success:^(id responseObject) {
+        dispatch_async(self.processingQueue, ^{
+            [self partWithNumber:1 didWriteBytes:(NSUInteger)self.fileSize totalBytesWritten:(long long)self.fileSize];
+            [self finishWithResponseObject:responseObject error:nil];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self finishWithResponseObject:nil error:error];
+        });
+    }];
+
+    self.operationsByPartNumber[@1] = operation ?: [NSNull null];
+}
+
+- (void)resetPendingPartNumbers {
+    NSUInteger numberOfParts = (NSUInteger)MAX((self.fileSize + self.partSize - 1) / self.partSize, 1ULL);
+    self.pendingPartNumbers = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(1, numberOfParts)];
+    [self.partETags removeAllObjects];
+    self.totalBytesWritten = 0;
+}
+
+- (unsigned long long)lengthOfPartWithNumber:(NSUInteger)partNumber {
+    unsigned long long offset = (partNumber - 1) * self.partSize;
+
+    return MIN(self.partSize, self.fileSize - offset);
+}
+
+- (void)initiate {
+    [self.manager initiateMultipartUploadWithPath:self.destinationPath parameters:self.parameters success:^(NSString *uploadID) {
+        dispatch_async(self.processingQueue, ^{
+            self.uploadID = uploadID;
+
+            if (self.finished) {
+                [self.manager abortMultipartUploadWithPath:self.destinationPath uploadID:uploadID success:nil failure:nil];
+                return;
+            }
+
+            [self writeJournal];
+            [self uploadNextParts];
+        });
+    } failure:^(NSError *initiateError) {
+        dispatch_async(self.processingQueue, ^{
+            [self finishWithResponseObject:nil error:initiateError];
+        });
+    }];
+}
+
+- (void)listPartsWithPartNumberMarker:(NSUInteger)partNumberMarker {
+    [self.manager listPartsWithPath:self.destinationPath uploadID:self.uploadID partNumberMarker:partNumberMarker success:^(NSArray *parts, NSUInteger nextPartNumberMarker) {
+        dispatch_async(self.processingQueue, ^{
+            if (self.finished) {
+                return;
+            }
+
+            // The server's list of parts takes precedence over the journal, which may not have been written after the last part finished
+            for (NSDictionary *part in parts) {
+                NSUInteger partNumber = (NSUInteger)[part[@"PartNumber"] integerValue];
+                NSString *ETag = part[@"ETag"];
+                if (![self.pendingPartNumbers containsIndex:partNumber] || [ETag length] == 0 || (unsigned long long)[part[@"Size"] longLongValue] != [self lengthOfPartWithNumber:partNumber]) {
+                    continue;
+                }
+
+                [self.pendingPartNumbers removeIndex:partNumber];
+                self.partETags[@(partNumber)] = ETag;
+                self.totalBytesWritten += (long long)[self lengthOfPartWithNumber:partNumber];
+            }
+
+            if (nextPartNumberMarker > 0) {
+                [self listPartsWithPartNumberMarker:nextPartNumberMarker];
+                return;
+            }
+
+            [self writeJournal];
+            [self uploadNextParts];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            if (self.finished) {
+                return;
+            }
+
+            // An upload that was completed, aborted, or expired is no longer known to the server, and is started again
+            NSHTTPURLResponse *response = error.userInfo[AFNetworkingOperationFailingURLResponseErrorKey];
+            if ([response statusCode] == 404) {
+                self.uploadID = nil;
+                [self resetPendingPartNumbers];
+                [self initiate];
+                return;
+            }
+
+            [self finishWithResponseObject:nil error:error];
+        });
+    }];
+}
+
+- (void)writeJournal {
+    if (!self.journalPath) {
+        return;
+    }
+
+    [[NSKeyedArchiver archivedDataWithRootObject:self] writeToFile:self.journalPath atomically:YES];
+}
+
+- (void)removeJournal {
+    if (!self.journalPath) {
+        return;
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:self.journalPath error:nil];
+}
+
+- (void)uploadNextParts {
+    if (self.finished || self.completing) {
+        return;
+    }
+
+    while ([self.operationsByPartNumber count] < MAX(self.maximumConcurrentParts, (NSUInteger)1) && [self.pendingPartNumbers count] > 0) {
+        NSUInteger partNumber = [self.pendingPartNumbers firstIndex];
+        [self.pendingPartNumbers removeIndex:partNumber];
+
+        if (![self uploadPartWithNumber:partNumber]) {
+            return;
+        }
+    }
+
+    if ([self.operationsByPartNumber count] == 0 && [self.pendingPartNumbers count] == 0) {
+        [self complete];
+    }
+}
+
+- (BOOL)uploadPartWithNumber:(NSUInteger)partNumber {
+    unsigned long long offset = (partNumber - 1) * self.partSize;
+
+    if (self.copySourcePath) {
+        unsigned long long length = [self lengthOfPartWithNumber:partNumber];
+
+        AFHTTPRequestOperation *operation = [self.manager uploadPartCopyWithSourcePath:self.copySourcePath destinationPath:self.destinationPath uploadID:self.uploadID partNumber:partNumber firstByte:offset lastByte:offset + length - 1 sourceETag:self.copySourceETag success:^(NSString *ETag) {
+            dispatch_async(self.processingQueue, ^{
+                [self partWithNumber:partNumber didWriteBytes:(NSUInteger)length totalBytesWritten:(long long)length];
+                [self partWithNumber:partNumber didFinishWithETag:ETag];
+            });
+        } failure:^(NSError *error) {
+            dispatch_async(self.processingQueue, ^{
+                [self partWithNumber:partNumber didFailWithError:error];
+            });
+        }];
+
+        self.operationsByPartNumber[@(partNumber)] = operation ?: [NSNull null];
+
+        return YES;
+    }
+
+    NSUInteger length = (NSUInteger)MIN(self.partSize, self.fileSize - offset);
+
+    NSData *data = nil;
+    @try {
+        [self.fileHandle seekToFileOffset:offset];
+        data = [self.fileHandle readDataOfLength:length];
+    } @catch (__unused NSException *exception) {
+        data = nil;
+    }
+
+    if ([data length] != length) {
+        [self abortWithError:[[NSError alloc] initWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSFilePathErrorKey: self.filePath}]];
+        return NO;
+    }
+
+    AFHTTPRequestOperation *operation = [self.manager uploadPartWithData:data path:self.destinationPath uploadID:self.uploadID partNumber:partNumber progress:^(NSUInteger bytesWritten, long long totalBytesWritten, __unused long long totalBytesExpectedToWrite) {
+        dispatch_async(self.processingQueue, ^{
+            [self partWithNumber:partNumber didWriteBytes:bytesWritten totalBytesWritten:totalBytesWritten];
+        });
+    } success:^(NSString *ETag) {
+        dispatch_async(self.processingQueue, ^{
+            [self partWithNumber:partNumber didFinishWithETag:ETag];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self partWithNumber:partNumber didFailWithError:error];
+        });
+    }];
+
+    // A request that could not be created reports its error through the failure block, so the part remains in flight until then
+    self.operationsByPartNumber[@(partNumber)] = operation ?: [NSNull null];
+
+    return YES;
+}
+
+- (void)partWithNumber:(NSUInteger)partNumber
+         didWriteBytes:(NSUInteger)bytesWritten
+     totalBytesWritten:(long long)totalBytesWritten
+{
+    if (self.finished || !self.operationsByPartNumber[@(partNumber)]) {
+        return;
+    }
+
+    long long previousBytesWritten = [self.partBytesWritten[@(partNumber)] longLongValue];
+    self.partBytesWritten[@(partNumber)] = @(totalBytesWritten);
+    self.totalBytesWritten += totalBytesWritten - previousBytesWritten;
+
+    void (^progress)(NSUInteger, long long, long long) = self.progress;
+    if (progress) {
+        long long total = self.totalBytesWritten;
+        long long expected = (long long)self.fileSize;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            progress(bytesWritten, total, expected);
+        });
+    }
+}
+
+- (void)partWithNumber:(NSUInteger)partNumber
+     didFinishWithETag:(NSString *)ETag
+{
+    if (self.finished) {
+        return;
+    }
+
+    if ([ETag length] == 0) {
+        NSDictionary *userInfo = @{
+                                   NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Missing ETag in response", @"AFAmazonS3Manager", nil)
+                                   };
+
+        [self partWithNumber:partNumber didFailWithError:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorBadServerResponse userInfo:userInfo]];
+        return;
+    }
+
+    [self.operationsByPartNumber removeObjectForKey:@(partNumber)];
+    self.partETags[@(partNumber)] = ETag;
+
+    [self writeJournal];
+    [self uploadNextParts];
+}
+
+- (void)partWithNumber:(NSUInteger)partNumber
+      didFailWithError:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+
+    [self.operationsByPartNumber removeObjectForKey:@(partNumber)];
+
+    self.totalBytesWritten -= [self.partBytesWritten[@(partNumber)] longLongValue];
+    [self.partBytesWritten removeObjectForKey:@(partNumber)];
+
+    NSUInteger retryCount = [self.partRetryCounts[@(partNumber)] unsignedIntegerValue];
+    if (retryCount < self.maximumPartRetryCount) {
+        self.partRetryCounts[@(partNumber)] = @(retryCount + 1);
+        [self.pendingPartNumbers addIndex:partNumber];
+        [self uploadNextParts];
+    } else {
+        [self abortWithError:error];
+    }
+}
+
+- (void)complete {
+    self.completing = YES;
+
+    [self.manager completeMultipartUploadWithPath:self.destinationPath uploadID:self.uploadID partETags:self.partETags success:^(id responseObject) {
+        dispatch_async(self.processingQueue, ^{
+            [self finishWithResponseObject:responseObject error:nil];
+        });
+    } failure:^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            [self abortWithError:error];
+        });
+    }];
+}
+
+- (void)abortWithError:(NSError *)error {
+    if (self.finished) {
+        return;
+    }
+
+    for (id operation in [self.operationsByPartNumber allValues]) {
+        if ([operation isKindOfClass:[NSOperation class]]) {
+            [(NSOperation *)operation cancel];
+        }
+    }
+    [self.operationsByPartNumber removeAllObjects];
+    [self.pendingPartNumbers removeAllIndexes];
+
+    // A journaled upload keeps its parts on the server so that it can be resumed, unless it was cancelled
+    if (self.journalPath && !self.cancelled) {
+        [self finishWithResponseObject:nil error:error];
+        return;
+    }
+
+    if (self.uploadID) {
+        [self.manager abortMultipartUploadWithPath:self.destinationPath uploadID:self.uploadID success:nil failure:nil];
+    }
+
+    [self removeJournal];
+    [self finishWithResponseObject:nil error:error];
+}
+
+- (void)finishWithResponseObject:(id)responseObject
+                           error:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+
+    self.finished = YES;
+
+    [self.fileHandle closeFile];
+    self.fileHandle = nil;
+
+    if (!error) {
+        [self removeJournal];
+    }
+
+    void (^success)(id) = self.success;
+    void (^failure)(NSError *) = self.failure;
+
+    self.progress = nil;
+    self.success = nil;
+    self.failure = nil;
+
+    dispatch_async(self.manager.completionQueue ?: dispatch_get_main_queue(), ^{
+        if (error) {
+            if (failure) {
+                failure(error);
+            }
+        } else {
+            if (success) {
+                success(responseObject);
+            }
+        }
+    });
+}
+
+#pragma mark - NSSecureCoding
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (id)initWithCoder:(NSCoder *)decoder {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.filePath = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(filePath))];
+    self.copySourcePath = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(copySourcePath))];
+    self.copySourceETag = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(copySourceETag))];
+    self.destinationPath = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(destinationPath))];
+    self.parameters = [decoder decodeObjectOfClasses:[NSSet setWithObjects:[NSDictionary class], [NSString class], [NSNumber class], nil] forKey:NSStringFromSelector(@selector(parameters))];
+    self.uploadID = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(uploadID))];
+    self.journalPath = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(journalPath))];
+    self.partSize = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(partSize))] unsignedLongLongValue];
+    self.maximumConcurrentParts = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumConcurrentParts))] unsignedIntegerValue];
+    self.maximumPartRetryCount = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumPartRetryCount))] unsignedIntegerValue];
+    self.fileSize = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(fileSize))] unsignedLongLongValue];
+    self.fileModificationDate = [decoder decodeObjectOfClass:[NSDate class] forKey:NSStringFromSelector(@selector(fileModificationDate))];
+
+    NSDictionary *partETags = [decoder decodeObjectOfClasses:[NSSet setWithObjects:[NSDictionary class], [NSString class], [NSNumber class], nil] forKey:NSStringFromSelector(@selector(partETags))];
+    self.partETags = [NSMutableDictionary dictionaryWithDictionary:partETags ?: @{}];
+
+    if ((!self.filePath && !self.copySourcePath) || !self.destinationPath || self.partSize == 0) {
+        return nil;
+    }
+
+    [self commonInit];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    void (^encode)(void) = ^{
+        [coder encodeObject:self.filePath forKey:NSStringFromSelector(@selector(filePath))];
+        [coder encodeObject:self.copySourcePath forKey:NSStringFromSelector(@selector(copySourcePath))];
+        [coder encodeObject:self.copySourceETag forKey:NSStringFromSelector(@selector(copySourceETag))];
+        [coder encodeObject:self.destinationPath forKey:NSStringFromSelector(@selector(destinationPath))];
+        [coder encodeObject:self.parameters forKey:NSStringFromSelector(@selector(parameters))];
+        [coder encodeObject:self.uploadID forKey:NSStringFromSelector(@selector(uploadID))];
+        [coder encodeObject:self.journalPath forKey:NSStringFromSelector(@selector(journalPath))];
+        [coder encodeObject:@(self.partSize) forKey:NSStringFromSelector(@selector(partSize))];
+        [coder encodeObject:@(self.maximumConcurrentParts) forKey:NSStringFromSelector(@selector(maximumConcurrentParts))];
+        [coder encodeObject:@(self.maximumPartRetryCount) forKey:NSStringFromSelector(@selector(maximumPartRetryCount))];
+        [coder encodeObject:@(self.fileSize) forKey:NSStringFromSelector(@selector(fileSize))];
+        [coder encodeObject:self.fileModificationDate forKey:NSStringFromSelector(@selector(fileModificationDate))];
+        [coder encodeObject:[self.partETags copy] forKey:NSStringFromSelector(@selector(partETags))];
+    };
+
+    // The state of the upload is only changed on the processing queue, which is also where the journal is written
+    if (dispatch_get_specific(AFAmazonS3MultipartUploadProcessingQueueKey) == (__bridge void *)self) {
+        encode();
+    } else {
+        dispatch_sync(self.processingQueue, encode);
+    }
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, filePath: %@, copySourcePath: %@, destinationPath: %@, uploadID: %@>", NSStringFromClass([self class]), self, self.filePath, self.copySourcePath, self.destinationPath, self.uploadID];
+}
+
+@end
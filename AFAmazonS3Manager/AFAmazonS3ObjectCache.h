@@ -0,0 +1,145 @@
+// AFAmazonS3ObjectCache.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ `AFAmazonS3ObjectCache` stores the bodies of objects read through an `AFAmazonS3Manager` on disk, along with their entity tags, so that repeated reads can be answered locally.
+
+ @discussion An object read within `freshnessInterval` of when it was last validated is returned without contacting the server. Otherwise, the manager sends its cached entity tag in an `If-None-Match` header, and a `304 Not Modified` response is answered with the cached body. When the cached bodies exceed `maximumSize`, the least recently used objects are removed.
+ */
+@interface AFAmazonS3ObjectCache : NSObject
+
+/**
+ The directory in which cached objects and their index are stored.
+ */
+@property (readonly, nonatomic, copy) NSURL *directoryURL;
+
+/**
+ The maximum combined size of the cached objects, in bytes. Objects larger than this are not cached.
+ */
+@property (nonatomic, assign) unsigned long long maximumSize;
+
+/**
+ The interval after an object was last validated by the server during which it is returned without a request. `0` by default, so that every read is validated.
+ */
+@property (nonatomic, assign) NSTimeInterval freshnessInterval;
+
+/**
+ The combined size of the cached objects, in bytes.
+ */
+@property (readonly, nonatomic, assign) unsigned long long currentSize;
+
+/**
+ The number of reads answered with a cached object, either within the freshness interval or after a `304 Not Modified` response.
+ */
+@property (readonly, nonatomic, assign) NSUInteger hitCount;
+
+/**
+ The number of reads for which the full object was downloaded.
+ */
+@property (readonly, nonatomic, assign) NSUInteger missCount;
+
+/**
+ Initializes a cache stored in the specified directory, loading the index of any objects cached there previously.
+
+ @param directoryURL The directory in which to store cached objects. It is created if it does not exist. Must not be `nil`.
+ @param maximumSize The maximum combined size of the cached objects, in bytes.
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL
+                         maximumSize:(unsigned long long)maximumSize;
+
+///-------------------------
+/// @name Accessing Objects
+///-------------------------
+
+/**
+ Returns the entity tag of the cached object for the specified key, or `nil` if the object is not cached.
+
+ @param key The cache key of the object.
+ @param fresh On return, whether the object was validated within the freshness interval. May be `NULL`.
+ */
+- (NSString *)ETagForKey:(NSString *)key
+                   fresh:(BOOL *)fresh;
+
+/**
+ Returns the cached body for the specified key, or `nil` if the object is not cached. Each body returned counts as a hit and marks the object as most recently used.
+
+ @param key The cache key of the object.
+ */
+- (NSData *)dataForKey:(NSString *)key;
+
+/**
+ Stores the body and entity tag of a downloaded object, which counts as a miss. Objects without an entity tag are not stored.
+
+ @param data The body of the object.
+ @param ETag The entity tag of the object.
+ @param key The cache key of the object.
+ */
+- (void)storeData:(NSData *)data
+             ETag:(NSString *)ETag
+           forKey:(NSString *)key;
+
+/**
+ Returns the generation of the cache, to be read before an object is requested and passed to `storeData:ETag:forKey:generation:` once it is downloaded.
+
+ @param key The cache key of the object.
+ */
+- (NSUInteger)generationForKey:(NSString *)key;
+
+/**
+ Stores the body and entity tag of a downloaded object, unless the object was removed after `generation` was read, in which case the body is out of date and is discarded.
+
+ @param data The body of the object.
+ @param ETag The entity tag of the object.
+ @param key The cache key of the object.
+ @param generation The value returned by `generationForKey:` before the object was requested.
+ */
+- (void)storeData:(NSData *)data
+             ETag:(NSString *)ETag
+           forKey:(NSString *)key
+       generation:(NSUInteger)generation;
+
+/**
+ Records that the server has confirmed the cached object for the specified key is current, which restarts its freshness interval.
+
+ @param key The cache key of the object.
+ */
+- (void)markObjectAsValidatedForKey:(NSString *)key;
+
+///-------------------------
+/// @name Removing Objects
+///-------------------------
+
+/**
+ Removes the cached object for the specified key.
+
+ @param key The cache key of the object.
+ */
+- (void)removeObjectForKey:(NSString *)key;
+
+/**
+ Removes every cached object and resets the hit and miss counts.
+ */
+- (void)removeAllObjects;
+
+@end
@@ -0,0 +1,350 @@
+// AFAmazonS3ObjectCache.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3ObjectCache.h"
+#import "AFAmazonS3RequestSerializer.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+#include <stdio.h>
+
+static NSString * const AFAmazonS3ObjectCacheIndexFileName = @"index.plist";
+static NSString * const AFAmazonS3ObjectCacheKeyKey = @"key";
+static NSString * const AFAmazonS3ObjectCacheETagKey = @"ETag";
+static NSString * const AFAmazonS3ObjectCacheSizeKey = @"size";
+static NSString * const AFAmazonS3ObjectCacheAccessDateKey = @"accessDate";
+static NSString * const AFAmazonS3ObjectCacheValidationDateKey = @"validationDate";
+
+static NSTimeInterval const AFAmazonS3ObjectCacheIndexSaveDelay = 1.0;
+static NSUInteger const AFAmazonS3ObjectCacheMaximumRemovalGenerationCount = 1024;
+
+static NSString * AFObjectCacheFileNameFromKey(NSString *key) {
+    const char *cString = [key UTF8String];
+
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(cString, (CC_LONG)strlen(cString), digest);
+
+    return AFAmazonS3HexEncodedStringFromData([NSData dataWithBytes:digest length:CC_SHA256_DIGEST_LENGTH]);
+}
+
+@interface AFAmazonS3ObjectCache ()
+@property (readwrite, nonatomic, copy) NSURL *directoryURL;
+@property (readwrite, nonatomic, assign) unsigned long long currentSize;
+@property (readwrite, nonatomic, assign) NSUInteger hitCount;
+@property (readwrite, nonatomic, assign) NSUInteger missCount;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *entriesByFileName;
+@property (readwrite, nonatomic, strong) NSMutableOrderedSet *leastRecentlyUsedFileNames;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *removalGenerationsByFileName;
+@property (readwrite, nonatomic, assign) NSUInteger generation;
+@property (readwrite, nonatomic, assign) NSUInteger minimumStoreGeneration;
+@property (readwrite, nonatomic, assign, getter = isIndexSaveScheduled) BOOL indexSaveScheduled;
+@property (readwrite, nonatomic, strong) dispatch_queue_t isolationQueue;
+@end
+
+@implementation AFAmazonS3ObjectCache
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL
+                         maximumSize:(unsigned long long)maximumSize
+{
+    NSParameterAssert(directoryURL);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.directoryURL = directoryURL;
+    self.maximumSize = maximumSize;
+
+    self.entriesByFileName = [NSMutableDictionary dictionary];
+    self.leastRecentlyUsedFileNames = [NSMutableOrderedSet orderedSet];
+    self.removalGenerationsByFileName = [NSMutableDictionary dictionary];
+
+    self.isolationQueue = dispatch_queue_create("com.alamofire.networking.s3.object-cache", DISPATCH_QUEUE_SERIAL);
+
+    [[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+    [self loadIndex];
+
+    return self;
+}
+
+#pragma mark -
+
+- (NSString *)ETagForKey:(NSString *)key
+                   fresh:(BOOL *)fresh
+{
+    NSString *fileName = AFObjectCacheFileNameFromKey(key);
+
+    __block NSString *ETag = nil;
+    __block BOOL isFresh = NO;
+    dispatch_sync(self.isolationQueue, ^{
+        NSDictionary *entry = self.entriesByFileName[fileName];
+        if (entry) {
+            ETag = entry[AFAmazonS3ObjectCacheETagKey];
+            isFresh = [[NSDate date] timeIntervalSinceDate:entry[AFAmazonS3ObjectCacheValidationDateKey]] < self.freshnessInterval;
+        }
+    });
+
+    if (fresh) {
+        *fresh = isFresh;
+    }
+
+    return ETag;
+}
+
+- (NSData *)dataForKey:(NSString *)key {
+    NSString *fileName = AFObjectCacheFileNameFromKey(key);
+
+    __block BOOL cached = NO;
+    dispatch_sync(self.isolationQueue, ^{
+        cached = self.entriesByFileName[fileName] != nil;
+    });
+
+    if (!cached) {
+        return nil;
+    }
+
+    // Bodies are read outside of the isolation queue; one evicted in the meantime is simply not found
+    NSData *data = [NSData dataWithContentsOfURL:[self.directoryURL URLByAppendingPathComponent:fileName] options:NSDataReadingMappedIfSafe error:nil];
+
+    __block BOOL valid = NO;
+    dispatch_sync(self.isolationQueue, ^{
+        NSMutableDictionary *mutableEntry = [self.entriesByFileName[fileName] mutableCopy];
+        if (!data || !mutableEntry || [mutableEntry[AFAmazonS3ObjectCacheSizeKey] unsignedLongLongValue] != [data length]) {
+            [self removeEntryForFileName:fileName];
+            [self scheduleIndexSave];
+            return;
+        }
+
+        valid = YES;
+
+        mutableEntry[AFAmazonS3ObjectCacheAccessDateKey] = [NSDate date];
+        self.entriesByFileName[fileName] = mutableEntry;
+
+        [self.leastRecentlyUsedFileNames removeObject:fileName];
+        [self.leastRecentlyUsedFileNames addObject:fileName];
+
+        self.hitCount++;
+        [self scheduleIndexSave];
+    });
+
+    return valid ? data : nil;
+}
+
+- (NSUInteger)generationForKey:(__unused NSString *)key {
+    __block NSUInteger generation = 0;
+    dispatch_sync(self.isolationQueue, ^{
+        generation = self.generation;
+    });
+
+    return generation;
+}
+
+- (BOOL)isStoreAllowedForFileName:(NSString *)fileName
+                       generation:(NSUInteger)generation
+{
+    return generation >= self.minimumStoreGeneration && generation >= [self.removalGenerationsByFileName[fileName] unsignedIntegerValue];
+}
+
+- (void)storeData:(NSData *)data
+             ETag:(NSString *)ETag
+           forKey:(NSString *)key
+{
+    [self storeData:data ETag:ETag forKey:key generation:[self generationForKey:key]];
+}
+
+- (void)storeData:(NSData *)data
+             ETag:(NSString *)ETag
+           forKey:(NSString *)key
+       generation:(NSUInteger)generation
+{
+    NSString *fileName = AFObjectCacheFileNameFromKey(key);
+    BOOL cacheable = [ETag length] > 0 && data && [data length] <= self.maximumSize;
+
+    // The body is written to a file of its own, and only moved into place if the object was not removed after it was requested
+    NSURL *temporaryFileURL = [self.directoryURL URLByAppendingPathComponent:[fileName stringByAppendingPathExtension:[[NSUUID UUID] UUIDString]]];
+    if (cacheable) {
+        cacheable = [data writeToURL:temporaryFileURL options:0 error:nil];
+    }
+
+    dispatch_sync(self.isolationQueue, ^{
+        self.missCount++;
+
+        if (![self isStoreAllowedForFileName:fileName generation:generation]) {
+            [[NSFileManager defaultManager] removeItemAtURL:temporaryFileURL error:nil];
+            return;
+        }
+
+        // The file is moved into place before the index refers to it, so an entry never names a partially written file
+        if (cacheable) {
+            cacheable = rename([[temporaryFileURL path] fileSystemRepresentation], [[[self.directoryURL URLByAppendingPathComponent:fileName] path] fileSystemRepresentation]) == 0;
+        }
+
+        if (!cacheable) {
+            [[NSFileManager defaultManager] removeItemAtURL:temporaryFileURL error:nil];
+            [self removeEntryForFileName:fileName];
+            [self scheduleIndexSave];
+            return;
+        }
+
+        // The file of a previous entry for the same key has just been replaced, so only its accounting is removed
+        NSDictionary *previousEntry = self.entriesByFileName[fileName];
+        if (previousEntry) {
+            [self.leastRecentlyUsedFileNames removeObject:fileName];
+            self.currentSize -= [previousEntry[AFAmazonS3ObjectCacheSizeKey] unsignedLongLongValue];
+        }
+
+        NSDate *date = [NSDate date];
+        self.entriesByFileName[fileName] = @{
+                                             AFAmazonS3ObjectCacheKeyKey: key,
+                                             AFAmazonS3ObjectCacheETagKey: ETag,
+                                             AFAmazonS3ObjectCacheSizeKey: @([data length]),
+                                             AFAmazonS3ObjectCacheAccessDateKey: date,
+                                             AFAmazonS3ObjectCacheValidationDateKey: date
+                                             };
+        [self.leastRecentlyUsedFileNames addObject:fileName];
+        self.currentSize += [data length];
+
+        [self evictObjectsIfNeeded];
+        [self scheduleIndexSave];
+    });
+}
+
+- (void)markObjectAsValidatedForKey:(NSString *)key {
+    NSString *fileName = AFObjectCacheFileNameFromKey(key);
+
+    dispatch_sync(self.isolationQueue, ^{
+        NSMutableDictionary *mutableEntry = [self.entriesByFileName[fileName] mutableCopy];
+        if (!mutableEntry) {
+            return;
+        }
+
+        mutableEntry[AFAmazonS3ObjectCacheValidationDateKey] = [NSDate date];
+        self.entriesByFileName[fileName] = mutableEntry;
+
+        [self scheduleIndexSave];
+    });
+}
+
+- (void)removeObjectForKey:(NSString *)key {
+    NSString *fileName = AFObjectCacheFileNameFromKey(key);
+
+    dispatch_sync(self.isolationQueue, ^{
+        self.generation++;
+
+        // Once too many removals are remembered, they are forgotten together, and every store begun before then is refused
+        if ([self.removalGenerationsByFileName count] >= AFAmazonS3ObjectCacheMaximumRemovalGenerationCount) {
+            [self.removalGenerationsByFileName removeAllObjects];
+            self.minimumStoreGeneration = self.generation;
+        } else {
+            self.removalGenerationsByFileName[fileName] = @(self.generation);
+        }
+
+        [self removeEntryForFileName:fileName];
+        [self scheduleIndexSave];
+    });
+}
+
+- (void)removeAllObjects {
+    dispatch_sync(self.isolationQueue, ^{
+        self.generation++;
+        self.minimumStoreGeneration = self.generation;
+        [self.removalGenerationsByFileName removeAllObjects];
+
+        for (NSString *fileName in [self.entriesByFileName allKeys]) {
+            [self removeEntryForFileName:fileName];
+        }
+
+        self.hitCount = 0;
+        self.missCount = 0;
+
+        [self scheduleIndexSave];
+    });
+}
+
+#pragma mark -
+
+- (void)removeEntryForFileName:(NSString *)fileName {
+    NSDictionary *entry = self.entriesByFileName[fileName];
+    if (!entry) {
+        return;
+    }
+
+    [self.entriesByFileName removeObjectForKey:fileName];
+    [self.leastRecentlyUsedFileNames removeObject:fileName];
+    self.currentSize -= [entry[AFAmazonS3ObjectCacheSizeKey] unsignedLongLongValue];
+
+    [[NSFileManager defaultManager] removeItemAtURL:[self.directoryURL URLByAppendingPathComponent:fileName] error:nil];
+}
+
+- (void)evictObjectsIfNeeded {
+    while (self.currentSize > self.maximumSize && [self.leastRecentlyUsedFileNames count] > 0) {
+        [self removeEntryForFileName:[self.leastRecentlyUsedFileNames firstObject]];
+    }
+}
+
+- (void)loadIndex {
+    NSDictionary *index = [NSDictionary dictionaryWithContentsOfURL:[self.directoryURL URLByAppendingPathComponent:AFAmazonS3ObjectCacheIndexFileName]];
+    if (![index isKindOfClass:[NSDictionary class]]) {
+        return;
+    }
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (NSString *fileName in index) {
+        NSDictionary *entry = index[fileName];
+        if (![entry isKindOfClass:[NSDictionary class]] || !entry[AFAmazonS3ObjectCacheETagKey] || ![fileManager fileExistsAtPath:[[self.directoryURL URLByAppendingPathComponent:fileName] path]]) {
+            continue;
+        }
+
+        self.entriesByFileName[fileName] = entry;
+        self.currentSize += [entry[AFAmazonS3ObjectCacheSizeKey] unsignedLongLongValue];
+    }
+
+    NSArray *fileNames = [[self.entriesByFileName allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString *fileName1, NSString *fileName2) {
+        return [self.entriesByFileName[fileName1][AFAmazonS3ObjectCacheAccessDateKey] compare:self.entriesByFileName[fileName2][AFAmazonS3ObjectCacheAccessDateKey]];
+    }];
+    [self.leastRecentlyUsedFileNames addObjectsFromArray:fileNames];
+
+    [self evictObjectsIfNeeded];
+}
+
+- (void)scheduleIndexSave {
+    if (self.indexSaveScheduled) {
+        return;
+    }
+
+    self.indexSaveScheduled = YES;
+
+    // Saves are coalesced, since every hit updates an access date
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(AFAmazonS3ObjectCacheIndexSaveDelay * NSEC_PER_SEC)), self.isolationQueue, ^{
+        self.indexSaveScheduled = NO;
+        [self.entriesByFileName writeToURL:[self.directoryURL URLByAppendingPathComponent:AFAmazonS3ObjectCacheIndexFileName] atomically:YES];
+    });
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, directoryURL: %@, currentSize: %llu, maximumSize: %llu, hitCount: %lu, missCount: %lu>", NSStringFromClass([self class]), self, self.directoryURL, self.currentSize, self.maximumSize, (unsigned long)self.hitCount, (unsigned long)self.missCount];
+}
+
+@end
@@ -0,0 +1,92 @@
+// AFAmazonS3ObjectEnumerator.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class AFAmazonS3Manager;
+@class AFAmazonS3ListBucketResult;
+
+/**
+ `AFAmazonS3ObjectEnumerator` lists the objects in a bucket one page at a time, following continuation tokens until the listing is complete.
+
+ @discussion As each page is handed to the page block, the request for the following page is sent, so the next page is usually ready by the time the block returns. Only the page being processed and at most one prefetched page are held in memory, however many objects the bucket contains.
+ */
+@interface AFAmazonS3ObjectEnumerator : NSObject
+
+/**
+ The manager used to send requests.
+ */
+@property (readonly, nonatomic, strong) AFAmazonS3Manager *manager;
+
+/**
+ If specified, only keys beginning with this prefix are listed.
+ */
+@property (readonly, nonatomic, copy) NSString *prefix;
+
+/**
+ If specified, keys that contain the delimiter after the prefix are rolled up into common prefixes.
+ */
+@property (readonly, nonatomic, copy) NSString *delimiter;
+
+/**
+ The maximum number of keys requested per page. `1000` by default, which is also the largest page S3 returns.
+ */
+@property (nonatomic, assign) NSUInteger maximumKeysPerPage;
+
+/**
+ Whether pages are requested with ListObjectsV2, rather than with the original ListObjects operation. `YES` by default.
+ */
+@property (nonatomic, assign) BOOL usesListObjectsV2;
+
+/**
+ Whether the enumeration has been cancelled.
+ */
+@property (readonly, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+
+/**
+ Initializes an enumerator for the objects in the manager's bucket.
+
+ @param manager The manager used to send requests. Must not be `nil`.
+ @param prefix If specified, only keys beginning with this prefix are listed.
+ @param delimiter If specified, keys that contain the delimiter after the prefix are rolled up into common prefixes.
+ */
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                         prefix:(NSString *)prefix
+                      delimiter:(NSString *)delimiter;
+
+/**
+ Requests the first page and begins the enumeration.
+
+ @param block A block object to be executed for each page. This block has no return value and takes two arguments: the page, and a reference to a Boolean value that may be set to `YES` to stop the enumeration. This block will execute on the main thread.
+ @param success A block object to be executed when every page has been listed, or the enumeration was stopped. This block has no return value and takes a single argument: the number of objects listed.
+ @param failure A block object to be executed when a page could not be listed. This block has no return value and takes a single argument: the `NSError` object describing error that occurred.
+ */
+- (void)startWithPageBlock:(void (^)(AFAmazonS3ListBucketResult *page, BOOL *stop))block
+                   success:(void (^)(NSUInteger numberOfObjects))success
+                   failure:(void (^)(NSError *error))failure;
+
+/**
+ Cancels the request in flight and ends the enumeration. The failure block is called with an `NSURLErrorCancelled` error. No page is passed to the page block after this, including pages returned by a retry of a cancelled request.
+ */
+- (void)cancel;
+
+@end
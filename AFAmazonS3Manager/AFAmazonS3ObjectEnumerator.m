@@ -0,0 +1,228 @@
+// AFAmazonS3ObjectEnumerator.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3ObjectEnumerator.h"
+#import "AFAmazonS3Manager.h"
+#import "AFAmazonS3ResponseSerializer.h"
+
+@interface AFAmazonS3ObjectEnumerator ()
+@property (readwrite, nonatomic, strong) AFAmazonS3Manager *manager;
+@property (readwrite, nonatomic, copy) NSString *prefix;
+@property (readwrite, nonatomic, copy) NSString *delimiter;
+@property (readwrite, nonatomic, assign, getter = isCancelled) BOOL cancelled;
+@property (readwrite, nonatomic, assign, getter = isDelivering) BOOL delivering;
+@property (readwrite, nonatomic, assign, getter = isFinished) BOOL finished;
+@property (readwrite, nonatomic, strong) AFHTTPRequestOperation *pageOperation;
+@property (readwrite, nonatomic, strong) AFAmazonS3ListBucketResult *prefetchedPage;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfObjects;
+@property (readwrite, nonatomic, strong) dispatch_queue_t processingQueue;
+@property (readwrite, nonatomic, copy) void (^pageBlock)(AFAmazonS3ListBucketResult *page, BOOL *stop);
+@property (readwrite, nonatomic, copy) void (^success)(NSUInteger numberOfObjects);
+@property (readwrite, nonatomic, copy) void (^failure)(NSError *error);
+@end
+
+@implementation AFAmazonS3ObjectEnumerator
+
+- (instancetype)initWithManager:(AFAmazonS3Manager *)manager
+                         prefix:(NSString *)prefix
+                      delimiter:(NSString *)delimiter
+{
+    NSParameterAssert(manager);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.manager = manager;
+    self.prefix = prefix;
+    self.delimiter = delimiter;
+
+    self.maximumKeysPerPage = 1000;
+    self.usesListObjectsV2 = YES;
+
+    self.processingQueue = dispatch_queue_create("com.alamofire.networking.s3.object-enumerator", DISPATCH_QUEUE_SERIAL);
+
+    return self;
+}
+
+- (void)startWithPageBlock:(void (^)(AFAmazonS3ListBucketResult *page, BOOL *stop))block
+                   success:(void (^)(NSUInteger numberOfObjects))success
+                   failure:(void (^)(NSError *error))failure
+{
+    self.pageBlock = block;
+    self.success = success;
+    self.failure = failure;
+
+    dispatch_async(self.processingQueue, ^{
+        [self requestPageWithToken:nil];
+    });
+}
+
+- (void)cancel {
+    dispatch_async(self.processingQueue, ^{
+        if (self.finished) {
+            return;
+        }
+
+        self.cancelled = YES;
+
+        [self.pageOperation cancel];
+
+        NSDictionary *userInfo = @{
+                                   NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Object enumeration cancelled", @"AFAmazonS3Manager", nil)
+                                   };
+
+        [self finishWithError:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCancelled userInfo:userInfo]];
+    });
+}
+
+#pragma mark -
+
+- (void)requestPageWithToken:(NSString *)token {
+    // A response that arrives after the enumeration was cancelled is discarded
+    void (^success)(AFAmazonS3ListBucketResult *) = ^(AFAmazonS3ListBucketResult *page) {
+        dispatch_async(self.processingQueue, ^{
+            if (self.cancelled) {
+                return;
+            }
+
+            [self didReceivePage:page];
+        });
+    };
+
+    void (^failure)(NSError *) = ^(NSError *error) {
+        dispatch_async(self.processingQueue, ^{
+            if (self.cancelled) {
+                return;
+            }
+
+            [self finishWithError:error];
+        });
+    };
+
+    if (self.usesListObjectsV2) {
+        self.pageOperation = [self.manager listObjectsWithPrefix:self.prefix delimiter:self.delimiter continuationToken:token maxKeys:self.maximumKeysPerPage success:success failure:failure];
+    } else {
+        self.pageOperation = [self.manager listObjectsWithPrefix:self.prefix delimiter:self.delimiter marker:token maxKeys:self.maximumKeysPerPage success:success failure:failure];
+    }
+}
+
+- (void)didReceivePage:(AFAmazonS3ListBucketResult *)page {
+    if (self.cancelled || self.finished) {
+        return;
+    }
+
+    self.pageOperation = nil;
+
+    if (self.delivering) {
+        self.prefetchedPage = page;
+    } else {
+        [self deliverPage:page];
+    }
+}
+
+- (void)deliverPage:(AFAmazonS3ListBucketResult *)page {
+    self.delivering = YES;
+    self.numberOfObjects += [page.objects count];
+
+    NSString *token = self.usesListObjectsV2 ? page.nextContinuationToken : page.nextMarker;
+    if (page.truncated && token) {
+        [self requestPageWithToken:token];
+    }
+
+    void (^pageBlock)(AFAmazonS3ListBucketResult *, BOOL *) = self.pageBlock;
+    dispatch_async(self.manager.completionQueue ?: dispatch_get_main_queue(), ^{
+        // The enumeration may have been cancelled while the page was waiting on the completion queue
+        __block BOOL cancelled = NO;
+        dispatch_sync(self.processingQueue, ^{
+            cancelled = self.cancelled;
+        });
+
+        BOOL stop = NO;
+        if (pageBlock && !cancelled) {
+            pageBlock(page, &stop);
+        }
+
+        dispatch_async(self.processingQueue, ^{
+            self.delivering = NO;
+
+            if (self.finished) {
+                return;
+            }
+
+            if (stop || !page.truncated) {
+                [self.pageOperation cancel];
+                [self finishWithError:nil];
+            } else if (!token) {
+                NSDictionary *userInfo = @{
+                                           NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Missing continuation token in truncated listing", @"AFAmazonS3Manager", nil)
+                                           };
+
+                [self finishWithError:[[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotParseResponse userInfo:userInfo]];
+            } else if (self.prefetchedPage) {
+                AFAmazonS3ListBucketResult *prefetchedPage = self.prefetchedPage;
+                self.prefetchedPage = nil;
+
+                [self deliverPage:prefetchedPage];
+            }
+        });
+    });
+}
+
+- (void)finishWithError:(NSError *)error {
+    if (self.finished) {
+        return;
+    }
+
+    self.finished = YES;
+    self.pageOperation = nil;
+    self.prefetchedPage = nil;
+
+    NSUInteger numberOfObjects = self.numberOfObjects;
+    void (^success)(NSUInteger) = self.success;
+    void (^failure)(NSError *) = self.failure;
+
+    self.pageBlock = nil;
+    self.success = nil;
+    self.failure = nil;
+
+    dispatch_async(self.manager.completionQueue ?: dispatch_get_main_queue(), ^{
+        if (error) {
+            if (failure) {
+                failure(error);
+            }
+        } else {
+            if (success) {
+                success(numberOfObjects);
+            }
+        }
+    });
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, prefix: %@, delimiter: %@, numberOfObjects: %lu>", NSStringFromClass([self class]), self, self.prefix, self.delimiter, (unsigned long)self.numberOfObjects];
+}
+
+@end
@@ -0,0 +1,135 @@
+// AFAmazonS3RequestScheduler.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ `AFAmazonS3RequestScheduler` admits the request operations of an `AFAmazonS3Manager` to its operation queue, limiting how many requests to each bucket prefix are in flight at once, and deciding whether failed requests are retried.
+
+ ## Concurrency
+
+ Requests are grouped by host and the first component of their path, which corresponds to the key prefix S3 partitions request rates by. Each group has its own concurrency limit, which starts at `initialConcurrencyPerPrefix` and adapts to the server: it grows by about one request for each limit's worth of fast responses, and is halved when S3 responds with `503 Slow Down`, a request times out, or a small request takes longer than `latencyThreshold`.
+
+ ## Priorities
+
+ Operations are admitted in order of their `queuePriority`. The manager sends interactive reads, such as object and listing requests, with `NSOperationQueuePriorityHigh`, and bulk transfers, such as upload parts and byte ranges, with `NSOperationQueuePriorityLow`. Low priority operations may use at most three quarters of a prefix's limit, so that there is always room for interactive requests. The priority of an operation may be changed before it is admitted.
+
+ ## Retries
+
+ Requests with idempotent methods, as well as multi-object deletes, whose body can be sent again are retried when the server responds with a `5xx` status code, or the connection fails or times out. Each retry waits a random interval of up to `retryBaseDelay` doubled for each previous attempt, capped at `maximumRetryDelay`, and is signed again before it is sent. The manager returns the operation of the first attempt; cancelling it also cancels the attempt in flight, and no further attempts are made.
+ */
+@interface AFAmazonS3RequestScheduler : NSObject
+
+/**
+ The operation queue to which operations are admitted.
+ */
+@property (readonly, nonatomic, strong) NSOperationQueue *operationQueue;
+
+/**
+ The concurrency limit of a prefix before any responses have been received. `8` by default.
+ */
+@property (nonatomic, assign) NSUInteger initialConcurrencyPerPrefix;
+
+/**
+ The lowest concurrency limit of a prefix. `1` by default.
+ */
+@property (nonatomic, assign) NSUInteger minimumConcurrencyPerPrefix;
+
+/**
+ The highest concurrency limit of a prefix. `64` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumConcurrencyPerPrefix;
+
+/**
+ The duration after which a request that sends and receives less than 1 MB is considered a sign of overload. `2` seconds by default.
+ */
+@property (nonatomic, assign) NSTimeInterval latencyThreshold;
+
+/**
+ The number of times a failed request is retried. `3` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumRetryCount;
+
+/**
+ The upper bound of the delay before the first retry. `0.1` seconds by default.
+ */
+@property (nonatomic, assign) NSTimeInterval retryBaseDelay;
+
+/**
+ The upper bound of the delay before any retry. `10` seconds by default.
+ */
+@property (nonatomic, assign) NSTimeInterval maximumRetryDelay;
+
+/**
+ Initializes a scheduler for the specified operation queue.
+
+ @param operationQueue The operation queue to which operations are admitted. Must not be `nil`.
+ */
+- (instancetype)initWithOperationQueue:(NSOperationQueue *)operationQueue;
+
+/**
+ Returns the current concurrency limit of each prefix that has had requests, keyed by host and prefix. A prefix is forgotten once it has had no requests for a minute.
+ */
+- (NSDictionary *)concurrencyLimitsByPrefix;
+
+///---------------------------
+/// @name Scheduling Operations
+///---------------------------
+
+/**
+ Adds an operation to be admitted to the operation queue once its prefix has capacity. Operations that are cancelled before they are admitted are admitted immediately, so that they finish.
+
+ @param operation The operation to schedule. Must not be `nil`.
+ @param request The request the operation sends, which determines its prefix. Must not be `nil`.
+ */
+- (void)scheduleOperation:(NSOperation *)operation
+               forRequest:(NSURLRequest *)request;
+
+/**
+ Records that a scheduled operation has finished, freeing its place and adjusting the concurrency limit of its prefix.
+
+ @param operation The finished operation.
+ @param response The response received, if any.
+ @param error The error the operation finished with, if any.
+ @param numberOfBytes The number of bytes sent and received, or `NSURLResponseUnknownLength` if unknown.
+ */
+- (void)operation:(NSOperation *)operation
+didFinishWithResponse:(NSHTTPURLResponse *)response
+            error:(NSError *)error
+    numberOfBytes:(long long)numberOfBytes;
+
+/**
+ Returns whether a failed request should be retried and, if so, how long to wait before retrying it.
+
+ @param request The request that failed.
+ @param response The response received, if any.
+ @param error The error the request failed with.
+ @param retryCount The number of times the request has already been retried.
+ @param delay On return, the interval to wait before retrying. May be `NULL`.
+ */
+- (BOOL)shouldRetryRequest:(NSURLRequest *)request
+                  response:(NSHTTPURLResponse *)response
+                     error:(NSError *)error
+                retryCount:(NSUInteger)retryCount
+                     delay:(NSTimeInterval *)delay;
+
+@end
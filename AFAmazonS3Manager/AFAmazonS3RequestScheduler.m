@@ -0,0 +1,381 @@
+// AFAmazonS3RequestScheduler.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3RequestScheduler.h"
+
+static NSUInteger const AFAmazonS3RequestSchedulerNumberOfLanes = 3;
+static long long const AFAmazonS3RequestSchedulerSmallRequestLength = 1024 * 1024;
+static NSTimeInterval const AFAmazonS3RequestSchedulerMinimumDecreaseInterval = 1.0;
+static NSTimeInterval const AFAmazonS3RequestSchedulerIdlePrefixInterval = 60.0;
+
+static void * AFAmazonS3RequestSchedulerObservationContext = &AFAmazonS3RequestSchedulerObservationContext;
+
+static NSUInteger AFLaneForOperation(NSOperation *operation) {
+    if (operation.queuePriority > NSOperationQueuePriorityNormal) {
+        return 0;
+    } else if (operation.queuePriority < NSOperationQueuePriorityNormal) {
+        return 2;
+    }
+
+    return 1;
+}
+
+static NSString * AFPrefixKeyForRequest(NSURLRequest *request) {
+    NSURL *URL = request.URL;
+    NSArray *pathComponents = [[URL path] pathComponents];
+
+    // Keys without a slash after the first component all share the root prefix
+    if ([pathComponents count] > 2) {
+        return [NSString stringWithFormat:@"%@/%@", [URL host] ?: @"", pathComponents[1]];
+    }
+
+    return [URL host] ?: @"";
+}
+
+static BOOL AFErrorIsTransient(NSError *error) {
+    if (![[error domain] isEqualToString:NSURLErrorDomain]) {
+        return NO;
+    }
+
+    switch ([error code]) {
+        case NSURLErrorTimedOut:
+        case NSURLErrorCannotFindHost:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorNetworkConnectionLost:
+        case NSURLErrorDNSLookupFailed:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+// Deleting the same keys again has the same result, so a multi-object delete can be sent again despite being a POST, as long as its body is in memory
+static BOOL AFRequestIsMultipleObjectDelete(NSURLRequest *request) {
+    if ([request.HTTPMethod caseInsensitiveCompare:@"POST"] != NSOrderedSame || !request.HTTPBody) {
+        return NO;
+    }
+
+    for (NSString *component in [[request.URL query] componentsSeparatedByString:@"&"]) {
+        if ([component isEqualToString:@"delete"] || [component hasPrefix:@"delete="]) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+#pragma mark -
+
+@interface AFAmazonS3RequestSchedulerPrefix : NSObject
+@property (readwrite, nonatomic, assign) double concurrencyLimit;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfOperationsInFlight;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfPendingOperations;
+@property (readwrite, nonatomic, strong) NSDate *lastDecreaseDate;
+@property (readwrite, nonatomic, strong) NSDate *lastActivityDate;
+@end
+
+@implementation AFAmazonS3RequestSchedulerPrefix
+@end
+
+@interface AFAmazonS3ScheduledOperation : NSObject
+@property (readwrite, nonatomic, strong) NSOperation *operation;
+@property (readwrite, nonatomic, strong) AFAmazonS3RequestSchedulerPrefix *prefix;
+@property (readwrite, nonatomic, strong) NSDate *startDate;
+@property (readwrite, nonatomic, assign, getter = isInFlight) BOOL inFlight;
+@end
+
+@implementation AFAmazonS3ScheduledOperation
+@end
+
+#pragma mark -
+
+@interface AFAmazonS3RequestScheduler ()
+@property (readwrite, nonatomic, strong) NSOperationQueue *operationQueue;
+@property (readwrite, nonatomic, strong) NSMutableArray *pendingOperations;
+@property (readwrite, nonatomic, strong) NSMapTable *admittedOperations;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *prefixesByKey;
+@property (readwrite, nonatomic, strong) NSDate *lastIdlePrefixRemovalDate;
+@property (readwrite, nonatomic, strong) dispatch_queue_t isolationQueue;
+@end
+
+@implementation AFAmazonS3RequestScheduler
+
+- (instancetype)initWithOperationQueue:(NSOperationQueue *)operationQueue {
+    NSParameterAssert(operationQueue);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.operationQueue = operationQueue;
+
+    self.initialConcurrencyPerPrefix = 8;
+    self.minimumConcurrencyPerPrefix = 1;
+    self.maximumConcurrencyPerPrefix = 64;
+    self.latencyThreshold = 2.0;
+    self.maximumRetryCount = 3;
+    self.retryBaseDelay = 0.1;
+    self.maximumRetryDelay = 10.0;
+
+    self.pendingOperations = [NSMutableArray array];
+    self.admittedOperations = [NSMapTable strongToStrongObjectsMapTable];
+    self.prefixesByKey = [NSMutableDictionary dictionary];
+
+    self.isolationQueue = dispatch_queue_create("com.alamofire.networking.s3.request-scheduler", DISPATCH_QUEUE_SERIAL);
+
+    return self;
+}
+
+- (NSDictionary *)concurrencyLimitsByPrefix {
+    NSMutableDictionary *mutableConcurrencyLimits = [NSMutableDictionary dictionary];
+    dispatch_sync(self.isolationQueue, ^{
+        [self.prefixesByKey enumerateKeysAndObjectsUsingBlock:^(NSString *key, AFAmazonS3RequestSchedulerPrefix *prefix, __unused BOOL *stop) {
+            mutableConcurrencyLimits[key] = @((NSUInteger)prefix.concurrencyLimit);
+        }];
+    });
+
+    return mutableConcurrencyLimits;
+}
+
+#pragma mark -
+
+- (void)scheduleOperation:(NSOperation *)operation
+               forRequest:(NSURLRequest *)request
+{
+    NSParameterAssert(operation);
+    NSParameterAssert(request);
+
+    NSString *prefixKey = AFPrefixKeyForRequest(request);
+
+    // The operation has not been added to the operation queue yet, so it cannot start before it is observed
+    [operation addObserver:self forKeyPath:@"isCancelled" options:0 context:AFAmazonS3RequestSchedulerObservationContext];
+    [operation addObserver:self forKeyPath:@"isExecuting" options:0 context:AFAmazonS3RequestSchedulerObservationContext];
+
+    dispatch_async(self.isolationQueue, ^{
+        AFAmazonS3RequestSchedulerPrefix *prefix = self.prefixesByKey[prefixKey];
+        if (!prefix) {
+            prefix = [[AFAmazonS3RequestSchedulerPrefix alloc] init];
+            prefix.concurrencyLimit = MAX(self.initialConcurrencyPerPrefix, (NSUInteger)1);
+            self.prefixesByKey[prefixKey] = prefix;
+        }
+
+        prefix.numberOfPendingOperations++;
+        prefix.lastActivityDate = [NSDate date];
+
+        AFAmazonS3ScheduledOperation *scheduledOperation = [[AFAmazonS3ScheduledOperation alloc] init];
+        scheduledOperation.operation = operation;
+        scheduledOperation.prefix = prefix;
+        [self.pendingOperations addObject:scheduledOperation];
+
+        [self admitPendingOperations];
+    });
+}
+
+- (void)operation:(NSOperation *)operation
+didFinishWithResponse:(NSHTTPURLResponse *)response
+            error:(NSError *)error
+    numberOfBytes:(long long)numberOfBytes
+{
+    NSDate *finishDate = [NSDate date];
+
+    [operation removeObserver:self forKeyPath:@"isCancelled" context:AFAmazonS3RequestSchedulerObservationContext];
+    [operation removeObserver:self forKeyPath:@"isExecuting" context:AFAmazonS3RequestSchedulerObservationContext];
+
+    dispatch_async(self.isolationQueue, ^{
+        AFAmazonS3ScheduledOperation *scheduledOperation = [self.admittedOperations objectForKey:operation];
+        if (!scheduledOperation) {
+            return;
+        }
+
+        [self.admittedOperations removeObjectForKey:operation];
+
+        if (scheduledOperation.inFlight) {
+            AFAmazonS3RequestSchedulerPrefix *prefix = scheduledOperation.prefix;
+            prefix.numberOfOperationsInFlight--;
+            prefix.lastActivityDate = finishDate;
+
+            // Latency is measured from when the operation started, since time spent waiting behind other operations in the queue says nothing about the server
+            NSTimeInterval latency = scheduledOperation.startDate ? [finishDate timeIntervalSinceDate:scheduledOperation.startDate] : 0.0;
+            BOOL throttled = [response statusCode] == 503 || ([[error domain] isEqualToString:NSURLErrorDomain] && [error code] == NSURLErrorTimedOut);
+            BOOL slow = numberOfBytes != NSURLResponseUnknownLength && numberOfBytes <= AFAmazonS3RequestSchedulerSmallRequestLength && latency > self.latencyThreshold;
+
+            if (throttled || slow) {
+                // Multiplicative decrease, at most once per interval so that one burst of throttled responses halves the limit only once
+                if (!prefix.lastDecreaseDate || [[NSDate date] timeIntervalSinceDate:prefix.lastDecreaseDate] >= AFAmazonS3RequestSchedulerMinimumDecreaseInterval) {
+                    prefix.concurrencyLimit = MAX(prefix.concurrencyLimit / 2.0, (double)MAX(self.minimumConcurrencyPerPrefix, (NSUInteger)1));
+                    prefix.lastDecreaseDate = [NSDate date];
+                }
+            } else if (response && [response statusCode] < 500) {
+                // Additive increase of one request for each limit's worth of responses
+                prefix.concurrencyLimit = MIN(prefix.concurrencyLimit + 1.0 / prefix.concurrencyLimit, (double)MAX(self.maximumConcurrencyPerPrefix, (NSUInteger)1));
+            }
+        }
+
+        [self admitPendingOperations];
+        [self removeIdlePrefixes];
+    });
+}
+
+- (BOOL)shouldRetryRequest:(NSURLRequest *)request
+                  response:(NSHTTPURLResponse *)response
+                     error:(NSError *)error
+                retryCount:(NSUInteger)retryCount
+                     delay:(NSTimeInterval *)delay
+{
+    if (retryCount >= self.maximumRetryCount) {
+        return NO;
+    }
+
+    static NSSet *_idempotentMethods = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _idempotentMethods = [NSSet setWithObjects:@"GET", @"HEAD", @"PUT", @"DELETE", nil];
+    });
+
+    // A body stream is consumed by the first attempt, so it cannot be sent again
+    if (request.HTTPBodyStream) {
+        return NO;
+    }
+
+    if (![_idempotentMethods containsObject:[request.HTTPMethod uppercaseString]] && !AFRequestIsMultipleObjectDelete(request)) {
+        return NO;
+    }
+
+    if ([response statusCode] < 500 && !AFErrorIsTransient(error)) {
+        return NO;
+    }
+
+    if (delay) {
+        NSTimeInterval maximumDelay = MIN(self.retryBaseDelay * pow(2.0, (double)retryCount), self.maximumRetryDelay);
+        *delay = maximumDelay * ((double)arc4random_uniform(1001) / 1000.0);
+    }
+
+    return YES;
+}
+
+#pragma mark -
+
+- (NSUInteger)concurrencyLimitOfPrefix:(AFAmazonS3RequestSchedulerPrefix *)prefix
+                               forLane:(NSUInteger)lane
+{
+    NSUInteger limit = MAX((NSUInteger)prefix.concurrencyLimit, (NSUInteger)1);
+
+    // Low priority operations leave a quarter of the limit to interactive requests
+    if (lane == AFAmazonS3RequestSchedulerNumberOfLanes - 1 && limit > 1) {
+        limit -= MAX(limit / 4, (NSUInteger)1);
+    }
+
+    return limit;
+}
+
+- (void)removeIdlePrefixes {
+    NSDate *date = [NSDate date];
+    if (self.lastIdlePrefixRemovalDate && [date timeIntervalSinceDate:self.lastIdlePrefixRemovalDate] < AFAmazonS3RequestSchedulerIdlePrefixInterval) {
+        return;
+    }
+
+    self.lastIdlePrefixRemovalDate = date;
+
+    // A prefix is kept for a while after its last request, so that a limit learned from throttling outlasts short pauses, and is then forgotten so that one entry per prefix does not accumulate
+    NSMutableArray *mutableIdleKeys = [NSMutableArray array];
+    [self.prefixesByKey enumerateKeysAndObjectsUsingBlock:^(NSString *key, AFAmazonS3RequestSchedulerPrefix *prefix, __unused BOOL *stop) {
+        if (prefix.numberOfOperationsInFlight == 0 && prefix.numberOfPendingOperations == 0 && [date timeIntervalSinceDate:prefix.lastActivityDate] >= AFAmazonS3RequestSchedulerIdlePrefixInterval) {
+            [mutableIdleKeys addObject:key];
+        }
+    }];
+
+    [self.prefixesByKey removeObjectsForKeys:mutableIdleKeys];
+}
+
+- (void)admitPendingOperations {
+    for (NSUInteger lane = 0; lane < AFAmazonS3RequestSchedulerNumberOfLanes && [self.pendingOperations count] > 0; lane++) {
+        NSMutableIndexSet *mutableAdmittedIndexes = [NSMutableIndexSet indexSet];
+        [self.pendingOperations enumerateObjectsUsingBlock:^(AFAmazonS3ScheduledOperation *scheduledOperation, NSUInteger idx, __unused BOOL *stop) {
+            NSOperation *operation = scheduledOperation.operation;
+
+            // Cancelled operations take no place, and are admitted only so that they finish and call their completion blocks
+            AFAmazonS3RequestSchedulerPrefix *prefix = scheduledOperation.prefix;
+            if (![operation isCancelled]) {
+                if (AFLaneForOperation(operation) != lane || prefix.numberOfOperationsInFlight >= [self concurrencyLimitOfPrefix:prefix forLane:lane]) {
+                    return;
+                }
+
+                prefix.numberOfOperationsInFlight++;
+                scheduledOperation.inFlight = YES;
+            }
+
+            prefix.numberOfPendingOperations--;
+
+            [self.admittedOperations setObject:scheduledOperation forKey:operation];
+            [mutableAdmittedIndexes addIndex:idx];
+        }];
+
+        NSArray *admittedOperations = [self.pendingOperations objectsAtIndexes:mutableAdmittedIndexes];
+        [self.pendingOperations removeObjectsAtIndexes:mutableAdmittedIndexes];
+
+        for (AFAmazonS3ScheduledOperation *scheduledOperation in admittedOperations) {
+            [self.operationQueue addOperation:scheduledOperation.operation];
+        }
+    }
+}
+
+#pragma mark - NSKeyValueObserving
+
+- (void)observeValueForKeyPath:(NSString *)keyPath
+                      ofObject:(id)object
+                        change:(__unused NSDictionary *)change
+                       context:(void *)context
+{
+    if (context != AFAmazonS3RequestSchedulerObservationContext) {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+        return;
+    }
+
+    NSDate *date = [NSDate date];
+    NSOperation *operation = object;
+    BOOL cancelled = [keyPath isEqualToString:@"isCancelled"] && [operation isCancelled];
+    BOOL started = [keyPath isEqualToString:@"isExecuting"] && [operation isExecuting];
+    if (!cancelled && !started) {
+        return;
+    }
+
+    dispatch_async(self.isolationQueue, ^{
+        if (cancelled) {
+            // A pending operation that is cancelled is admitted right away, rather than waiting for a place in its prefix
+            [self admitPendingOperations];
+        } else {
+            AFAmazonS3ScheduledOperation *scheduledOperation = [self.admittedOperations objectForKey:operation];
+            if (scheduledOperation && !scheduledOperation.startDate) {
+                scheduledOperation.startDate = date;
+            }
+        }
+    });
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, operationQueue: %@, concurrencyLimitsByPrefix: %@>", NSStringFromClass([self class]), self, self.operationQueue, [self concurrencyLimitsByPrefix]];
+}
+
+@end
@@ -22,10 +22,36 @@
 
 #import "AFURLRequestSerialization.h"
 
+/**
+ The signature versions supported by `AFAmazonS3RequestSerializer`.
+
+ - `AFAmazonS3SignatureVersion2`: The legacy HMAC-SHA1 `AWS <key>:<signature>` scheme.
+ - `AFAmazonS3SignatureVersion4`: The `AWS4-HMAC-SHA256` scheme, which is required by regions opened since 2014, such as `AFAmazonS3EUCentral1Region`.
+ */
+typedef NS_ENUM(NSInteger, AFAmazonS3SignatureVersion) {
+    AFAmazonS3SignatureVersion2 = 2,
+    AFAmazonS3SignatureVersion4 = 4,
+};
+
+/**
+ How the request body is covered by a Signature Version 4 signature.
+
+ - `AFAmazonS3SignedPayload`: The SHA-256 hash of the body is signed. Bodies set as an `HTTPBodyStream` cannot be hashed ahead of time, and are sent as `UNSIGNED-PAYLOAD`.
+ - `AFAmazonS3UnsignedPayload`: The body is not signed, and is sent as `UNSIGNED-PAYLOAD`.
+ - `AFAmazonS3StreamingSignedPayload`: `PUT` bodies of known length are sent with `aws-chunked` encoding, and each chunk is signed as it is read, as `STREAMING-AWS4-HMAC-SHA256-PAYLOAD`. Other requests are signed as with `AFAmazonS3SignedPayload`.
+ */
+typedef NS_ENUM(NSInteger, AFAmazonS3PayloadSigningMode) {
+    AFAmazonS3SignedPayload = 0,
+    AFAmazonS3UnsignedPayload,
+    AFAmazonS3StreamingSignedPayload,
+};
+
 /**
  `AFAmazonS3RequestSerializer` is an `AFHTTPRequestSerializer` subclass with convenience methods for creating requests for the Amazon S3 webservice, including creating an authorization header and building an endpoint URL for a given bucket, region, and TLS preferences. 
  
  @discussion Due to aggressive cache policies from the Foundation URL Loading System cause the unsupported `If-Modified-Since` header to be sent for certain requests, the default `cachePolicy` is `NSURLRequestReloadIgnoringCacheData`.
+
+ Copies and archives of a serializer keep its bucket, region, TLS preference, signature version, payload signing mode, session token and credentials. Archives therefore contain the secret, and should be stored accordingly.
  */
 @interface AFAmazonS3RequestSerializer : AFHTTPRequestSerializer
 
@@ -55,6 +81,18 @@
  */
 @property (nonatomic, assign) BOOL useSSL;
 
+/**
+ The signature version used to authorize requests. `AFAmazonS3SignatureVersion2` by default.
+
+ @discussion With Signature Version 4, the signing key is derived once per day and region, and cached, so that signing a request costs a single HMAC. Pre-signed requests and URLs are signed with the same version.
+ */
+@property (nonatomic, assign) AFAmazonS3SignatureVersion signatureVersion;
+
+/**
+ How request bodies are covered by Signature Version 4 signatures. `AFAmazonS3SignedPayload` by default. Has no effect with Signature Version 2.
+ */
+@property (nonatomic, assign) AFAmazonS3PayloadSigningMode payloadSigningMode;
+
 /**
  A readonly endpoint URL created for the specified bucket, region, and TLS preference. `AFAmazonS3Manager` uses this as a `baseURL` unless one is manually specified.
  */
@@ -82,19 +120,59 @@
 - (NSURLRequest *)requestBySettingAuthorizationHeadersForRequest:(NSURLRequest *)request
                                                            error:(NSError * __autoreleasing *)error;
 
+/**
+ Creates a request with the specified header fields and body, signed once they are set.
+
+ @param method The HTTP method. Must not be `nil`.
+ @param URLString The URL string of the request. Must not be `nil`.
+ @param headerFields The HTTP header fields to set on the request, if any.
+ @param body The HTTP body of the request, if any.
+ @param bodyStream The stream of the HTTP body of the request, if any. Must be `nil` if `body` is set.
+ @param error The error that occured while constructing the request.
+
+ @return The signed request.
+
+ @discussion Header fields and body may be part of the signature, so the request is signed only after they are set, rather than both when it is created and again afterwards.
+ */
+- (NSMutableURLRequest *)requestWithMethod:(NSString *)method
+                                 URLString:(NSString *)URLString
+                              headerFields:(NSDictionary *)headerFields
+                                      body:(NSData *)body
+                                bodyStream:(NSInputStream *)bodyStream
+                                     error:(NSError * __autoreleasing *)error;
+
 /**
  Returns a request with pre-signed credentials in the query string.
 
- @param request The request. `HTTPMethod` must be `GET`.
- @param expiration The request expiration. If `nil`, defaults to 1 hour from when method is called.
+ @param request The request. `HTTPMethod` must be `GET`, `HEAD`, `PUT` or `DELETE`.
+ @param expiration The request expiration. If `nil`, defaults to 1 hour from when method is called. Signature Version 4 URLs expire after at most 7 days.
  @param error The error that occured while constructing the request.
 
- @return The request with credentials signed in query string.
+ @return The request with credentials signed in query string, following `signatureVersion`. Any `Authorization` header of the original request is removed.
  */
 - (NSURLRequest *)preSignedRequestWithRequest:(NSURLRequest *)request
                                    expiration:(NSDate *)expiration
                                         error:(NSError * __autoreleasing *)error;
 
+/**
+ Returns pre-signed URL strings for the objects at the specified paths, without creating a request for each.
+
+ @param baseURL The URL the paths are relative to. Must not be `nil`.
+ @param paths The object paths. Must not be `nil`.
+ @param method The HTTP method the URLs are signed for: `GET`, `HEAD`, `PUT` or `DELETE`.
+ @param expiration The expiration of the URLs. If `nil`, defaults to 1 hour from when method is called. URLs signed with signature version 4 expire after 7 days at most.
+ @param error The error that occured while signing the URLs.
+
+ @return The URL strings, in the order of `paths`, or `nil` if no credentials have been set.
+
+ @discussion The part of the string to sign that is common to all paths is hashed once, so the cost of each additional URL is a single HMAC over its key. URLs are signed with `signatureVersion`, and include `sessionToken` if it is set. URLs signed for `PUT` with signature version 2 must be used without `Content-Type` or `Content-MD5` header fields.
+ */
+- (NSArray *)preSignedURLStringsWithBaseURL:(NSURL *)baseURL
+                                      paths:(NSArray *)paths
+                                     method:(NSString *)method
+                                 expiration:(NSDate *)expiration
+                                      error:(NSError * __autoreleasing *)error;
+
 @end
 
 ///----------------
@@ -126,3 +204,19 @@ extern NSString * const AFAmazonS3APSoutheast1Region;
 extern NSString * const AFAmazonS3APSoutheast2Region;
 extern NSString * const AFAmazonS3APNortheast2Region;
 extern NSString * const AFAmazonS3SAEast1Region;
+
+///----------------
+/// @name Functions
+///----------------
+
+/**
+ Returns a Base64 encoded string of the specified data, as used for request signatures and `Content-MD5` header values.
+
+ Blocks of input are encoded with NEON on arm64 and SSSE3 on x86_64, falling back to a scalar encoder for the remainder and on other architectures.
+ */
+extern NSString * AFAmazonS3Base64EncodedStringFromData(NSData *data);
+
+/**
+ Returns a lowercase hexadecimal string of the specified data, as used for Signature Version 4 hashes and signatures.
+ */
+extern NSString * AFAmazonS3HexEncodedStringFromData(NSData *data);
@@ -23,8 +23,17 @@
 #import "AFAmazonS3RequestSerializer.h"
 #import "AFAmazonS3Manager.h"
 
+#import <CommonCrypto/CommonDigest.h>
 #import <CommonCrypto/CommonHMAC.h>
 
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define AF_ENCODING_NEON 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define AF_ENCODING_SSSE3 1
+#endif
+
 NSString * const AFAmazonS3USStandardRegion = @"s3.amazonaws.com";
 NSString * const AFAmazonS3USWest1Region = @"s3-us-west-1.amazonaws.com";
 NSString * const AFAmazonS3USWest2Region = @"s3-us-west-2.amazonaws.com";
@@ -37,13 +46,20 @@ NSString * const AFAmazonS3SAEast1Region = @"s3-sa-east-1.amazonaws.com";
 
 static NSTimeInterval const AFAmazonS3DefaultExpirationTimeInterval = 60 * 60;
 
-static NSData * AFHMACSHA1EncodedDataFromStringWithKey(NSString *string, NSString *key) {
-    NSData *data = [string dataUsingEncoding:NSASCIIStringEncoding];
-    CCHmacContext context;
-    const char *keyCString = [key cStringUsingEncoding:NSASCIIStringEncoding];
+static NSString * const AFAWSV4SigningAlgorithm = @"AWS4-HMAC-SHA256";
+static NSString * const AFAWSV4ChunkSigningAlgorithm = @"AWS4-HMAC-SHA256-PAYLOAD";
+static NSString * const AFAWSV4UnsignedPayload = @"UNSIGNED-PAYLOAD";
+static NSString * const AFAWSV4StreamingPayload = @"STREAMING-AWS4-HMAC-SHA256-PAYLOAD";
+static NSString * const AFAWSV4EmptyPayloadHash = @"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+static NSString * const AFAWSV4ServiceName = @"s3";
+static NSUInteger const AFAWSV4StreamingChunkLength = 64 * 1024;
+
+static NSData * AFHMACSHA1EncodedDataFromStringWithContext(NSString *string, const CCHmacContext *keyedContext) {
+    // Copying the context keyed with the secret skips hashing the key for every signature
+    CCHmacContext context = *keyedContext;
 
-    CCHmacInit(&context, kCCHmacAlgSHA1, keyCString, strlen(keyCString));
-    CCHmacUpdate(&context, [data bytes], [data length]);
+    const char *cString = [string UTF8String];
+    CCHmacUpdate(&context, cString, strlen(cString));
 
     unsigned char digestRaw[CC_SHA1_DIGEST_LENGTH];
     NSUInteger digestLength = CC_SHA1_DIGEST_LENGTH;
@@ -54,82 +70,651 @@ static NSData * AFHMACSHA1EncodedDataFromStringWithKey(NSString *string, NSStrin
 }
 
 static NSString * AFRFC822FormatStringFromDate(NSDate *date) {
-    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-    [dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"GMT"]];
-    [dateFormatter setDateFormat:@"EEE, dd MMM yyyy HH:mm:ss z"];
-    [dateFormatter setLocale:[[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"]];
+    static char const * const kAFWeekdayNames[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static char const * const kAFMonthNames[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    // Formatted by hand rather than with `NSDateFormatter`, which is expensive to create and not thread-safe on all supported platforms
+    time_t time = (time_t)[date timeIntervalSince1970];
+    struct tm components;
+    gmtime_r(&time, &components);
+
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT", kAFWeekdayNames[components.tm_wday], components.tm_mday, kAFMonthNames[components.tm_mon], components.tm_year + 1900, components.tm_hour, components.tm_min, components.tm_sec);
 
-    return [dateFormatter stringFromDate:date];
+    return [[NSString alloc] initWithBytes:buffer length:(NSUInteger)length encoding:NSASCIIStringEncoding];
 }
 
-static NSString * AFBase64EncodedStringFromData(NSData *data) {
-    NSUInteger length = [data length];
-    NSMutableData *mutableData = [NSMutableData dataWithLength:((length + 2) / 3) * 4];
+static uint8_t const kAFBase64EncodingTable[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static uint8_t const kAFHexEncodingTable[16] = "0123456789abcdef";
 
-    uint8_t *input = (uint8_t *)[data bytes];
-    uint8_t *output = (uint8_t *)[mutableData mutableBytes];
+static size_t AFBase64EncodeBytes(const uint8_t *input, size_t length, uint8_t *output) {
+    const uint8_t *start = output;
 
-    for (NSUInteger i = 0; i < length; i += 3) {
-        NSUInteger value = 0;
-        for (NSUInteger j = i; j < (i + 3); j++) {
-            value <<= 8;
-            if (j < length) {
-                value |= (0xFF & input[j]);
-            }
+#if defined(AF_ENCODING_NEON)
+    // 48 input bytes are de-interleaved into three registers, and become four registers of 6-bit indices
+    const uint8x16x4_t table = {{vld1q_u8(kAFBase64EncodingTable), vld1q_u8(kAFBase64EncodingTable + 16), vld1q_u8(kAFBase64EncodingTable + 32), vld1q_u8(kAFBase64EncodingTable + 48)}};
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+    while (length >= 48) {
+        uint8x16x3_t in = vld3q_u8(input);
+        uint8x16x4_t out;
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[1], 4), vshlq_n_u8(in.val[0], 4)), mask);
+        out.val[2] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[2], 6), vshlq_n_u8(in.val[1], 2)), mask);
+        out.val[3] = vandq_u8(in.val[2], mask);
+        out.val[0] = vqtbl4q_u8(table, out.val[0]);
+        out.val[1] = vqtbl4q_u8(table, out.val[1]);
+        out.val[2] = vqtbl4q_u8(table, out.val[2]);
+        out.val[3] = vqtbl4q_u8(table, out.val[3]);
+        vst4q_u8(output, out);
+
+        input += 48;
+        length -= 48;
+        output += 64;
+    }
+#elif defined(AF_ENCODING_SSSE3)
+    // 12 input bytes are spread over 16 lanes, split into 6-bit indices with multiplies, and mapped to characters with a 16-entry offset table
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    while (length >= 16) {
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)input), shuffle);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(t0, t1);
+
+        __m128i ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        ranges = _mm_or_si128(ranges, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        _mm_storeu_si128((__m128i *)output, _mm_add_epi8(_mm_shuffle_epi8(offsets, ranges), indices));
+
+        input += 12;
+        length -= 12;
+        output += 16;
+    }
+#endif
+
+    while (length >= 3) {
+        uint32_t value = ((uint32_t)input[0] << 16) | ((uint32_t)input[1] << 8) | input[2];
+        output[0] = kAFBase64EncodingTable[(value >> 18) & 0x3F];
+        output[1] = kAFBase64EncodingTable[(value >> 12) & 0x3F];
+        output[2] = kAFBase64EncodingTable[(value >> 6) & 0x3F];
+        output[3] = kAFBase64EncodingTable[value & 0x3F];
+
+        input += 3;
+        length -= 3;
+        output += 4;
+    }
+
+    if (length > 0) {
+        uint32_t value = ((uint32_t)input[0] << 16) | (length > 1 ? ((uint32_t)input[1] << 8) : 0);
+        output[0] = kAFBase64EncodingTable[(value >> 18) & 0x3F];
+        output[1] = kAFBase64EncodingTable[(value >> 12) & 0x3F];
+        output[2] = length > 1 ? kAFBase64EncodingTable[(value >> 6) & 0x3F] : '=';
+        output[3] = '=';
+        output += 4;
+    }
+
+    return (size_t)(output - start);
+}
+
+static size_t AFHexEncodeBytes(const uint8_t *input, size_t length, uint8_t *output) {
+    const uint8_t *start = output;
+
+#if defined(AF_ENCODING_NEON)
+    const uint8x16_t table = vld1q_u8(kAFHexEncodingTable);
+    while (length >= 16) {
+        uint8x16_t in = vld1q_u8(input);
+        uint8x16x2_t out;
+        out.val[0] = vqtbl1q_u8(table, vshrq_n_u8(in, 4));
+        out.val[1] = vqtbl1q_u8(table, vandq_u8(in, vdupq_n_u8(0x0F)));
+        vst2q_u8(output, out);
+
+        input += 16;
+        length -= 16;
+        output += 32;
+    }
+#elif defined(AF_ENCODING_SSSE3)
+    const __m128i table = _mm_loadu_si128((const __m128i *)kAFHexEncodingTable);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    while (length >= 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)input);
+        __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+        __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(in, mask));
+        _mm_storeu_si128((__m128i *)output, _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i *)(output + 16), _mm_unpackhi_epi8(high, low));
+
+        input += 16;
+        length -= 16;
+        output += 32;
+    }
+#endif
+
+    while (length > 0) {
+        output[0] = kAFHexEncodingTable[*input >> 4];
+        output[1] = kAFHexEncodingTable[*input & 0x0F];
+
+        input++;
+        length--;
+        output += 2;
+    }
+
+    return (size_t)(output - start);
+}
+
+static NSString * AFASCIIStringFromEncodedBytes(const uint8_t *input, size_t length, size_t encodedLength, size_t (*encode)(const uint8_t *, size_t, uint8_t *)) {
+    // Digests, which make up nearly every call, are encoded on the stack; only larger payloads need a heap buffer
+    uint8_t buffer[128];
+    if (encodedLength <= sizeof(buffer)) {
+        return [[NSString alloc] initWithBytes:buffer length:encode(input, length, buffer) encoding:NSASCIIStringEncoding];
+    }
+
+    uint8_t *output = malloc(encodedLength);
+    if (!output) {
+        return nil;
+    }
+
+    return [[NSString alloc] initWithBytesNoCopy:output length:encode(input, length, output) encoding:NSASCIIStringEncoding freeWhenDone:YES];
+}
+
+NSString * AFAmazonS3Base64EncodedStringFromData(NSData *data) {
+    size_t length = [data length];
+
+    return AFASCIIStringFromEncodedBytes([data bytes], length, ((length + 2) / 3) * 4, AFBase64EncodeBytes);
+}
+
+NSString * AFAmazonS3HexEncodedStringFromData(NSData *data) {
+    size_t length = [data length];
+
+    return AFASCIIStringFromEncodedBytes([data bytes], length, length * 2, AFHexEncodeBytes);
+}
+
+static NSString * AFAWSCanonicalizedSubresourceStringFromURL(NSURL *URL) {
+    NSString *query = [URL query];
+    if ([query length] == 0) {
+        return @"";
+    }
+
+    static NSSet *_subresources = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _subresources = [NSSet setWithObjects:@"acl", @"cors", @"delete", @"lifecycle", @"location", @"logging", @"notification", @"partNumber", @"policy", @"requestPayment", @"response-cache-control", @"response-content-disposition", @"response-content-encoding", @"response-content-language", @"response-content-type", @"response-expires", @"restore", @"tagging", @"torrent", @"uploadId", @"uploads", @"versionId", @"versioning", @"versions", @"website", nil];
+    });
+
+    NSMutableArray *mutableSubresources = [NSMutableArray array];
+    for (NSString *pair in [query componentsSeparatedByString:@"&"]) {
+        NSRange range = [pair rangeOfString:@"="];
+        NSString *name = range.location == NSNotFound ? pair : [pair substringToIndex:range.location];
+        if (![_subresources containsObject:name]) {
+            continue;
         }
 
-        static uint8_t const kAFBase64EncodingTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        if (range.location == NSNotFound) {
+            [mutableSubresources addObject:name];
+        } else {
+            // Sub-resource values are signed without URL-encoding
+            NSString *value = [[pair substringFromIndex:NSMaxRange(range)] stringByReplacingPercentEscapesUsingEncoding:NSUTF8StringEncoding];
+            [mutableSubresources addObject:[NSString stringWithFormat:@"%@=%@", name, value]];
+        }
+    }
 
-        NSUInteger idx = (i / 3) * 4;
-        output[idx + 0] = kAFBase64EncodingTable[(value >> 18) & 0x3F];
-        output[idx + 1] = kAFBase64EncodingTable[(value >> 12) & 0x3F];
-        output[idx + 2] = (i + 1) < length ? kAFBase64EncodingTable[(value >> 6)  & 0x3F] : '=';
-        output[idx + 3] = (i + 2) < length ? kAFBase64EncodingTable[(value >> 0)  & 0x3F] : '=';
+    if ([mutableSubresources count] == 0) {
+        return @"";
     }
 
-    return [[NSString alloc] initWithData:mutableData encoding:NSASCIIStringEncoding];
+    return [@"?" stringByAppendingString:[[mutableSubresources sortedArrayUsingSelector:@selector(compare:)] componentsJoinedByString:@"&"]];
 }
 
-static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *bucket, NSString *timestamp, NSString *key) {
-    NSMutableDictionary *mutableAMZHeaderFields = [NSMutableDictionary dictionary];
-    [[request allHTTPHeaderFields] enumerateKeysAndObjectsUsingBlock:^(NSString *field, id value, __unused BOOL *stop) {
-        field = [field lowercaseString];
-        if ([field hasPrefix:@"x-amz"]) {
-            if ([mutableAMZHeaderFields objectForKey:field]) {
-                value = [[mutableAMZHeaderFields objectForKey:field] stringByAppendingFormat:@",%@", value];
-            }
-            [mutableAMZHeaderFields setObject:value forKey:field];
+static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *bucket, NSString *timestamp, const CCHmacContext *keyedContext) {
+    NSDictionary *headerFields = [request allHTTPHeaderFields];
+
+    NSMutableDictionary *mutableAMZHeaderFields = nil;
+    for (NSString *headerField in headerFields) {
+        if ([headerField length] < 6 || [headerField compare:@"x-amz-" options:NSCaseInsensitiveSearch range:NSMakeRange(0, 6)] != NSOrderedSame) {
+            continue;
         }
-    }];
 
-    NSMutableString *mutableCanonicalizedAMZHeaderString = [NSMutableString string];
-    for (NSString *field in [[mutableAMZHeaderFields allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
-        id value = [mutableAMZHeaderFields objectForKey:field];
-        [mutableCanonicalizedAMZHeaderString appendFormat:@"%@:%@\n", field, value];
+        if (!mutableAMZHeaderFields) {
+            mutableAMZHeaderFields = [NSMutableDictionary dictionary];
+        }
+
+        // Values such as x-amz-copy-source are signed without the whitespace around them
+        NSString *field = [headerField lowercaseString];
+        id value = [[headerFields[headerField] description] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        if ([mutableAMZHeaderFields objectForKey:field]) {
+            value = [[mutableAMZHeaderFields objectForKey:field] stringByAppendingFormat:@",%@", value];
+        }
+        [mutableAMZHeaderFields setObject:value forKey:field];
     }
 
-    NSString *canonicalizedResource = bucket ? [NSString stringWithFormat:@"/%@%@", bucket, request.URL.path] : request.URL.path;
     NSString *method = [request HTTPMethod];
     NSString *contentMD5 = [request valueForHTTPHeaderField:@"Content-MD5"];
     NSString *contentType = [request valueForHTTPHeaderField:@"Content-Type"];
 
-    NSMutableString *mutableString = [NSMutableString string];
-    [mutableString appendFormat:@"%@\n", method ? method : @""];
-    [mutableString appendFormat:@"%@\n", contentMD5 ? contentMD5 : @""];
-    [mutableString appendFormat:@"%@\n", contentType ? contentType : @""];
-    [mutableString appendFormat:@"%@\n", timestamp ? timestamp : @""];
-    [mutableString appendFormat:@"%@", mutableCanonicalizedAMZHeaderString];
-    [mutableString appendFormat:@"%@", canonicalizedResource];
+    NSMutableString *mutableString = [NSMutableString stringWithCapacity:256];
+    [mutableString appendString:method ? method : @""];
+    [mutableString appendString:@"\n"];
+    [mutableString appendString:contentMD5 ? contentMD5 : @""];
+    [mutableString appendString:@"\n"];
+    [mutableString appendString:contentType ? contentType : @""];
+    [mutableString appendString:@"\n"];
+    [mutableString appendString:timestamp ? timestamp : @""];
+    [mutableString appendString:@"\n"];
+
+    for (NSString *field in [[mutableAMZHeaderFields allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        [mutableString appendString:field];
+        [mutableString appendString:@":"];
+        [mutableString appendString:[[mutableAMZHeaderFields objectForKey:field] description]];
+        [mutableString appendString:@"\n"];
+    }
+
+    if (bucket) {
+        [mutableString appendString:@"/"];
+        [mutableString appendString:bucket];
+    }
+    [mutableString appendString:request.URL.path ?: @""];
+    [mutableString appendString:AFAWSCanonicalizedSubresourceStringFromURL(request.URL)];
+
+    return AFAmazonS3Base64EncodedStringFromData(AFHMACSHA1EncodedDataFromStringWithContext(mutableString, keyedContext));
+}
+
+static NSURL * AFURLByAppendingQueryString(NSURL *URL, NSString *query) {
+    return [NSURL URLWithString:[[URL absoluteString] stringByAppendingFormat:([URL query] ? @"&%@" : @"?%@"), query]];
+}
+
+static inline BOOL AFAmazonS3HTTPMethodCanBePreSigned(NSString *method) {
+    for (NSString *preSignableMethod in @[@"GET", @"HEAD", @"PUT", @"DELETE"]) {
+        if ([method compare:preSignableMethod options:NSCaseInsensitiveSearch] == NSOrderedSame) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+#pragma mark - Signature Version 4
+
+static NSString * AFHexEncodedStringFromBytes(const unsigned char *bytes, NSUInteger length) {
+    return AFASCIIStringFromEncodedBytes(bytes, length, length * 2, AFHexEncodeBytes);
+}
+
+static NSString * AFSHA256HexEncodedStringFromBytes(const void *bytes, NSUInteger length) {
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(bytes, (CC_LONG)length, digest);
+
+    return AFHexEncodedStringFromBytes(digest, CC_SHA256_DIGEST_LENGTH);
+}
+
+static NSString * AFSHA256HexEncodedStringFromString(NSString *string) {
+    const char *cString = [string UTF8String];
+
+    return AFSHA256HexEncodedStringFromBytes(cString, strlen(cString));
+}
+
+static NSString * AFHMACSHA256HexEncodedStringFromStringWithContext(NSString *string, const CCHmacContext *keyedContext) {
+    CCHmacContext context = *keyedContext;
 
-    return AFBase64EncodedStringFromData(AFHMACSHA1EncodedDataFromStringWithKey(mutableString, key));
+    const char *cString = [string UTF8String];
+    CCHmacUpdate(&context, cString, strlen(cString));
+
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CCHmacFinal(&context, digest);
+
+    return AFHexEncodedStringFromBytes(digest, CC_SHA256_DIGEST_LENGTH);
+}
+
+static void AFAWSV4TimestampsFromDate(NSDate *date, NSString * __autoreleasing *timestamp, NSString * __autoreleasing *dateStamp) {
+    time_t time = (time_t)[date timeIntervalSince1970];
+    struct tm components;
+    gmtime_r(&time, &components);
+
+    char buffer[20];
+    int length = snprintf(buffer, sizeof(buffer), "%04d%02d%02dT%02d%02d%02dZ", components.tm_year + 1900, components.tm_mon + 1, components.tm_mday, components.tm_hour, components.tm_min, components.tm_sec);
+
+    *timestamp = [[NSString alloc] initWithBytes:buffer length:(NSUInteger)length encoding:NSASCIIStringEncoding];
+    *dateStamp = [[NSString alloc] initWithBytes:buffer length:8 encoding:NSASCIIStringEncoding];
+}
+
+static NSString * AFAWSV4RegionNameFromRegion(NSString *region) {
+    NSString *host = region;
+    NSRange range = [host rangeOfString:@".amazonaws.com"];
+    if (range.location != NSNotFound) {
+        host = [host substringToIndex:range.location];
+    }
+
+    // `s3-eu-central-1.amazonaws.com` and `s3.eu-central-1.amazonaws.com` are both signed for `eu-central-1`
+    if (([host hasPrefix:@"s3-"] || [host hasPrefix:@"s3."]) && ![host hasPrefix:@"s3-external"]) {
+        return [host substringFromIndex:3];
+    }
+
+    return @"us-east-1";
+}
+
+static NSString * AFAWSV4URIEncodedString(NSString *string, BOOL encodeSlash) {
+    static char const kAFHexEncodingTable[] = "0123456789ABCDEF";
+
+    const unsigned char *input = (const unsigned char *)[string UTF8String];
+    NSUInteger length = strlen((const char *)input);
+
+    NSMutableData *mutableData = [NSMutableData dataWithLength:length * 3];
+    char *output = (char *)[mutableData mutableBytes];
+    NSUInteger outputLength = 0;
+
+    for (NSUInteger idx = 0; idx < length; idx++) {
+        unsigned char c = input[idx];
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~' || (c == '/' && !encodeSlash)) {
+            output[outputLength++] = (char)c;
+        } else {
+            output[outputLength++] = '%';
+            output[outputLength++] = kAFHexEncodingTable[c >> 4];
+            output[outputLength++] = kAFHexEncodingTable[c & 0x0F];
+        }
+    }
+
+    return [[NSString alloc] initWithBytes:output length:outputLength encoding:NSASCIIStringEncoding];
 }
 
+static NSString * AFAWSV4CanonicalURIFromURL(NSURL *URL) {
+    // Unlike `-[NSURL path]`, the path copied from the URL keeps any trailing slash
+    NSString *path = (__bridge_transfer NSString *)CFURLCopyPath((__bridge CFURLRef)URL);
+    path = [path stringByReplacingPercentEscapesUsingEncoding:NSUTF8StringEncoding] ?: path;
+
+    if ([path length] == 0) {
+        return @"/";
+    }
+
+    return AFAWSV4URIEncodedString(path, NO);
+}
+
+static NSString * AFAWSV4CanonicalQueryStringFromURL(NSURL *URL) {
+    NSString *query = [URL query];
+    if ([query length] == 0) {
+        return @"";
+    }
+
+    NSMutableArray *mutablePairs = [NSMutableArray array];
+    for (NSString *component in [query componentsSeparatedByString:@"&"]) {
+        if ([component length] == 0) {
+            continue;
+        }
+
+        NSRange range = [component rangeOfString:@"="];
+        NSString *name = range.location == NSNotFound ? component : [component substringToIndex:range.location];
+        NSString *value = range.location == NSNotFound ? @"" : [component substringFromIndex:NSMaxRange(range)];
+
+        name = AFAWSV4URIEncodedString([name stringByReplacingPercentEscapesUsingEncoding:NSUTF8StringEncoding] ?: name, YES);
+        value = AFAWSV4URIEncodedString([value stringByReplacingPercentEscapesUsingEncoding:NSUTF8StringEncoding] ?: value, YES);
+
+        [mutablePairs addObject:@[name, value]];
+    }
+
+    [mutablePairs sortUsingComparator:^NSComparisonResult(NSArray *pair, NSArray *otherPair) {
+        NSComparisonResult result = [pair[0] compare:otherPair[0] options:NSLiteralSearch];
+        if (result == NSOrderedSame) {
+            result = [pair[1] compare:otherPair[1] options:NSLiteralSearch];
+        }
+
+        return result;
+    }];
+
+    NSMutableString *mutableQueryString = [NSMutableString string];
+    for (NSArray *pair in mutablePairs) {
+        if ([mutableQueryString length] > 0) {
+            [mutableQueryString appendString:@"&"];
+        }
+
+        [mutableQueryString appendString:pair[0]];
+        [mutableQueryString appendString:@"="];
+        [mutableQueryString appendString:pair[1]];
+    }
+
+    return mutableQueryString;
+}
+
+static NSString * AFAWSV4CanonicalHeaderValueFromValue(NSString *value) {
+    NSArray *components = [[value stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    if ([components count] == 1) {
+        return components[0];
+    }
+
+    return [[components filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]] componentsJoinedByString:@" "];
+}
+
+static BOOL AFAWSV4ShouldSignHeaderField(NSString *field) {
+    return [field hasPrefix:@"x-amz-"] || [field isEqualToString:@"content-type"] || [field isEqualToString:@"content-md5"] || [field isEqualToString:@"content-encoding"];
+}
+
+static unsigned long long AFAWSV4EncodedChunkLength(unsigned long long dataLength) {
+    unsigned long long hexLength = 1;
+    for (unsigned long long value = dataLength >> 4; value > 0; value >>= 4) {
+        hexLength++;
+    }
+
+    // <hex length>;chunk-signature=<64 hex digits>\r\n<data>\r\n
+    return hexLength + 17 + 64 + 2 + dataLength + 2;
+}
+
+static unsigned long long AFAWSV4StreamingContentLength(unsigned long long decodedContentLength) {
+    unsigned long long numberOfFullChunks = decodedContentLength / AFAWSV4StreamingChunkLength;
+    unsigned long long remainingLength = decodedContentLength % AFAWSV4StreamingChunkLength;
+
+    unsigned long long contentLength = numberOfFullChunks * AFAWSV4EncodedChunkLength(AFAWSV4StreamingChunkLength);
+    if (remainingLength > 0) {
+        contentLength += AFAWSV4EncodedChunkLength(remainingLength);
+    }
+
+    return contentLength + AFAWSV4EncodedChunkLength(0);
+}
+
+#pragma mark -
+
+/**
+ Encodes a request body as a series of `aws-chunked` chunks as it is read, signing each chunk with the signature of the chunk before it, starting from the signature of the request.
+ */
+@interface AFAmazonS3ChunkedSigningInputStream : NSInputStream
+@property (readonly, nonatomic, strong) NSInputStream *inputStream;
+@property (readonly, nonatomic, assign) unsigned long long decodedContentLength;
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream
+               decodedContentLength:(unsigned long long)decodedContentLength
+                  signingKeyContext:(const CCHmacContext *)signingKeyContext
+                      seedSignature:(NSString *)seedSignature
+                          timestamp:(NSString *)timestamp
+                              scope:(NSString *)scope;
+@end
+
+@interface AFAmazonS3ChunkedSigningInputStream ()
+@property (readwrite, nonatomic, strong) NSInputStream *inputStream;
+@property (readwrite, nonatomic, assign) unsigned long long decodedContentLength;
+@property (readwrite, nonatomic, copy) NSString *previousSignature;
+@property (readwrite, nonatomic, copy) NSString *timestamp;
+@property (readwrite, nonatomic, copy) NSString *scope;
+@property (readwrite, nonatomic, strong) NSMutableData *chunkData;
+@property (readwrite, nonatomic, strong) NSMutableData *encodedChunkData;
+@property (readwrite, nonatomic, assign) NSUInteger encodedChunkOffset;
+@property (readwrite, nonatomic, assign, getter = isFinalChunkEncoded) BOOL finalChunkEncoded;
+@property (readwrite, nonatomic, assign) NSStreamStatus streamStatus;
+@property (readwrite, nonatomic, strong) NSError *streamError;
+@end
+
+@implementation AFAmazonS3ChunkedSigningInputStream {
+    CCHmacContext _signingKeyContext;
+}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wimplicit-atomic-properties"
+@synthesize delegate;
+#pragma clang diagnostic pop
+@synthesize streamStatus;
+@synthesize streamError;
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream
+               decodedContentLength:(unsigned long long)decodedContentLength
+                  signingKeyContext:(const CCHmacContext *)signingKeyContext
+                      seedSignature:(NSString *)seedSignature
+                          timestamp:(NSString *)timestamp
+                              scope:(NSString *)scope
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.inputStream = inputStream;
+    self.decodedContentLength = decodedContentLength;
+    _signingKeyContext = *signingKeyContext;
+    self.previousSignature = seedSignature;
+    self.timestamp = timestamp;
+    self.scope = scope;
+
+    self.chunkData = [NSMutableData dataWithLength:AFAWSV4StreamingChunkLength];
+    self.encodedChunkData = [NSMutableData dataWithCapacity:AFAWSV4StreamingChunkLength + 128];
+
+    return self;
+}
+
+- (BOOL)encodeNextChunk {
+    uint8_t *buffer = (uint8_t *)[self.chunkData mutableBytes];
+    NSUInteger length = 0;
+    while (length < AFAWSV4StreamingChunkLength) {
+        NSInteger numberOfBytesRead = [self.inputStream read:buffer + length maxLength:AFAWSV4StreamingChunkLength - length];
+        if (numberOfBytesRead < 0) {
+            self.streamError = self.inputStream.streamError;
+            self.streamStatus = NSStreamStatusError;
+            return NO;
+        } else if (numberOfBytesRead == 0) {
+            break;
+        }
+
+        length += (NSUInteger)numberOfBytesRead;
+    }
+
+    NSString *stringToSign = [NSString stringWithFormat:@"%@\n%@\n%@\n%@\n%@\n%@", AFAWSV4ChunkSigningAlgorithm, self.timestamp, self.scope, self.previousSignature, AFAWSV4EmptyPayloadHash, AFSHA256HexEncodedStringFromBytes(buffer, length)];
+    NSString *signature = AFHMACSHA256HexEncodedStringFromStringWithContext(stringToSign, &_signingKeyContext);
+    self.previousSignature = signature;
+
+    NSData *headerData = [[NSString stringWithFormat:@"%lx;chunk-signature=%@\r\n", (unsigned long)length, signature] dataUsingEncoding:NSASCIIStringEncoding];
+
+    [self.encodedChunkData setLength:0];
+    [self.encodedChunkData appendData:headerData];
+    [self.encodedChunkData appendBytes:buffer length:length];
+    [self.encodedChunkData appendBytes:"\r\n" length:2];
+    self.encodedChunkOffset = 0;
+
+    if (length == 0) {
+        self.finalChunkEncoded = YES;
+    }
+
+    return YES;
+}
+
+#pragma mark - NSInputStream
+
+- (NSInteger)read:(uint8_t *)buffer
+        maxLength:(NSUInteger)length
+{
+    if ([self streamStatus] == NSStreamStatusClosed) {
+        return 0;
+    }
+
+    NSUInteger totalNumberOfBytesRead = 0;
+    while (totalNumberOfBytesRead < length) {
+        if (self.encodedChunkOffset >= [self.encodedChunkData length]) {
+            if (self.finalChunkEncoded) {
+                break;
+            }
+
+            if (![self encodeNextChunk]) {
+                return -1;
+            }
+        }
+
+        NSUInteger numberOfBytesToCopy = MIN(length - totalNumberOfBytesRead, [self.encodedChunkData length] - self.encodedChunkOffset);
+        memcpy(buffer + totalNumberOfBytesRead, (const uint8_t *)[self.encodedChunkData bytes] + self.encodedChunkOffset, numberOfBytesToCopy);
+        self.encodedChunkOffset += numberOfBytesToCopy;
+        totalNumberOfBytesRead += numberOfBytesToCopy;
+    }
+
+    if (totalNumberOfBytesRead == 0 && self.finalChunkEncoded) {
+        self.streamStatus = NSStreamStatusAtEnd;
+    }
+
+    return (NSInteger)totalNumberOfBytesRead;
+}
+
+- (BOOL)getBuffer:(__unused uint8_t **)buffer
+           length:(__unused NSUInteger *)len
+{
+    return NO;
+}
+
+- (BOOL)hasBytesAvailable {
+    return [self streamStatus] == NSStreamStatusOpen;
+}
+
+#pragma mark - NSStream
+
+- (void)open {
+    if (self.streamStatus == NSStreamStatusOpen) {
+        return;
+    }
+
+    self.streamStatus = NSStreamStatusOpen;
+
+    [self.inputStream open];
+}
+
+- (void)close {
+    self.streamStatus = NSStreamStatusClosed;
+
+    [self.inputStream close];
+}
+
+- (id)propertyForKey:(__unused NSString *)key {
+    return nil;
+}
+
+- (BOOL)setProperty:(__unused id)property
+             forKey:(__unused NSString *)key
+{
+    return NO;
+}
+
+- (void)scheduleInRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+- (void)removeFromRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+#pragma mark - Undocumented CFReadStream Bridged Methods
+
+- (void)_scheduleInCFRunLoop:(__unused CFRunLoopRef)aRunLoop
+                     forMode:(__unused CFStringRef)aMode
+{}
+
+- (void)_unscheduleFromCFRunLoop:(__unused CFRunLoopRef)aRunLoop
+                         forMode:(__unused CFStringRef)aMode
+{}
+
+- (BOOL)_setCFClientFlags:(__unused CFOptionFlags)inFlags
+                 callback:(__unused CFReadStreamClientCallBack)inCallback
+                  context:(__unused CFStreamClientContext *)inContext {
+    return NO;
+}
+
+@end
+
+#pragma mark -
+
 @interface AFAmazonS3RequestSerializer ()
 @property (readwrite, nonatomic, copy) NSString *accessKey;
 @property (readwrite, nonatomic, copy) NSString *secret;
+@property (readwrite, nonatomic, copy) NSURL *cachedEndpointURL;
+@property (readwrite, nonatomic, copy) NSString *signingKeyScope;
+@property (readwrite, nonatomic, copy) NSData *signingKeyContextData;
 @end
 
-@implementation AFAmazonS3RequestSerializer
+@implementation AFAmazonS3RequestSerializer {
+    CCHmacContext _secretHMACContext;
+}
 
 - (instancetype)init {
     self = [super init];
@@ -142,6 +727,9 @@ static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *buck
     self.region = AFAmazonS3USStandardRegion;
     self.useSSL = YES;
 
+    self.signatureVersion = AFAmazonS3SignatureVersion2;
+    self.payloadSigningMode = AFAmazonS3SignedPayload;
+
     return self;
 }
 
@@ -155,36 +743,232 @@ static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *buck
     self.secret = secret;
 }
 
+- (void)setSecret:(NSString *)secret {
+    // Requests may be signed on other threads while the secret changes, so the keyed context is only written and copied under the lock
+    @synchronized(self) {
+        _secret = [secret copy];
+
+        if (_secret) {
+            const char *secretCString = [_secret UTF8String];
+            CCHmacInit(&_secretHMACContext, kCCHmacAlgSHA1, secretCString, strlen(secretCString));
+        }
+
+        self.signingKeyScope = nil;
+        self.signingKeyContextData = nil;
+    }
+}
+
+- (void)setBucket:(NSString *)bucket {
+    @synchronized(self) {
+        _bucket = [bucket copy];
+        self.cachedEndpointURL = nil;
+    }
+}
+
 - (void)setRegion:(NSString *)region {
     NSParameterAssert(region);
-    _region = region;
+
+    @synchronized(self) {
+        _region = [region copy];
+        self.cachedEndpointURL = nil;
+    }
 }
 
-- (NSURL *)endpointURL {
-    NSString *URLString = nil;
-    NSString *scheme = self.useSSL ? @"https" : @"http";
-    if (self.bucket) {
-        URLString = [NSString stringWithFormat:@"%@://%@.%@", scheme, self.bucket, self.region];
-    } else {
-        URLString = [NSString stringWithFormat:@"%@://%@", scheme, self.region];
+- (void)setUseSSL:(BOOL)useSSL {
+    @synchronized(self) {
+        _useSSL = useSSL;
+        self.cachedEndpointURL = nil;
     }
+}
+
+- (NSURL *)endpointURL {
+    // The endpoint is read on every thread that signs or enqueues requests, so it is cached and invalidated under the same lock as the signing state
+    @synchronized(self) {
+        if (!self.cachedEndpointURL) {
+            NSString *URLString = nil;
+            NSString *scheme = _useSSL ? @"https" : @"http";
+            if (_bucket) {
+                URLString = [NSString stringWithFormat:@"%@://%@.%@", scheme, _bucket, _region];
+            } else {
+                URLString = [NSString stringWithFormat:@"%@://%@", scheme, _region];
+            }
+
+            self.cachedEndpointURL = [NSURL URLWithString:URLString];
+        }
 
-    return [NSURL URLWithString:URLString];
+        return self.cachedEndpointURL;
+    }
 }
 
 #pragma mark -
 
+- (void)getSecretHMACContext:(CCHmacContext *)context {
+    @synchronized(self) {
+        *context = _secretHMACContext;
+    }
+}
+
+- (void)getSigningKeyContext:(CCHmacContext *)context
+                    forScope:(NSString *)scope
+                   dateStamp:(NSString *)dateStamp
+                  regionName:(NSString *)regionName
+{
+    @synchronized(self) {
+        // The signing key only changes once a day, so the four HMACs deriving it are done once per scope rather than once per request
+        if (![self.signingKeyScope isEqualToString:scope] || !self.signingKeyContextData) {
+            const char *secretKey = [[@"AWS4" stringByAppendingString:self.secret] UTF8String];
+            const char *region = [regionName UTF8String];
+            const char *service = [AFAWSV4ServiceName UTF8String];
+
+            unsigned char dateKey[CC_SHA256_DIGEST_LENGTH];
+            unsigned char regionKey[CC_SHA256_DIGEST_LENGTH];
+            unsigned char serviceKey[CC_SHA256_DIGEST_LENGTH];
+            unsigned char signingKey[CC_SHA256_DIGEST_LENGTH];
+
+            CCHmac(kCCHmacAlgSHA256, secretKey, strlen(secretKey), [dateStamp UTF8String], [dateStamp length], dateKey);
+            CCHmac(kCCHmacAlgSHA256, dateKey, sizeof(dateKey), region, strlen(region), regionKey);
+            CCHmac(kCCHmacAlgSHA256, regionKey, sizeof(regionKey), service, strlen(service), serviceKey);
+            CCHmac(kCCHmacAlgSHA256, serviceKey, sizeof(serviceKey), "aws4_request", strlen("aws4_request"), signingKey);
+
+            CCHmacContext signingKeyContext;
+            CCHmacInit(&signingKeyContext, kCCHmacAlgSHA256, signingKey, sizeof(signingKey));
+
+            self.signingKeyScope = scope;
+            self.signingKeyContextData = [NSData dataWithBytes:&signingKeyContext length:sizeof(signingKeyContext)];
+        }
+
+        [self.signingKeyContextData getBytes:context length:sizeof(CCHmacContext)];
+    }
+}
+
+- (NSURLRequest *)requestBySettingAWSV4AuthorizationHeadersForRequest:(NSURLRequest *)request
+                                                                 date:(NSDate *)date
+{
+    NSMutableURLRequest *mutableRequest = [request mutableCopy];
+
+    NSString *timestamp = nil;
+    NSString *dateStamp = nil;
+    AFAWSV4TimestampsFromDate(date, &timestamp, &dateStamp);
+
+    NSString *regionName = AFAWSV4RegionNameFromRegion(self.region);
+    NSString *scope = [NSString stringWithFormat:@"%@/%@/%@/aws4_request", dateStamp, regionName, AFAWSV4ServiceName];
+
+    CCHmacContext signingKeyContext;
+    [self getSigningKeyContext:&signingKeyContext forScope:scope dateStamp:dateStamp regionName:regionName];
+
+    // A body that was already encoded by an earlier signature is unwrapped, so that it is only ever chunked once
+    NSInputStream *bodyStream = mutableRequest.HTTPBodyStream;
+    NSData *body = mutableRequest.HTTPBody;
+    long long decodedContentLength = [body length];
+    if ([bodyStream isKindOfClass:[AFAmazonS3ChunkedSigningInputStream class]]) {
+        decodedContentLength = (long long)[(AFAmazonS3ChunkedSigningInputStream *)bodyStream decodedContentLength];
+        bodyStream = [(AFAmazonS3ChunkedSigningInputStream *)bodyStream inputStream];
+    } else if (bodyStream) {
+        NSString *contentLength = [mutableRequest valueForHTTPHeaderField:@"Content-Length"];
+        decodedContentLength = contentLength ? [contentLength longLongValue] : -1;
+    }
+
+    BOOL hasBody = bodyStream || [body length] > 0;
+    BOOL shouldStreamPayload = self.payloadSigningMode == AFAmazonS3StreamingSignedPayload && hasBody && decodedContentLength >= 0 && [[mutableRequest HTTPMethod] compare:@"PUT" options:NSCaseInsensitiveSearch] == NSOrderedSame;
+
+    NSString *payloadHash = nil;
+    if (shouldStreamPayload) {
+        payloadHash = AFAWSV4StreamingPayload;
+
+        // A request that is signed again already lists `aws-chunked`, which is removed on its own so that the encodings applied before it are kept
+        NSMutableArray *mutableContentCodings = [NSMutableArray arrayWithObject:@"aws-chunked"];
+        for (NSString *component in [[request valueForHTTPHeaderField:@"Content-Encoding"] componentsSeparatedByString:@","]) {
+            NSString *contentCoding = [component stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+            if ([contentCoding length] > 0 && [contentCoding caseInsensitiveCompare:@"aws-chunked"] != NSOrderedSame) {
+                [mutableContentCodings addObject:contentCoding];
+            }
+        }
+
+        [mutableRequest setValue:[mutableContentCodings componentsJoinedByString:@","] forHTTPHeaderField:@"Content-Encoding"];
+        [mutableRequest setValue:[NSString stringWithFormat:@"%lld", decodedContentLength] forHTTPHeaderField:@"x-amz-decoded-content-length"];
+        [mutableRequest setValue:[NSString stringWithFormat:@"%llu", AFAWSV4StreamingContentLength((unsigned long long)decodedContentLength)] forHTTPHeaderField:@"Content-Length"];
+    } else if (self.payloadSigningMode != AFAmazonS3SignedPayload || bodyStream) {
+        payloadHash = AFAWSV4UnsignedPayload;
+    } else if ([body length] > 0) {
+        payloadHash = AFSHA256HexEncodedStringFromBytes([body bytes], [body length]);
+    } else {
+        payloadHash = AFAWSV4EmptyPayloadHash;
+    }
+
+    [mutableRequest setValue:timestamp forHTTPHeaderField:@"x-amz-date"];
+    [mutableRequest setValue:payloadHash forHTTPHeaderField:@"x-amz-content-sha256"];
+    [mutableRequest setValue:nil forHTTPHeaderField:@"Date"];
+
+    NSString *host = [mutableRequest.URL host];
+    if ([mutableRequest.URL port]) {
+        host = [host stringByAppendingFormat:@":%@", [mutableRequest.URL port]];
+    }
+
+    NSMutableDictionary *mutableCanonicalHeaderFields = [NSMutableDictionary dictionaryWithObject:host forKey:@"host"];
+    NSDictionary *headerFields = [mutableRequest allHTTPHeaderFields];
+    for (NSString *headerField in headerFields) {
+        NSString *field = [headerField lowercaseString];
+        if (AFAWSV4ShouldSignHeaderField(field)) {
+            mutableCanonicalHeaderFields[field] = AFAWSV4CanonicalHeaderValueFromValue([headerFields[headerField] description]);
+        }
+    }
+
+    NSArray *signedHeaderFields = [[mutableCanonicalHeaderFields allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    NSString *signedHeaders = [signedHeaderFields componentsJoinedByString:@";"];
+
+    NSMutableString *mutableCanonicalRequest = [NSMutableString stringWithCapacity:512];
+    [mutableCanonicalRequest appendString:[mutableRequest HTTPMethod]];
+    [mutableCanonicalRequest appendString:@"\n"];
+    [mutableCanonicalRequest appendString:AFAWSV4CanonicalURIFromURL(mutableRequest.URL)];
+    [mutableCanonicalRequest appendString:@"\n"];
+    [mutableCanonicalRequest appendString:AFAWSV4CanonicalQueryStringFromURL(mutableRequest.URL)];
+    [mutableCanonicalRequest appendString:@"\n"];
+    for (NSString *field in signedHeaderFields) {
+        [mutableCanonicalRequest appendString:field];
+        [mutableCanonicalRequest appendString:@":"];
+        [mutableCanonicalRequest appendString:mutableCanonicalHeaderFields[field]];
+        [mutableCanonicalRequest appendString:@"\n"];
+    }
+    [mutableCanonicalRequest appendString:@"\n"];
+    [mutableCanonicalRequest appendString:signedHeaders];
+    [mutableCanonicalRequest appendString:@"\n"];
+    [mutableCanonicalRequest appendString:payloadHash];
+
+    NSString *stringToSign = [NSString stringWithFormat:@"%@\n%@\n%@\n%@", AFAWSV4SigningAlgorithm, timestamp, scope, AFSHA256HexEncodedStringFromString(mutableCanonicalRequest)];
+    NSString *signature = AFHMACSHA256HexEncodedStringFromStringWithContext(stringToSign, &signingKeyContext);
+
+    [mutableRequest setValue:[NSString stringWithFormat:@"%@ Credential=%@/%@, SignedHeaders=%@, Signature=%@", AFAWSV4SigningAlgorithm, self.accessKey, scope, signedHeaders, signature] forHTTPHeaderField:@"Authorization"];
+
+    if (shouldStreamPayload) {
+        if (!bodyStream) {
+            bodyStream = [NSInputStream inputStreamWithData:body];
+        }
+
+        mutableRequest.HTTPBodyStream = [[AFAmazonS3ChunkedSigningInputStream alloc] initWithInputStream:bodyStream decodedContentLength:(unsigned long long)decodedContentLength signingKeyContext:&signingKeyContext seedSignature:signature timestamp:timestamp scope:scope];
+    }
+
+    return mutableRequest;
+}
+
 - (NSURLRequest *)requestBySettingAuthorizationHeadersForRequest:(NSURLRequest *)request
                                                            error:(NSError * __autoreleasing *)error
 {
+    if (self.signatureVersion == AFAmazonS3SignatureVersion4 && self.accessKey && self.secret) {
+        return [self requestBySettingAWSV4AuthorizationHeadersForRequest:request date:[NSDate date]];
+    }
+
     NSMutableURLRequest *mutableRequest = [request mutableCopy];
 
     if (self.accessKey && self.secret) {
-        NSDate *date = [NSDate date];
-        NSString *signature = AFAWSSignatureForRequest(request, self.bucket, AFRFC822FormatStringFromDate(date), self.secret);
+        NSString *timestamp = AFRFC822FormatStringFromDate([NSDate date]);
+
+        CCHmacContext secretHMACContext;
+        [self getSecretHMACContext:&secretHMACContext];
+
+        NSString *signature = AFAWSSignatureForRequest(request, self.bucket, timestamp, &secretHMACContext);
 
         [mutableRequest setValue:[NSString stringWithFormat:@"AWS %@:%@", self.accessKey, signature] forHTTPHeaderField:@"Authorization"];
-        [mutableRequest setValue:date ? AFRFC822FormatStringFromDate(date) : @"" forHTTPHeaderField:@"Date"];
+        [mutableRequest setValue:timestamp forHTTPHeaderField:@"Date"];
     } else {
         if (error) {
             NSDictionary *userInfo = @{
@@ -201,25 +985,85 @@ static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *buck
 - (NSURLRequest *)preSignedRequestWithRequest:(NSURLRequest *)request
                                    expiration:(NSDate *)expiration
                                         error:(NSError * __autoreleasing *)error
+{
+    return [self preSignedRequestWithRequest:request expiration:expiration date:[NSDate date] error:error];
+}
+
+- (NSURLRequest *)preSignedRequestWithRequest:(NSURLRequest *)request
+                                   expiration:(NSDate *)expiration
+                                         date:(NSDate *)date
+                                        error:(NSError * __autoreleasing *)error
 {
     NSParameterAssert(request);
-    NSParameterAssert([request.HTTPMethod compare:@"GET" options:NSCaseInsensitiveSearch] == NSOrderedSame);
+    NSParameterAssert(AFAmazonS3HTTPMethodCanBePreSigned(request.HTTPMethod));
 
     if (!expiration) {
-        expiration = [[NSDate date] dateByAddingTimeInterval:AFAmazonS3DefaultExpirationTimeInterval];
+        expiration = [date dateByAddingTimeInterval:AFAmazonS3DefaultExpirationTimeInterval];
     }
 
     if (self.accessKey && self.secret) {
-        NSString *expires = @((NSUInteger)[expiration timeIntervalSince1970]).stringValue;
-        NSString *signature = AFAWSSignatureForRequest(request, self.bucket, expires, self.secret);
+        NSMutableURLRequest *mutableRequest = [request mutableCopy];
+
+        // Credentials in the query string replace those of a request that was already signed
+        for (NSString *headerField in @[@"Authorization", @"Date", @"x-amz-date", @"x-amz-content-sha256"]) {
+            [mutableRequest setValue:nil forHTTPHeaderField:headerField];
+        }
+
+        // The query string is appended directly, since a serializer only encodes parameters in the URL of GET, HEAD and DELETE requests
+        if (self.signatureVersion == AFAmazonS3SignatureVersion4) {
+            NSString *timestamp = nil;
+            NSString *dateStamp = nil;
+            AFAWSV4TimestampsFromDate(date, &timestamp, &dateStamp);
+
+            NSString *regionName = AFAWSV4RegionNameFromRegion(self.region);
+            NSString *scope = [NSString stringWithFormat:@"%@/%@/%@/aws4_request", dateStamp, regionName, AFAWSV4ServiceName];
+            long long expires = MIN(MAX((long long)ceil([expiration timeIntervalSinceDate:date]), 1LL), 7LL * 24 * 60 * 60);
+
+            NSMutableString *mutableQueryString = [NSMutableString stringWithCapacity:256];
+            [mutableQueryString appendFormat:@"X-Amz-Algorithm=%@", AFAWSV4SigningAlgorithm];
+            [mutableQueryString appendFormat:@"&X-Amz-Credential=%@", AFAWSV4URIEncodedString([NSString stringWithFormat:@"%@/%@", self.accessKey, scope], YES)];
+            [mutableQueryString appendFormat:@"&X-Amz-Date=%@", timestamp];
+            [mutableQueryString appendFormat:@"&X-Amz-Expires=%lld", expires];
+            if (self.sessionToken) {
+                [mutableQueryString appendFormat:@"&X-Amz-Security-Token=%@", AFAWSV4URIEncodedString(self.sessionToken, YES)];
+            }
+            [mutableQueryString appendString:@"&X-Amz-SignedHeaders=host"];
+
+            NSURL *URL = AFURLByAppendingQueryString(mutableRequest.URL, mutableQueryString);
+
+            NSString *host = [URL host];
+            if ([URL port]) {
+                host = [host stringByAppendingFormat:@":%@", [URL port]];
+            }
+
+            NSString *canonicalRequest = [NSString stringWithFormat:@"%@\n%@\n%@\nhost:%@\n\nhost\n%@", [[mutableRequest HTTPMethod] uppercaseString], AFAWSV4CanonicalURIFromURL(URL), AFAWSV4CanonicalQueryStringFromURL(URL), host, AFAWSV4UnsignedPayload];
+            NSString *stringToSign = [NSString stringWithFormat:@"%@\n%@\n%@\n%@", AFAWSV4SigningAlgorithm, timestamp, scope, AFSHA256HexEncodedStringFromString(canonicalRequest)];
+
+            CCHmacContext signingKeyContext;
+            [self getSigningKeyContext:&signingKeyContext forScope:scope dateStamp:dateStamp regionName:regionName];
+
+            mutableRequest.URL = AFURLByAppendingQueryString(URL, [@"X-Amz-Signature=" stringByAppendingString:AFHMACSHA256HexEncodedStringFromStringWithContext(stringToSign, &signingKeyContext)]);
+        } else {
+            if (self.sessionToken) {
+                [mutableRequest setValue:self.sessionToken forHTTPHeaderField:@"x-amz-security-token"];
+            }
+
+            NSString *expires = @((NSUInteger)[expiration timeIntervalSince1970]).stringValue;
+
+            CCHmacContext secretHMACContext;
+            [self getSecretHMACContext:&secretHMACContext];
+
+            NSString *signature = AFAWSSignatureForRequest(mutableRequest, self.bucket, expires, &secretHMACContext);
+
+            NSMutableString *mutableQueryString = [NSMutableString stringWithFormat:@"AWSAccessKeyId=%@&Expires=%@&Signature=%@", AFAWSV4URIEncodedString(self.accessKey, YES), expires, AFAWSV4URIEncodedString(signature, YES)];
+            if (self.sessionToken) {
+                [mutableQueryString appendFormat:@"&x-amz-security-token=%@", AFAWSV4URIEncodedString(self.sessionToken, YES)];
+            }
 
-        NSDictionary *parameters = @{
-                                     @"AWSAccessKeyId": self.accessKey,
-                                     @"Expires": expires,
-                                     @"Signature": signature
-                                    };
+            mutableRequest.URL = AFURLByAppendingQueryString(mutableRequest.URL, mutableQueryString);
+        }
 
-        return [self requestBySerializingRequest:request withParameters:parameters error:error];
+        return mutableRequest;
     } else {
         if (error) {
             NSDictionary *userInfo = @{
@@ -233,6 +1077,158 @@ static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *buck
     }
 }
 
+- (NSArray *)preSignedURLStringsWithBaseURL:(NSURL *)baseURL
+                                      paths:(NSArray *)paths
+                                     method:(NSString *)method
+                                 expiration:(NSDate *)expiration
+                                      error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(baseURL);
+    NSParameterAssert(paths);
+    NSParameterAssert(AFAmazonS3HTTPMethodCanBePreSigned(method));
+
+    if (!self.accessKey || !self.secret) {
+        if (error) {
+            NSDictionary *userInfo = @{
+                                       NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"Access Key required", @"AFAmazonS3Manager", nil)
+                                       };
+
+            *error = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorUserAuthenticationRequired userInfo:userInfo];
+        }
+
+        return nil;
+    }
+
+    if (!expiration) {
+        expiration = [[NSDate date] dateByAddingTimeInterval:AFAmazonS3DefaultExpirationTimeInterval];
+    }
+
+    method = [method uppercaseString];
+
+    NSString *host = [baseURL host] ?: @"";
+    if ([baseURL port]) {
+        host = [host stringByAppendingFormat:@":%@", [baseURL port]];
+    }
+
+    // Keys are appended to the path of the base URL, which is shared by every URL and every string to sign
+    NSString *basePath = (__bridge_transfer NSString *)CFURLCopyPath((__bridge CFURLRef)baseURL);
+    basePath = [basePath stringByReplacingPercentEscapesUsingEncoding:NSUTF8StringEncoding] ?: basePath;
+    if ([basePath hasSuffix:@"/"]) {
+        basePath = [basePath substringToIndex:[basePath length] - 1];
+    }
+
+    NSString *encodedBasePath = AFAWSV4URIEncodedString(basePath ?: @"", NO);
+    NSString *baseURLString = [NSString stringWithFormat:@"%@://%@%@/", [baseURL scheme], host, encodedBasePath];
+
+    NSMutableArray *mutableURLStrings = [NSMutableArray arrayWithCapacity:[paths count]];
+
+    if (self.signatureVersion == AFAmazonS3SignatureVersion4) {
+        NSString *timestamp = nil;
+        NSString *dateStamp = nil;
+        AFAWSV4TimestampsFromDate([NSDate date], &timestamp, &dateStamp);
+
+        NSString *regionName = AFAWSV4RegionNameFromRegion(self.region);
+        NSString *scope = [NSString stringWithFormat:@"%@/%@/%@/aws4_request", dateStamp, regionName, AFAWSV4ServiceName];
+        long long expires = MIN(MAX((long long)ceil([expiration timeIntervalSinceNow]), 1LL), 7LL * 24 * 60 * 60);
+
+        // Parameter names are already in canonical order
+        NSMutableString *mutableQueryString = [NSMutableString stringWithCapacity:256];
+        [mutableQueryString appendFormat:@"X-Amz-Algorithm=%@", AFAWSV4SigningAlgorithm];
+        [mutableQueryString appendFormat:@"&X-Amz-Credential=%@", AFAWSV4URIEncodedString([NSString stringWithFormat:@"%@/%@", self.accessKey, scope], YES)];
+        [mutableQueryString appendFormat:@"&X-Amz-Date=%@", timestamp];
+        [mutableQueryString appendFormat:@"&X-Amz-Expires=%lld", expires];
+        if (self.sessionToken) {
+            [mutableQueryString appendFormat:@"&X-Amz-Security-Token=%@", AFAWSV4URIEncodedString(self.sessionToken, YES)];
+        }
+        [mutableQueryString appendString:@"&X-Amz-SignedHeaders=host"];
+
+        const char *canonicalRequestPrefix = [[NSString stringWithFormat:@"%@\n%@/", method, encodedBasePath] UTF8String];
+        const char *canonicalRequestSuffix = [[NSString stringWithFormat:@"\n%@\nhost:%@\n\nhost\n%@", mutableQueryString, host, AFAWSV4UnsignedPayload] UTF8String];
+        size_t canonicalRequestSuffixLength = strlen(canonicalRequestSuffix);
+        const char *stringToSignPrefix = [[NSString stringWithFormat:@"%@\n%@\n%@\n", AFAWSV4SigningAlgorithm, timestamp, scope] UTF8String];
+
+        // Everything up to the key is hashed once, and the resulting states copied for each URL
+        CC_SHA256_CTX canonicalRequestPrefixContext;
+        CC_SHA256_Init(&canonicalRequestPrefixContext);
+        CC_SHA256_Update(&canonicalRequestPrefixContext, canonicalRequestPrefix, (CC_LONG)strlen(canonicalRequestPrefix));
+
+        CCHmacContext stringToSignPrefixContext;
+        [self getSigningKeyContext:&stringToSignPrefixContext forScope:scope dateStamp:dateStamp regionName:regionName];
+        CCHmacUpdate(&stringToSignPrefixContext, stringToSignPrefix, strlen(stringToSignPrefix));
+
+        NSString *querySuffix = [NSString stringWithFormat:@"?%@&X-Amz-Signature=", mutableQueryString];
+
+        for (NSString *path in paths) {
+            NSString *encodedKey = AFAWSV4URIEncodedString([path hasPrefix:@"/"] ? [path substringFromIndex:1] : path, NO);
+            const char *encodedKeyCString = [encodedKey UTF8String];
+
+            CC_SHA256_CTX canonicalRequestContext = canonicalRequestPrefixContext;
+            CC_SHA256_Update(&canonicalRequestContext, encodedKeyCString, (CC_LONG)strlen(encodedKeyCString));
+            CC_SHA256_Update(&canonicalRequestContext, canonicalRequestSuffix, (CC_LONG)canonicalRequestSuffixLength);
+
+            unsigned char canonicalRequestDigest[CC_SHA256_DIGEST_LENGTH];
+            CC_SHA256_Final(canonicalRequestDigest, &canonicalRequestContext);
+
+            uint8_t canonicalRequestHash[CC_SHA256_DIGEST_LENGTH * 2];
+            AFHexEncodeBytes(canonicalRequestDigest, CC_SHA256_DIGEST_LENGTH, canonicalRequestHash);
+
+            CCHmacContext stringToSignContext = stringToSignPrefixContext;
+            CCHmacUpdate(&stringToSignContext, canonicalRequestHash, sizeof(canonicalRequestHash));
+
+            unsigned char signature[CC_SHA256_DIGEST_LENGTH];
+            CCHmacFinal(&stringToSignContext, signature);
+
+            NSMutableString *mutableURLString = [NSMutableString stringWithString:baseURLString];
+            [mutableURLString appendString:encodedKey];
+            [mutableURLString appendString:querySuffix];
+            [mutableURLString appendString:AFHexEncodedStringFromBytes(signature, CC_SHA256_DIGEST_LENGTH)];
+            [mutableURLStrings addObject:mutableURLString];
+        }
+    } else {
+        NSString *expires = @((NSUInteger)[expiration timeIntervalSince1970]).stringValue;
+
+        NSMutableString *mutableStringToSignPrefix = [NSMutableString stringWithFormat:@"%@\n\n\n%@\n", method, expires];
+        if (self.sessionToken) {
+            [mutableStringToSignPrefix appendFormat:@"x-amz-security-token:%@\n", self.sessionToken];
+        }
+        if (self.bucket) {
+            [mutableStringToSignPrefix appendFormat:@"/%@", self.bucket];
+        }
+        [mutableStringToSignPrefix appendFormat:@"%@/", basePath];
+
+        // Everything up to the key is hashed once, and the resulting state copied for each URL
+        const char *stringToSignPrefix = [mutableStringToSignPrefix UTF8String];
+        CCHmacContext stringToSignPrefixContext;
+        [self getSecretHMACContext:&stringToSignPrefixContext];
+        CCHmacUpdate(&stringToSignPrefixContext, stringToSignPrefix, strlen(stringToSignPrefix));
+
+        NSString *querySuffix = [NSString stringWithFormat:@"?AWSAccessKeyId=%@&Expires=%@&Signature=", AFAWSV4URIEncodedString(self.accessKey, YES), expires];
+        NSString *sessionTokenQuery = self.sessionToken ? [@"&x-amz-security-token=" stringByAppendingString:AFAWSV4URIEncodedString(self.sessionToken, YES)] : nil;
+
+        for (NSString *path in paths) {
+            NSString *key = [path hasPrefix:@"/"] ? [path substringFromIndex:1] : path;
+            const char *keyCString = [key UTF8String];
+
+            CCHmacContext stringToSignContext = stringToSignPrefixContext;
+            CCHmacUpdate(&stringToSignContext, keyCString, strlen(keyCString));
+
+            unsigned char signature[CC_SHA1_DIGEST_LENGTH];
+            CCHmacFinal(&stringToSignContext, signature);
+
+            NSMutableString *mutableURLString = [NSMutableString stringWithString:baseURLString];
+            [mutableURLString appendString:AFAWSV4URIEncodedString(key, NO)];
+            [mutableURLString appendString:querySuffix];
+            [mutableURLString appendString:AFAWSV4URIEncodedString(AFASCIIStringFromEncodedBytes(signature, CC_SHA1_DIGEST_LENGTH, ((CC_SHA1_DIGEST_LENGTH + 2) / 3) * 4, AFBase64EncodeBytes), YES)];
+            if (sessionTokenQuery) {
+                [mutableURLString appendString:sessionTokenQuery];
+            }
+            [mutableURLStrings addObject:mutableURLString];
+        }
+    }
+
+    return mutableURLStrings;
+}
+
 #pragma mark - AFHTTPRequestSerializer
 
 - (NSMutableURLRequest *)requestWithMethod:(NSString *)method
@@ -249,6 +1245,39 @@ static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *buck
     return [[self requestBySettingAuthorizationHeadersForRequest:request error:error] mutableCopy];
 }
 
+- (NSMutableURLRequest *)requestWithMethod:(NSString *)method
+                                 URLString:(NSString *)URLString
+                              headerFields:(NSDictionary *)headerFields
+                                      body:(NSData *)body
+                                bodyStream:(NSInputStream *)bodyStream
+                                     error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(method);
+    NSParameterAssert(URLString);
+    NSParameterAssert(!(body && bodyStream));
+
+    NSMutableURLRequest *request = [super requestWithMethod:method URLString:URLString parameters:nil error:error];
+    if (!request) {
+        return nil;
+    }
+
+    if (self.sessionToken) {
+        [request setValue:self.sessionToken forHTTPHeaderField:@"x-amz-security-token"];
+    }
+
+    for (NSString *field in headerFields) {
+        [request setValue:[headerFields[field] description] forHTTPHeaderField:field];
+    }
+
+    if (body) {
+        request.HTTPBody = body;
+    } else if (bodyStream) {
+        request.HTTPBodyStream = bodyStream;
+    }
+
+    return [[self requestBySettingAuthorizationHeadersForRequest:request error:error] mutableCopy];
+}
+
 - (NSMutableURLRequest *)multipartFormRequestWithMethod:(NSString *)method
                                               URLString:(NSString *)URLString
                                              parameters:(NSDictionary *)parameters
@@ -264,4 +1293,72 @@ static NSString * AFAWSSignatureForRequest(NSURLRequest *request, NSString *buck
     return [[self requestBySettingAuthorizationHeadersForRequest:request error:error] mutableCopy];
 }
 
+#pragma mark - NSSecureCoding
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (id)initWithCoder:(NSCoder *)decoder {
+    self = [super initWithCoder:decoder];
+    if (!self) {
+        return nil;
+    }
+
+    self.bucket = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(bucket))];
+    self.region = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(region))] ?: AFAmazonS3USStandardRegion;
+    self.sessionToken = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(sessionToken))];
+
+    // Archives written before these values were encoded keep the defaults set by -init
+    if ([decoder containsValueForKey:NSStringFromSelector(@selector(useSSL))]) {
+        self.useSSL = [decoder decodeBoolForKey:NSStringFromSelector(@selector(useSSL))];
+    }
+
+    if ([decoder containsValueForKey:NSStringFromSelector(@selector(signatureVersion))]) {
+        self.signatureVersion = (AFAmazonS3SignatureVersion)[decoder decodeIntegerForKey:NSStringFromSelector(@selector(signatureVersion))];
+    }
+
+    if ([decoder containsValueForKey:NSStringFromSelector(@selector(payloadSigningMode))]) {
+        self.payloadSigningMode = (AFAmazonS3PayloadSigningMode)[decoder decodeIntegerForKey:NSStringFromSelector(@selector(payloadSigningMode))];
+    }
+
+    // The secret is set through its setter, which derives the keyed HMAC state from it
+    self.accessKey = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(accessKey))];
+    self.secret = [decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(secret))];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [super encodeWithCoder:coder];
+
+    [coder encodeObject:self.bucket forKey:NSStringFromSelector(@selector(bucket))];
+    [coder encodeObject:self.region forKey:NSStringFromSelector(@selector(region))];
+    [coder encodeObject:self.sessionToken forKey:NSStringFromSelector(@selector(sessionToken))];
+    [coder encodeBool:self.useSSL forKey:NSStringFromSelector(@selector(useSSL))];
+    [coder encodeInteger:self.signatureVersion forKey:NSStringFromSelector(@selector(signatureVersion))];
+    [coder encodeInteger:self.payloadSigningMode forKey:NSStringFromSelector(@selector(payloadSigningMode))];
+    [coder encodeObject:self.accessKey forKey:NSStringFromSelector(@selector(accessKey))];
+    [coder encodeObject:self.secret forKey:NSStringFromSelector(@selector(secret))];
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    AFAmazonS3RequestSerializer *serializer = [super copyWithZone:zone];
+
+    serializer.bucket = self.bucket;
+    serializer.region = self.region;
+    serializer.sessionToken = self.sessionToken;
+    serializer.useSSL = self.useSSL;
+    serializer.signatureVersion = self.signatureVersion;
+    serializer.payloadSigningMode = self.payloadSigningMode;
+
+    // The copy derives its own keyed HMAC state and signing key cache, rather than sharing them
+    serializer.accessKey = self.accessKey;
+    serializer.secret = self.secret;
+
+    return serializer;
+}
+
 @end
@@ -29,6 +29,15 @@
 
 @end
 
+/**
+ Returns an `AFAmazonS3ListBucketResult` object from the body of a ListObjects or ListObjectsV2 response.
+
+ @discussion The body is read with an event-driven parser that creates only the listed entries themselves, rather than a document tree.
+ */
+@interface AFAmazonS3ListBucketResponseSerializer : AFAmazonS3ResponseSerializer
+
+@end
+
 #pragma mark -
 
 /**
@@ -65,3 +74,71 @@
 @property (readonly, nonatomic, strong) NSHTTPURLResponse *originalResponse;
 
 @end
+
+#pragma mark -
+
+/**
+ Describes an object listed in a bucket.
+ */
+@interface AFAmazonS3ObjectSummary : NSObject
+
+/**
+ The key of the object.
+ */
+@property (readonly, nonatomic, copy) NSString *key;
+
+/**
+ The size of the object, in bytes.
+ */
+@property (readonly, nonatomic, assign) unsigned long long size;
+
+/**
+ The entity tag of the object, without surrounding quotes.
+ */
+@property (readonly, nonatomic, copy) NSString *ETag;
+
+/**
+ The date the object was last modified.
+ */
+@property (readonly, nonatomic, strong) NSDate *lastModified;
+
+/**
+ The storage class of the object, such as `STANDARD`.
+ */
+@property (readonly, nonatomic, copy) NSString *storageClass;
+
+@end
+
+#pragma mark -
+
+/**
+ One page of a bucket listing.
+ */
+@interface AFAmazonS3ListBucketResult : NSObject
+
+/**
+ The `AFAmazonS3ObjectSummary` objects listed in this page, in key order.
+ */
+@property (readonly, nonatomic, copy) NSArray *objects;
+
+/**
+ The common prefixes rolled up by the delimiter of the request, if any.
+ */
+@property (readonly, nonatomic, copy) NSArray *commonPrefixes;
+
+/**
+ Whether more results remain after this page.
+ */
+@property (readonly, nonatomic, assign, getter = isTruncated) BOOL truncated;
+
+/**
+ The token to pass as the continuation token of a ListObjectsV2 request for the next page, or `nil` if there is none.
+ */
+@property (readonly, nonatomic, copy) NSString *nextContinuationToken;
+
+/**
+ The key to pass as the marker of a ListObjects request for the next page, or `nil` if this page is not truncated. Falls back to the last key or common prefix listed when the response does not include one.
+ */
+@property (readonly, nonatomic, copy) NSString *nextMarker;
+
+@end
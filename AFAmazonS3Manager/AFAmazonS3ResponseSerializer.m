@@ -21,6 +21,23 @@
 // THE SOFTWARE.
 
 #import "AFAmazonS3ResponseSerializer.h"
+#import "AFAmazonS3Manager.h"
+
+static NSDate * AFDateFromISO8601String(NSString *string) {
+    // Parsed by hand rather than with `NSDateFormatter`, since a page may contain a thousand dates
+    struct tm components;
+    memset(&components, 0, sizeof(components));
+
+    double seconds = 0;
+    if (sscanf([string UTF8String], "%4d-%2d-%2dT%2d:%2d:%lfZ", &components.tm_year, &components.tm_mon, &components.tm_mday, &components.tm_hour, &components.tm_min, &seconds) != 6) {
+        return nil;
+    }
+
+    components.tm_year -= 1900;
+    components.tm_mon -= 1;
+
+    return [NSDate dateWithTimeIntervalSince1970:(NSTimeInterval)timegm(&components) + seconds];
+}
 
 @implementation AFAmazonS3ResponseSerializer
 
@@ -39,6 +56,28 @@
 
 #pragma mark -
 
+@interface AFAmazonS3ListBucketResult ()
++ (instancetype)resultWithData:(NSData *)data
+                         error:(NSError * __autoreleasing *)error;
+@end
+
+@implementation AFAmazonS3ListBucketResponseSerializer
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError * __autoreleasing *)error
+{
+    if ([self validateResponse:(NSHTTPURLResponse *)response data:data error:error]) {
+        return [AFAmazonS3ListBucketResult resultWithData:data error:error];
+    }
+
+    return nil;
+}
+
+@end
+
+#pragma mark -
+
 @interface AFAmazonS3ResponseObject ()
 @property (readwrite, nonatomic, strong) NSHTTPURLResponse *originalResponse;
 @end
@@ -77,3 +116,175 @@
 }
 
 @end
+
+#pragma mark -
+
+@interface AFAmazonS3ObjectSummary ()
+@property (readwrite, nonatomic, copy) NSString *key;
+@property (readwrite, nonatomic, assign) unsigned long long size;
+@property (readwrite, nonatomic, copy) NSString *ETag;
+@property (readwrite, nonatomic, strong) NSDate *lastModified;
+@property (readwrite, nonatomic, copy) NSString *storageClass;
+@end
+
+@implementation AFAmazonS3ObjectSummary
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, key: %@, size: %llu, ETag: %@, lastModified: %@, storageClass: %@>", NSStringFromClass([self class]), self, self.key, self.size, self.ETag, self.lastModified, self.storageClass];
+}
+
+@end
+
+#pragma mark -
+
+@interface AFAmazonS3ListBucketResult () <NSXMLParserDelegate>
+@property (readwrite, nonatomic, copy) NSArray *objects;
+@property (readwrite, nonatomic, copy) NSArray *commonPrefixes;
+@property (readwrite, nonatomic, assign, getter = isTruncated) BOOL truncated;
+@property (readwrite, nonatomic, copy) NSString *nextContinuationToken;
+@property (readwrite, nonatomic, copy) NSString *nextMarker;
+@property (readwrite, nonatomic, copy) NSString *rootElementName;
+@property (readwrite, nonatomic, strong) NSMutableArray *mutableObjects;
+@property (readwrite, nonatomic, strong) NSMutableArray *mutableCommonPrefixes;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *storageClasses;
+@property (readwrite, nonatomic, strong) AFAmazonS3ObjectSummary *currentObject;
+@property (readwrite, nonatomic, assign, getter = isInCommonPrefixes) BOOL inCommonPrefixes;
+@property (readwrite, nonatomic, strong) NSMutableString *currentText;
+@end
+
+@implementation AFAmazonS3ListBucketResult
+
++ (instancetype)resultWithData:(NSData *)data
+                         error:(NSError * __autoreleasing *)error
+{
+    AFAmazonS3ListBucketResult *result = [[self alloc] init];
+    result.mutableObjects = [NSMutableArray array];
+    result.mutableCommonPrefixes = [NSMutableArray array];
+    result.storageClasses = [NSMutableDictionary dictionary];
+
+    NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
+    parser.delegate = result;
+
+    if ([data length] == 0 || ![parser parse] || ![result.rootElementName isEqualToString:@"ListBucketResult"]) {
+        if (error) {
+            NSMutableDictionary *mutableUserInfo = [NSMutableDictionary dictionary];
+            mutableUserInfo[NSLocalizedDescriptionKey] = NSLocalizedStringFromTable(@"Invalid bucket listing in response", @"AFAmazonS3Manager", nil);
+            if (parser.parserError) {
+                mutableUserInfo[NSUnderlyingErrorKey] = parser.parserError;
+            }
+
+            *error = [[NSError alloc] initWithDomain:AFAmazonS3ManagerErrorDomain code:NSURLErrorCannotParseResponse userInfo:mutableUserInfo];
+        }
+
+        return nil;
+    }
+
+    result.objects = result.mutableObjects;
+    result.commonPrefixes = result.mutableCommonPrefixes;
+
+    // ListObjects only includes `NextMarker` when a delimiter is specified; otherwise the next page starts after the last key
+    if (result.truncated && !result.nextMarker) {
+        NSString *lastKey = [[result.objects lastObject] key];
+        NSString *lastPrefix = [result.commonPrefixes lastObject];
+        result.nextMarker = (!lastKey || (lastPrefix && [lastKey compare:lastPrefix] == NSOrderedAscending)) ? lastPrefix : lastKey;
+    }
+
+    result.mutableObjects = nil;
+    result.mutableCommonPrefixes = nil;
+    result.storageClasses = nil;
+
+    return result;
+}
+
+#pragma mark - NSXMLParserDelegate
+
+- (void)parser:(__unused NSXMLParser *)parser
+didStartElement:(NSString *)elementName
+  namespaceURI:(__unused NSString *)namespaceURI
+ qualifiedName:(__unused NSString *)qualifiedName
+    attributes:(__unused NSDictionary *)attributes
+{
+    static NSSet *_textElementNames = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _textElementNames = [NSSet setWithObjects:@"Key", @"Size", @"ETag", @"LastModified", @"StorageClass", @"Prefix", @"IsTruncated", @"NextContinuationToken", @"NextMarker", nil];
+    });
+
+    if (!self.rootElementName) {
+        self.rootElementName = elementName;
+    }
+
+    if ([elementName isEqualToString:@"Contents"]) {
+        self.currentObject = [[AFAmazonS3ObjectSummary alloc] init];
+    } else if ([elementName isEqualToString:@"CommonPrefixes"]) {
+        self.inCommonPrefixes = YES;
+    }
+
+    // Text is only collected for the elements that are read, which skips owner and request metadata
+    self.currentText = [_textElementNames containsObject:elementName] ? [NSMutableString string] : nil;
+}
+
+- (void)parser:(__unused NSXMLParser *)parser
+ didEndElement:(NSString *)elementName
+  namespaceURI:(__unused NSString *)namespaceURI
+ qualifiedName:(__unused NSString *)qualifiedName
+{
+    NSString *text = self.currentText;
+    self.currentText = nil;
+
+    if (self.currentObject) {
+        AFAmazonS3ObjectSummary *object = self.currentObject;
+        if ([elementName isEqualToString:@"Contents"]) {
+            [self.mutableObjects addObject:object];
+            self.currentObject = nil;
+        } else if (!text) {
+            return;
+        } else if ([elementName isEqualToString:@"Key"]) {
+            object.key = text;
+        } else if ([elementName isEqualToString:@"Size"]) {
+            object.size = strtoull([text UTF8String], NULL, 10);
+        } else if ([elementName isEqualToString:@"ETag"]) {
+            object.ETag = [text stringByReplacingOccurrencesOfString:@"\"" withString:@""];
+        } else if ([elementName isEqualToString:@"LastModified"]) {
+            object.lastModified = AFDateFromISO8601String(text);
+        } else if ([elementName isEqualToString:@"StorageClass"]) {
+            // Nearly every object shares one of a handful of storage classes, so a single instance of each is kept
+            NSString *storageClass = self.storageClasses[text];
+            if (!storageClass) {
+                storageClass = [text copy];
+                self.storageClasses[storageClass] = storageClass;
+            }
+            object.storageClass = storageClass;
+        }
+    } else if (self.inCommonPrefixes) {
+        if ([elementName isEqualToString:@"CommonPrefixes"]) {
+            self.inCommonPrefixes = NO;
+        } else if (text && [elementName isEqualToString:@"Prefix"]) {
+            [self.mutableCommonPrefixes addObject:[text copy]];
+        }
+    } else if (text) {
+        if ([elementName isEqualToString:@"IsTruncated"]) {
+            self.truncated = [text isEqualToString:@"true"];
+        } else if ([elementName isEqualToString:@"NextContinuationToken"]) {
+            self.nextContinuationToken = text;
+        } else if ([elementName isEqualToString:@"NextMarker"]) {
+            self.nextMarker = text;
+        }
+    }
+}
+
+- (void)parser:(__unused NSXMLParser *)parser
+foundCharacters:(NSString *)string
+{
+    [self.currentText appendString:string];
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, objects: %lu, commonPrefixes: %lu, truncated: %@>", NSStringFromClass([self class]), self, (unsigned long)[self.objects count], (unsigned long)[self.commonPrefixes count], self.truncated ? @"YES" : @"NO"];
+}
+
+@end
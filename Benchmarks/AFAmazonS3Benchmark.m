@@ -0,0 +1,217 @@
+// AFAmazonS3Benchmark.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+#import "AFAmazonS3Manager.h"
+#import "AFAmazonS3RequestScheduler.h"
+#import "AFAmazonS3ResponseSerializer.h"
+#import "AFAmazonS3StubURLProtocol.h"
+
+#include <math.h>
+#include <sys/resource.h>
+
+typedef void (^AFBenchmarkOperationBlock)(NSUInteger idx, void (^completion)(BOOL succeeded));
+
+static double AFPeakResidentSetSizeInMegabytes(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+    // Reported in bytes on Darwin, and in kilobytes elsewhere
+    return (double)usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return (double)usage.ru_maxrss / 1024.0;
+#endif
+}
+
+static int AFCompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double AFPercentile(double *sortedValues, NSUInteger count, double percentile) {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    NSUInteger idx = (NSUInteger)ceil(percentile * (double)count);
+
+    return sortedValues[MIN(MAX(idx, (NSUInteger)1), count) - 1];
+}
+
+static NSArray * AFIntegersFromArgument(NSString *argument) {
+    NSMutableArray *mutableIntegers = [NSMutableArray array];
+    for (NSString *component in [argument componentsSeparatedByString:@","]) {
+        long long value = [component longLongValue];
+        if (value > 0) {
+            [mutableIntegers addObject:@(value)];
+        }
+    }
+
+    return mutableIntegers;
+}
+
+// Latency is measured from when an operation is issued until its completion block runs, which includes time spent in the scheduler and the operation queue, but not waiting for one of the benchmark's own slots
+static void AFRunBenchmarkPhase(NSString *name, NSUInteger count, NSUInteger concurrency, unsigned long long numberOfBytesPerOperation, AFBenchmarkOperationBlock block) {
+    double *latencies = calloc(count, sizeof(double));
+    __block NSUInteger numberOfErrors = 0;
+
+    dispatch_semaphore_t slots = dispatch_semaphore_create((long)concurrency);
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t resultQueue = dispatch_queue_create("com.alamofire.networking.s3.benchmark.results", DISPATCH_QUEUE_SERIAL);
+
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger idx = 0; idx < count; idx++) {
+        dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+        dispatch_group_enter(group);
+
+        CFAbsoluteTime operationStartTime = CFAbsoluteTimeGetCurrent();
+        block(idx, ^(BOOL succeeded) {
+            CFAbsoluteTime operationFinishTime = CFAbsoluteTimeGetCurrent();
+            dispatch_async(resultQueue, ^{
+                latencies[idx] = operationFinishTime - operationStartTime;
+                if (!succeeded) {
+                    numberOfErrors++;
+                }
+
+                dispatch_semaphore_signal(slots);
+                dispatch_group_leave(group);
+            });
+        });
+    }
+
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    NSTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+
+    qsort(latencies, count, sizeof(double), AFCompareDoubles);
+
+    double operationsPerSecond = duration > 0.0 ? (double)count / duration : 0.0;
+    double megabytesPerSecond = duration > 0.0 ? (double)(numberOfBytesPerOperation * (count - numberOfErrors)) / duration / (1024.0 * 1024.0) : 0.0;
+
+    printf("%-6s %12llu %6lu %8lu %7lu %10.1f %9.2f %9.2f %9.2f %9.1f\n", [name UTF8String], numberOfBytesPerOperation, (unsigned long)concurrency, (unsigned long)count, (unsigned long)numberOfErrors, operationsPerSecond, megabytesPerSecond, AFPercentile(latencies, count, 0.5) * 1000.0, AFPercentile(latencies, count, 0.99) * 1000.0, AFPeakResidentSetSizeInMegabytes());
+    fflush(stdout);
+
+    free(latencies);
+}
+
+int main(__unused int argc, __unused const char *argv[]) {
+    @autoreleasepool {
+        // Options are read from the argument domain, as in `-count 500 -sizes 1024,1048576`
+        NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+        [defaults registerDefaults:@{
+                                     @"count": @200,
+                                     @"sizes": @"1024,65536,1048576,8388608",
+                                     @"concurrency": @"1,8,32",
+                                     @"latency": @0.02,
+                                     @"bandwidth": @0,
+                                     @"errorRate": @0,
+                                     @"scheduler": @YES,
+                                     @"verifyIntegrity": @NO
+                                     }];
+
+        NSUInteger count = (NSUInteger)MAX([defaults integerForKey:@"count"], (NSInteger)1);
+        NSArray *sizes = AFIntegersFromArgument([defaults stringForKey:@"sizes"]);
+        NSArray *concurrencies = AFIntegersFromArgument([defaults stringForKey:@"concurrency"]);
+
+        [AFAmazonS3StubURLProtocol setLatency:[defaults doubleForKey:@"latency"]];
+        [AFAmazonS3StubURLProtocol setBandwidth:[defaults doubleForKey:@"bandwidth"]];
+        [AFAmazonS3StubURLProtocol setServiceUnavailableProbability:[defaults doubleForKey:@"errorRate"]];
+        [NSURLProtocol registerClass:[AFAmazonS3StubURLProtocol class]];
+
+        printf("latency %.3fs, bandwidth %.0f B/s, 503 rate %.3f, scheduler %s, integrity verification %s\n\n", [AFAmazonS3StubURLProtocol latency], [AFAmazonS3StubURLProtocol bandwidth], [AFAmazonS3StubURLProtocol serviceUnavailableProbability], [defaults boolForKey:@"scheduler"] ? "on" : "off", [defaults boolForKey:@"verifyIntegrity"] ? "on" : "off");
+        printf("%-6s %12s %6s %8s %7s %10s %9s %9s %9s %9s\n", "op", "size", "conc", "ops", "errors", "ops/s", "MB/s", "p50 ms", "p99 ms", "RSS MB");
+
+        for (NSNumber *size in sizes) {
+            unsigned long long numberOfBytes = [size unsignedLongLongValue];
+
+            NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"AFAmazonS3Benchmark-%llu", numberOfBytes]];
+            NSMutableData *mutableData = [NSMutableData dataWithLength:(NSUInteger)numberOfBytes];
+            arc4random_buf([mutableData mutableBytes], [mutableData length]);
+            [mutableData writeToFile:filePath atomically:YES];
+            mutableData = nil;
+
+            for (NSNumber *concurrency in concurrencies) {
+                AFAmazonS3Manager *manager = [[AFAmazonS3Manager alloc] initWithBaseURL:[NSURL URLWithString:[NSString stringWithFormat:@"http://benchmark.%@/", AFAmazonS3StubURLProtocolHost]]];
+                [manager.requestSerializer setAccessKeyID:@"AKIDEXAMPLE" secret:@"wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY"];
+                manager.completionQueue = dispatch_queue_create("com.alamofire.networking.s3.benchmark.completion", DISPATCH_QUEUE_CONCURRENT);
+                manager.shouldVerifyObjectIntegrity = [defaults boolForKey:@"verifyIntegrity"];
+                if ([defaults boolForKey:@"scheduler"]) {
+                    manager.scheduler = [[AFAmazonS3RequestScheduler alloc] initWithOperationQueue:manager.operationQueue];
+                }
+
+                NSUInteger maximumConcurrency = [concurrency unsignedIntegerValue];
+                NSString *prefix = [NSString stringWithFormat:@"benchmark/%llu-%lu/", numberOfBytes, (unsigned long)maximumConcurrency];
+
+                AFRunBenchmarkPhase(@"PUT", count, maximumConcurrency, numberOfBytes, ^(NSUInteger idx, void (^completion)(BOOL)) {
+                    [manager putObjectWithFile:filePath destinationPath:[prefix stringByAppendingFormat:@"%lu", (unsigned long)idx] parameters:nil progress:nil success:^(__unused id responseObject) {
+                        completion(YES);
+                    } failure:^(__unused NSError *error) {
+                        completion(NO);
+                    }];
+                });
+
+                AFRunBenchmarkPhase(@"HEAD", count, maximumConcurrency, 0, ^(NSUInteger idx, void (^completion)(BOOL)) {
+                    [manager headObjectWithPath:[prefix stringByAppendingFormat:@"%lu", (unsigned long)idx] success:^(__unused NSHTTPURLResponse *response) {
+                        completion(YES);
+                    } failure:^(__unused NSError *error) {
+                        completion(NO);
+                    }];
+                });
+
+                AFRunBenchmarkPhase(@"GET", count, maximumConcurrency, numberOfBytes, ^(NSUInteger idx, void (^completion)(BOOL)) {
+                    [manager getObjectWithPath:[prefix stringByAppendingFormat:@"%lu", (unsigned long)idx] progress:nil success:^(__unused id responseObject, NSData *responseData) {
+                        completion([responseData length] == numberOfBytes);
+                    } failure:^(__unused NSError *error) {
+                        completion(NO);
+                    }];
+                });
+
+                AFRunBenchmarkPhase(@"LIST", count, maximumConcurrency, 0, ^(__unused NSUInteger idx, void (^completion)(BOOL)) {
+                    [manager listObjectsWithPrefix:prefix delimiter:nil continuationToken:nil maxKeys:0 success:^(AFAmazonS3ListBucketResult *result) {
+                        completion([result.objects count] == MIN(count, (NSUInteger)1000));
+                    } failure:^(__unused NSError *error) {
+                        completion(NO);
+                    }];
+                });
+
+                AFRunBenchmarkPhase(@"DELETE", count, maximumConcurrency, 0, ^(NSUInteger idx, void (^completion)(BOOL)) {
+                    [manager deleteObjectWithPath:[prefix stringByAppendingFormat:@"%lu", (unsigned long)idx] success:^(__unused id responseObject) {
+                        completion(YES);
+                    } failure:^(__unused NSError *error) {
+                        completion(NO);
+                    }];
+                });
+
+                printf("\n");
+            }
+
+            [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+        }
+
+        [AFAmazonS3StubURLProtocol removeAllObjects];
+        printf("peak RSS %.1f MB\n", AFPeakResidentSetSizeInMegabytes());
+    }
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+// AFAmazonS3EncodingBenchmark.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+#import "AFAmazonS3RequestSerializer.h"
+
+#include <stdlib.h>
+
+#pragma mark - Scalar
+
+// The scalar encoders that the vectorized encoders fall back to, kept here so that both can be measured in the same build
+
+static uint8_t const kAFBase64EncodingTable[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static uint8_t const kAFHexEncodingTable[16] = "0123456789abcdef";
+
+static size_t AFScalarBase64EncodeBytes(const uint8_t *input, size_t length, uint8_t *output) {
+    const uint8_t *start = output;
+
+    while (length >= 3) {
+        uint32_t value = ((uint32_t)input[0] << 16) | ((uint32_t)input[1] << 8) | input[2];
+        output[0] = kAFBase64EncodingTable[(value >> 18) & 0x3F];
+        output[1] = kAFBase64EncodingTable[(value >> 12) & 0x3F];
+        output[2] = kAFBase64EncodingTable[(value >> 6) & 0x3F];
+        output[3] = kAFBase64EncodingTable[value & 0x3F];
+
+        input += 3;
+        length -= 3;
+        output += 4;
+    }
+
+    if (length > 0) {
+        uint32_t value = ((uint32_t)input[0] << 16) | (length > 1 ? ((uint32_t)input[1] << 8) : 0);
+        output[0] = kAFBase64EncodingTable[(value >> 18) & 0x3F];
+        output[1] = kAFBase64EncodingTable[(value >> 12) & 0x3F];
+        output[2] = length > 1 ? kAFBase64EncodingTable[(value >> 6) & 0x3F] : '=';
+        output[3] = '=';
+        output += 4;
+    }
+
+    return (size_t)(output - start);
+}
+
+static size_t AFScalarHexEncodeBytes(const uint8_t *input, size_t length, uint8_t *output) {
+    const uint8_t *start = output;
+
+    while (length > 0) {
+        output[0] = kAFHexEncodingTable[*input >> 4];
+        output[1] = kAFHexEncodingTable[*input & 0x0F];
+
+        input++;
+        length--;
+        output += 2;
+    }
+
+    return (size_t)(output - start);
+}
+
+static NSString * AFScalarEncodedStringFromData(NSData *data, size_t encodedLength, size_t (*encode)(const uint8_t *, size_t, uint8_t *)) {
+    uint8_t buffer[128];
+    if (encodedLength <= sizeof(buffer)) {
+        return [[NSString alloc] initWithBytes:buffer length:encode([data bytes], [data length], buffer) encoding:NSASCIIStringEncoding];
+    }
+
+    uint8_t *output = malloc(encodedLength);
+    if (!output) {
+        return nil;
+    }
+
+    return [[NSString alloc] initWithBytesNoCopy:output length:encode([data bytes], [data length], output) encoding:NSASCIIStringEncoding freeWhenDone:YES];
+}
+
+static NSString * AFScalarBase64EncodedStringFromData(NSData *data) {
+    return AFScalarEncodedStringFromData(data, (([data length] + 2) / 3) * 4, AFScalarBase64EncodeBytes);
+}
+
+static NSString * AFScalarHexEncodedStringFromData(NSData *data) {
+    return AFScalarEncodedStringFromData(data, [data length] * 2, AFScalarHexEncodeBytes);
+}
+
+#pragma mark -
+
+static NSData * AFRandomDataOfLength(NSUInteger length) {
+    NSMutableData *mutableData = [NSMutableData dataWithLength:length];
+    arc4random_buf([mutableData mutableBytes], length);
+
+    return mutableData;
+}
+
+static NSTimeInterval AFDurationOfIterations(NSUInteger iterations, NSString * (^block)(void)) {
+    // A short warm-up faults in the input and output pages before timing starts
+    for (NSUInteger idx = 0; idx < MIN(iterations, (NSUInteger)100); idx++) {
+        @autoreleasepool {
+            block();
+        }
+    }
+
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger idx = 0; idx < iterations; idx++) {
+        @autoreleasepool {
+            block();
+        }
+    }
+
+    return CFAbsoluteTimeGetCurrent() - startTime;
+}
+
+int main(__unused int argc, __unused const char *argv[]) {
+    @autoreleasepool {
+        // Options are read from the argument domain, as in `-digestIterations 2000000 -payloadSize 8388608`
+        NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+        [defaults registerDefaults:@{
+                                     @"digestIterations": @1000000,
+                                     @"payloadSize": @(4 * 1024 * 1024),
+                                     @"payloadIterations": @100
+                                     }];
+
+        NSUInteger digestIterations = (NSUInteger)MAX([defaults integerForKey:@"digestIterations"], (NSInteger)1);
+        NSUInteger payloadSize = (NSUInteger)MAX([defaults integerForKey:@"payloadSize"], (NSInteger)1);
+        NSUInteger payloadIterations = (NSUInteger)MAX([defaults integerForKey:@"payloadIterations"], (NSInteger)1);
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        const char *vectorName = "NEON";
+#elif defined(__SSSE3__)
+        const char *vectorName = "SSSE3";
+#else
+        const char *vectorName = "scalar";
+#endif
+
+        // SHA-1 digests are Base64 encoded for Signature Version 2, and SHA-256 digests are hex encoded for Signature Version 4
+        NSArray *inputs = @[
+                            @[@"20 B digest", AFRandomDataOfLength(20), @(digestIterations)],
+                            @[@"32 B digest", AFRandomDataOfLength(32), @(digestIterations)],
+                            @[[NSString stringWithFormat:@"%.1f MB payload", (double)payloadSize / (1024 * 1024)], AFRandomDataOfLength(payloadSize), @(payloadIterations)]
+                            ];
+
+        NSArray *encoders = @[
+                              @[@"Base64", ^NSString * (NSData *data) { return AFScalarBase64EncodedStringFromData(data); }, ^NSString * (NSData *data) { return AFAmazonS3Base64EncodedStringFromData(data); }],
+                              @[@"hex", ^NSString * (NSData *data) { return AFScalarHexEncodedStringFromData(data); }, ^NSString * (NSData *data) { return AFAmazonS3HexEncodedStringFromData(data); }]
+                              ];
+
+        printf("%-8s %-16s %14s %14s %14s %14s %8s\n", "encoder", "input", "scalar ops/s", "scalar MB/s", [[NSString stringWithFormat:@"%s ops/s", vectorName] UTF8String], [[NSString stringWithFormat:@"%s MB/s", vectorName] UTF8String], "speedup");
+        for (NSArray *encoder in encoders) {
+            NSString * (^scalarEncode)(NSData *) = encoder[1];
+            NSString * (^vectorEncode)(NSData *) = encoder[2];
+
+            for (NSArray *input in inputs) {
+                NSData *data = input[1];
+                NSUInteger iterations = [input[2] unsignedIntegerValue];
+
+                // Both encoders must agree before either is timed
+                if (![scalarEncode(data) isEqualToString:vectorEncode(data)]) {
+                    fprintf(stderr, "%s encoders disagree for %s\n", [encoder[0] UTF8String], [input[0] UTF8String]);
+                    return 1;
+                }
+
+                NSTimeInterval scalarDuration = AFDurationOfIterations(iterations, ^NSString * { return scalarEncode(data); });
+                NSTimeInterval vectorDuration = AFDurationOfIterations(iterations, ^NSString * { return vectorEncode(data); });
+
+                double megabytes = (double)[data length] * iterations / (1024 * 1024);
+                printf("%-8s %-16s %14.0f %14.1f %14.0f %14.1f %7.2fx\n", [encoder[0] UTF8String], [input[0] UTF8String], iterations / scalarDuration, megabytes / scalarDuration, iterations / vectorDuration, megabytes / vectorDuration, scalarDuration / vectorDuration);
+                fflush(stdout);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+// AFAmazonS3StubURLProtocol.h
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ `AFAmazonS3StubURLProtocol` answers S3 requests in-process, so that `AFAmazonS3Manager` can be benchmarked without a network or a server.
+
+ ## Supported Operations
+
+ The stub serves `PUT`, `GET`, `HEAD` and `DELETE` on objects, including `Range` and `If-None-Match` requests, and lists objects with both ListObjects and ListObjectsV2. Each host is a separate bucket. Object bodies are kept in a temporary directory and sent in chunks, so that objects held by the stub count towards neither the memory nor the peak resident size of the process. Signatures are not checked.
+
+ ## Simulated Conditions
+
+ Each response is delayed by `latency`, and request and response bodies are paced to `bandwidth`. A fraction of requests, set by `serviceUnavailableProbability`, is answered with `503 Slow Down` before the request is processed.
+
+ ## Usage
+
+ Register the class with `+[NSURLProtocol registerClass:]`, and create the manager with a base URL on `AFAmazonS3StubURLProtocolHost`, such as `http://benchmark.s3.stub/`.
+ */
+@interface AFAmazonS3StubURLProtocol : NSURLProtocol
+
+/**
+ Returns the delay before each response is sent. `0` by default.
+ */
++ (NSTimeInterval)latency;
+
+/**
+ Sets the delay before each response is sent.
+ */
++ (void)setLatency:(NSTimeInterval)latency;
+
+/**
+ Returns the rate at which request and response bodies are transferred, in bytes per second. `0` by default, which transfers bodies as fast as possible.
+ */
++ (double)bandwidth;
+
+/**
+ Sets the rate at which request and response bodies are transferred, in bytes per second.
+ */
++ (void)setBandwidth:(double)bandwidth;
+
+/**
+ Returns the probability, between `0` and `1`, that a request is answered with `503 Slow Down`. `0` by default.
+ */
++ (double)serviceUnavailableProbability;
+
+/**
+ Sets the probability that a request is answered with `503 Slow Down`.
+ */
++ (void)setServiceUnavailableProbability:(double)serviceUnavailableProbability;
+
+/**
+ Deletes every object held by the stub.
+ */
++ (void)removeAllObjects;
+
+@end
+
+///----------------
+/// @name Constants
+///----------------
+
+/**
+ ## Host
+
+ `AFAmazonS3StubURLProtocolHost`
+ The host served by `AFAmazonS3StubURLProtocol`. Requests to this host, or to any subdomain of it, are answered by the stub.
+ */
+extern NSString * const AFAmazonS3StubURLProtocolHost;
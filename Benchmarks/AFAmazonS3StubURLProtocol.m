@@ -0,0 +1,615 @@
+// AFAmazonS3StubURLProtocol.m
+//
+// Copyright (c) 2011–2015 AFNetworking (http://afnetworking.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFAmazonS3StubURLProtocol.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#include <time.h>
+
+NSString * const AFAmazonS3StubURLProtocolHost = @"s3.stub";
+
+static NSUInteger const AFAmazonS3StubURLProtocolChunkLength = 64 * 1024;
+static NSUInteger const AFAmazonS3StubURLProtocolMaximumKeys = 1000;
+
+static NSTimeInterval AFAmazonS3StubURLProtocolLatency = 0.0;
+static double AFAmazonS3StubURLProtocolBandwidth = 0.0;
+static double AFAmazonS3StubURLProtocolServiceUnavailableProbability = 0.0;
+
+static dispatch_queue_t AFAmazonS3StubURLProtocolIsolationQueue(void) {
+    static dispatch_queue_t _isolationQueue = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _isolationQueue = dispatch_queue_create("com.alamofire.networking.s3.stub-url-protocol", DISPATCH_QUEUE_SERIAL);
+    });
+
+    return _isolationQueue;
+}
+
+static NSString * AFAmazonS3StubURLProtocolDirectoryPath(void) {
+    static NSString *_directoryPath = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _directoryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"AFAmazonS3StubURLProtocol-%d", [[NSProcessInfo processInfo] processIdentifier]]];
+        [[NSFileManager defaultManager] createDirectoryAtPath:_directoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+    });
+
+    return _directoryPath;
+}
+
+static NSString * AFHexEncodedStringFromBytes(const unsigned char *bytes, NSUInteger length) {
+    NSMutableString *mutableString = [NSMutableString stringWithCapacity:length * 2];
+    for (NSUInteger idx = 0; idx < length; idx++) {
+        [mutableString appendFormat:@"%02x", bytes[idx]];
+    }
+
+    return mutableString;
+}
+
+static NSString * AFXMLEscapedString(NSString *string) {
+    NSMutableString *mutableString = [NSMutableString stringWithString:string ?: @""];
+    [mutableString replaceOccurrencesOfString:@"&" withString:@"&amp;" options:0 range:NSMakeRange(0, [mutableString length])];
+    [mutableString replaceOccurrencesOfString:@"<" withString:@"&lt;" options:0 range:NSMakeRange(0, [mutableString length])];
+    [mutableString replaceOccurrencesOfString:@">" withString:@"&gt;" options:0 range:NSMakeRange(0, [mutableString length])];
+    [mutableString replaceOccurrencesOfString:@"\"" withString:@"&quot;" options:0 range:NSMakeRange(0, [mutableString length])];
+
+    return mutableString;
+}
+
+static NSString * AFStringFromDate(NSDate *date, const char *format) {
+    time_t time = (time_t)[date timeIntervalSince1970];
+    struct tm components;
+    gmtime_r(&time, &components);
+
+    char buffer[64];
+    strftime(buffer, sizeof(buffer), format, &components);
+
+    return [NSString stringWithUTF8String:buffer];
+}
+
+static NSDictionary * AFQueryParametersFromURL(NSURL *URL) {
+    NSMutableDictionary *mutableParameters = [NSMutableDictionary dictionary];
+    for (NSString *pair in [[URL query] componentsSeparatedByString:@"&"]) {
+        if ([pair length] == 0) {
+            continue;
+        }
+
+        NSRange range = [pair rangeOfString:@"="];
+        NSString *name = range.location == NSNotFound ? pair : [pair substringToIndex:range.location];
+        NSString *value = range.location == NSNotFound ? @"" : [pair substringFromIndex:NSMaxRange(range)];
+        mutableParameters[[name stringByRemovingPercentEncoding] ?: name] = [value stringByRemovingPercentEncoding] ?: value;
+    }
+
+    return mutableParameters;
+}
+
+static NSString * AFObjectKeyFromURL(NSURL *URL) {
+    // `-[NSURL path]` drops a trailing slash, which is part of the key
+    NSString *path = CFBridgingRelease(CFURLCopyPath((__bridge CFURLRef)URL));
+    path = [path stringByRemovingPercentEncoding] ?: path;
+
+    return [path hasPrefix:@"/"] ? [path substringFromIndex:1] : path;
+}
+
+#pragma mark -
+
+@interface AFAmazonS3StubObject : NSObject
+@property (readwrite, nonatomic, copy) NSString *filePath;
+@property (readwrite, nonatomic, assign) unsigned long long size;
+@property (readwrite, nonatomic, copy) NSString *ETag;
+@property (readwrite, nonatomic, copy) NSString *contentType;
+@property (readwrite, nonatomic, strong) NSDate *lastModified;
+@end
+
+@implementation AFAmazonS3StubObject
+@end
+
+static NSMutableDictionary * AFAmazonS3StubURLProtocolObjectsByHost(void) {
+    static NSMutableDictionary *_objectsByHost = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _objectsByHost = [NSMutableDictionary dictionary];
+    });
+
+    return _objectsByHost;
+}
+
+#pragma mark -
+
+@interface AFAmazonS3StubURLProtocol ()
+@property (readwrite, nonatomic, strong) NSThread *clientThread;
+@property (readwrite, nonatomic, copy) NSArray *runLoopModes;
+@property (readwrite, atomic, assign, getter = isStopped) BOOL stopped;
+@end
+
+@implementation AFAmazonS3StubURLProtocol
+
++ (NSTimeInterval)latency {
+    __block NSTimeInterval latency = 0.0;
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        latency = AFAmazonS3StubURLProtocolLatency;
+    });
+
+    return latency;
+}
+
++ (void)setLatency:(NSTimeInterval)latency {
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        AFAmazonS3StubURLProtocolLatency = MAX(latency, 0.0);
+    });
+}
+
++ (double)bandwidth {
+    __block double bandwidth = 0.0;
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        bandwidth = AFAmazonS3StubURLProtocolBandwidth;
+    });
+
+    return bandwidth;
+}
+
++ (void)setBandwidth:(double)bandwidth {
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        AFAmazonS3StubURLProtocolBandwidth = MAX(bandwidth, 0.0);
+    });
+}
+
++ (double)serviceUnavailableProbability {
+    __block double probability = 0.0;
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        probability = AFAmazonS3StubURLProtocolServiceUnavailableProbability;
+    });
+
+    return probability;
+}
+
++ (void)setServiceUnavailableProbability:(double)serviceUnavailableProbability {
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        AFAmazonS3StubURLProtocolServiceUnavailableProbability = MIN(MAX(serviceUnavailableProbability, 0.0), 1.0);
+    });
+}
+
++ (void)removeAllObjects {
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        NSMutableDictionary *objectsByHost = AFAmazonS3StubURLProtocolObjectsByHost();
+        for (NSDictionary *objectsByKey in [objectsByHost allValues]) {
+            for (AFAmazonS3StubObject *object in [objectsByKey allValues]) {
+                [[NSFileManager defaultManager] removeItemAtPath:object.filePath error:nil];
+            }
+        }
+
+        [objectsByHost removeAllObjects];
+    });
+}
+
+#pragma mark - NSURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    NSString *host = [[request.URL host] lowercaseString];
+
+    return [host isEqualToString:AFAmazonS3StubURLProtocolHost] || [host hasSuffix:[@"." stringByAppendingString:AFAmazonS3StubURLProtocolHost]];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    // Client methods must be called on the thread that started loading, in the modes its run loop was running in
+    self.clientThread = [NSThread currentThread];
+
+    NSMutableArray *mutableRunLoopModes = [NSMutableArray arrayWithObject:NSDefaultRunLoopMode];
+    NSString *currentMode = [[NSRunLoop currentRunLoop] currentMode];
+    if (currentMode && ![currentMode isEqualToString:NSDefaultRunLoopMode]) {
+        [mutableRunLoopModes addObject:currentMode];
+    }
+    self.runLoopModes = mutableRunLoopModes;
+
+    // Bodies are read and written off the client thread, which the URL loading system shares between connections
+    NSURLRequest *request = self.request;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self respondToRequest:request];
+    });
+}
+
+- (void)stopLoading {
+    self.stopped = YES;
+}
+
+#pragma mark -
+
+- (void)respondToRequest:(NSURLRequest *)request {
+    NSTimeInterval latency = [[self class] latency];
+    double probability = [[self class] serviceUnavailableProbability];
+
+    NSString *method = [request.HTTPMethod uppercaseString];
+    NSString *host = [[request.URL host] lowercaseString];
+    NSString *key = AFObjectKeyFromURL(request.URL);
+    NSDictionary *parameters = AFQueryParametersFromURL(request.URL);
+
+    if (probability > 0.0 && arc4random_uniform(1000000) < (uint32_t)(probability * 1000000.0)) {
+        [self respondWithErrorCode:@"SlowDown" message:@"Please reduce your request rate." statusCode:503 key:key afterDelay:latency];
+    } else if ([key length] == 0) {
+        if ([method isEqualToString:@"GET"]) {
+            [self respondWithListOfObjectsInBucket:host parameters:parameters afterDelay:latency];
+        } else {
+            [self respondWithErrorCode:@"NotImplemented" message:@"The stub does not implement this bucket operation." statusCode:501 key:key afterDelay:latency];
+        }
+    } else if (parameters[@"uploads"] || parameters[@"uploadId"] || [request valueForHTTPHeaderField:@"x-amz-copy-source"]) {
+        [self respondWithErrorCode:@"NotImplemented" message:@"The stub does not implement multipart uploads or copies." statusCode:501 key:key afterDelay:latency];
+    } else if ([method isEqualToString:@"PUT"]) {
+        [self respondByStoringBodyOfRequest:request inBucket:host key:key afterDelay:latency];
+    } else if ([method isEqualToString:@"GET"] || [method isEqualToString:@"HEAD"]) {
+        [self respondWithObjectInBucket:host key:key request:request afterDelay:latency];
+    } else if ([method isEqualToString:@"DELETE"]) {
+        dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+            NSMutableDictionary *objectsByKey = AFAmazonS3StubURLProtocolObjectsByHost()[host];
+            AFAmazonS3StubObject *object = objectsByKey[key];
+            if (object) {
+                [[NSFileManager defaultManager] removeItemAtPath:object.filePath error:nil];
+                [objectsByKey removeObjectForKey:key];
+            }
+        });
+
+        [self respondWithStatusCode:204 headerFields:nil data:nil fileHandle:nil length:0 afterDelay:latency];
+    } else {
+        [self respondWithErrorCode:@"MethodNotAllowed" message:@"The specified method is not allowed against this resource." statusCode:405 key:key afterDelay:latency];
+    }
+}
+
+- (void)respondByStoringBodyOfRequest:(NSURLRequest *)request
+                             inBucket:(NSString *)bucket
+                                  key:(NSString *)key
+                           afterDelay:(NSTimeInterval)delay
+{
+    NSString *filePath = [AFAmazonS3StubURLProtocolDirectoryPath() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+    CC_MD5_CTX context;
+    CC_MD5_Init(&context);
+
+    unsigned long long size = 0;
+    BOOL written = YES;
+
+    NSOutputStream *outputStream = [NSOutputStream outputStreamToFileAtPath:filePath append:NO];
+    [outputStream open];
+
+    // The URL loading system may hand the protocol either form of body
+    if (request.HTTPBody) {
+        NSData *data = request.HTTPBody;
+        CC_MD5_Update(&context, [data bytes], (CC_LONG)[data length]);
+        written = [data length] == 0 || [outputStream write:[data bytes] maxLength:[data length]] == (NSInteger)[data length];
+        size = [data length];
+    } else if (request.HTTPBodyStream) {
+        NSInputStream *inputStream = request.HTTPBodyStream;
+        [inputStream open];
+
+        uint8_t buffer[AFAmazonS3StubURLProtocolChunkLength];
+        NSInteger numberOfBytesRead = 0;
+        while (written && (numberOfBytesRead = [inputStream read:buffer maxLength:sizeof(buffer)]) > 0) {
+            CC_MD5_Update(&context, buffer, (CC_LONG)numberOfBytesRead);
+            written = [outputStream write:buffer maxLength:(NSUInteger)numberOfBytesRead] == numberOfBytesRead;
+            size += (unsigned long long)numberOfBytesRead;
+        }
+
+        written = written && numberOfBytesRead == 0;
+        [inputStream close];
+    }
+
+    [outputStream close];
+
+    unsigned char digest[CC_MD5_DIGEST_LENGTH];
+    CC_MD5_Final(digest, &context);
+
+    NSString *contentMD5 = [request valueForHTTPHeaderField:@"Content-MD5"];
+    double bandwidth = [[self class] bandwidth];
+    if (bandwidth > 0.0) {
+        delay += (double)size / bandwidth;
+    }
+
+    if (!written) {
+        [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+        [self respondWithErrorCode:@"IncompleteBody" message:@"The request body could not be read." statusCode:400 key:key afterDelay:delay];
+        return;
+    }
+
+    if (contentMD5 && ![contentMD5 isEqualToString:[[NSData dataWithBytes:digest length:CC_MD5_DIGEST_LENGTH] base64EncodedStringWithOptions:0]]) {
+        [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+        [self respondWithErrorCode:@"BadDigest" message:@"The Content-MD5 you specified did not match what we received." statusCode:400 key:key afterDelay:delay];
+        return;
+    }
+
+    AFAmazonS3StubObject *object = [[AFAmazonS3StubObject alloc] init];
+    object.filePath = filePath;
+    object.size = size;
+    object.ETag = AFHexEncodedStringFromBytes(digest, CC_MD5_DIGEST_LENGTH);
+    object.contentType = [request valueForHTTPHeaderField:@"Content-Type"] ?: @"binary/octet-stream";
+    object.lastModified = [NSDate date];
+
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        NSMutableDictionary *objectsByHost = AFAmazonS3StubURLProtocolObjectsByHost();
+        NSMutableDictionary *objectsByKey = objectsByHost[bucket];
+        if (!objectsByKey) {
+            objectsByKey = [NSMutableDictionary dictionary];
+            objectsByHost[bucket] = objectsByKey;
+        }
+
+        // Readers of the previous object keep their open file handle after the file is removed
+        AFAmazonS3StubObject *previousObject = objectsByKey[key];
+        if (previousObject) {
+            [[NSFileManager defaultManager] removeItemAtPath:previousObject.filePath error:nil];
+        }
+
+        objectsByKey[key] = object;
+    });
+
+    [self respondWithStatusCode:200 headerFields:@{@"ETag": [NSString stringWithFormat:@"\"%@\"", object.ETag]} data:nil fileHandle:nil length:0 afterDelay:delay];
+}
+
+- (void)respondWithObjectInBucket:(NSString *)bucket
+                              key:(NSString *)key
+                          request:(NSURLRequest *)request
+                       afterDelay:(NSTimeInterval)delay
+{
+    __block AFAmazonS3StubObject *object = nil;
+    __block NSFileHandle *fileHandle = nil;
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        object = AFAmazonS3StubURLProtocolObjectsByHost()[bucket][key];
+        fileHandle = object ? [NSFileHandle fileHandleForReadingAtPath:object.filePath] : nil;
+    });
+
+    BOOL head = [[request.HTTPMethod uppercaseString] isEqualToString:@"HEAD"];
+    if (!fileHandle) {
+        if (head) {
+            [self respondWithStatusCode:404 headerFields:nil data:nil fileHandle:nil length:0 afterDelay:delay];
+        } else {
+            [self respondWithErrorCode:@"NoSuchKey" message:@"The specified key does not exist." statusCode:404 key:key afterDelay:delay];
+        }
+
+        return;
+    }
+
+    NSString *ETag = [NSString stringWithFormat:@"\"%@\"", object.ETag];
+    NSMutableDictionary *mutableHeaderFields = [NSMutableDictionary dictionary];
+    mutableHeaderFields[@"ETag"] = ETag;
+    mutableHeaderFields[@"Last-Modified"] = AFStringFromDate(object.lastModified, "%a, %d %b %Y %H:%M:%S GMT");
+    mutableHeaderFields[@"Accept-Ranges"] = @"bytes";
+
+    NSString *ifNoneMatch = [request valueForHTTPHeaderField:@"If-None-Match"];
+    if (ifNoneMatch && ([ifNoneMatch isEqualToString:ETag] || [ifNoneMatch isEqualToString:object.ETag])) {
+        [self respondWithStatusCode:304 headerFields:mutableHeaderFields data:nil fileHandle:nil length:0 afterDelay:delay];
+        return;
+    }
+
+    NSInteger statusCode = 200;
+    unsigned long long firstByte = 0;
+    unsigned long long length = object.size;
+
+    NSString *range = [request valueForHTTPHeaderField:@"Range"];
+    if ([range hasPrefix:@"bytes="] && object.size > 0) {
+        unsigned long long first = 0, last = object.size - 1;
+        NSArray *bounds = [[range substringFromIndex:6] componentsSeparatedByString:@"-"];
+        NSString *firstString = [bounds firstObject], *lastString = [bounds count] == 2 ? bounds[1] : nil;
+
+        BOOL satisfiable = lastString != nil;
+        if ([firstString length] > 0) {
+            first = strtoull([firstString UTF8String], NULL, 10);
+            if ([lastString length] > 0) {
+                last = MIN(strtoull([lastString UTF8String], NULL, 10), object.size - 1);
+            }
+        } else if ([lastString length] > 0) {
+            unsigned long long suffixLength = strtoull([lastString UTF8String], NULL, 10);
+            first = suffixLength >= object.size ? 0 : object.size - suffixLength;
+            satisfiable = suffixLength > 0;
+        } else {
+            satisfiable = NO;
+        }
+
+        if (!satisfiable || first > last) {
+            [fileHandle closeFile];
+            [self respondWithErrorCode:@"InvalidRange" message:@"The requested range is not satisfiable." statusCode:416 key:key afterDelay:delay];
+            return;
+        }
+
+        statusCode = 206;
+        firstByte = first;
+        length = last - first + 1;
+        mutableHeaderFields[@"Content-Range"] = [NSString stringWithFormat:@"bytes %llu-%llu/%llu", first, last, object.size];
+    }
+
+    mutableHeaderFields[@"Content-Type"] = object.contentType;
+    mutableHeaderFields[@"Content-Length"] = [NSString stringWithFormat:@"%llu", length];
+
+    if (head) {
+        [fileHandle closeFile];
+        [self respondWithStatusCode:statusCode headerFields:mutableHeaderFields data:nil fileHandle:nil length:0 afterDelay:delay];
+    } else {
+        [fileHandle seekToFileOffset:firstByte];
+        [self respondWithStatusCode:statusCode headerFields:mutableHeaderFields data:nil fileHandle:fileHandle length:length afterDelay:delay];
+    }
+}
+
+- (void)respondWithListOfObjectsInBucket:(NSString *)bucket
+                              parameters:(NSDictionary *)parameters
+                              afterDelay:(NSTimeInterval)delay
+{
+    __block NSDictionary *objectsByKey = nil;
+    dispatch_sync(AFAmazonS3StubURLProtocolIsolationQueue(), ^{
+        objectsByKey = [AFAmazonS3StubURLProtocolObjectsByHost()[bucket] copy] ?: @{};
+    });
+
+    BOOL version2 = [parameters[@"list-type"] isEqualToString:@"2"];
+    NSString *prefix = parameters[@"prefix"] ?: @"";
+    NSString *delimiter = [parameters[@"delimiter"] length] > 0 ? parameters[@"delimiter"] : nil;
+    NSString *startKey = version2 ? (parameters[@"continuation-token"] ?: parameters[@"start-after"]) : parameters[@"marker"];
+    NSUInteger maxKeys = parameters[@"max-keys"] ? MIN((NSUInteger)[parameters[@"max-keys"] integerValue], AFAmazonS3StubURLProtocolMaximumKeys) : AFAmazonS3StubURLProtocolMaximumKeys;
+
+    NSMutableString *mutableContents = [NSMutableString string];
+    NSString *lastCommonPrefix = nil;
+    NSString *lastListedKey = nil;
+    NSUInteger keyCount = 0;
+    BOOL truncated = NO;
+
+    for (NSString *key in [[objectsByKey allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        if (![key hasPrefix:prefix] || (startKey && [key compare:startKey] != NSOrderedDescending)) {
+            continue;
+        }
+
+        // A page that ended on a common prefix resumes after every key rolled up into it
+        if ((startKey && delimiter && [startKey hasSuffix:delimiter] && [key hasPrefix:startKey]) || (lastCommonPrefix && [key hasPrefix:lastCommonPrefix])) {
+            continue;
+        }
+
+        if (keyCount >= maxKeys) {
+            truncated = YES;
+            break;
+        }
+
+        NSRange delimiterRange = delimiter ? [key rangeOfString:delimiter options:0 range:NSMakeRange([prefix length], [key length] - [prefix length])] : NSMakeRange(NSNotFound, 0);
+        if (delimiterRange.location != NSNotFound) {
+            lastCommonPrefix = [key substringToIndex:NSMaxRange(delimiterRange)];
+            lastListedKey = lastCommonPrefix;
+            [mutableContents appendFormat:@"<CommonPrefixes><Prefix>%@</Prefix></CommonPrefixes>", AFXMLEscapedString(lastCommonPrefix)];
+        } else {
+            AFAmazonS3StubObject *object = objectsByKey[key];
+            lastListedKey = key;
+            [mutableContents appendFormat:@"<Contents><Key>%@</Key><LastModified>%@</LastModified><ETag>&quot;%@&quot;</ETag><Size>%llu</Size><StorageClass>STANDARD</StorageClass></Contents>", AFXMLEscapedString(key), AFStringFromDate(object.lastModified, "%Y-%m-%dT%H:%M:%S.000Z"), object.ETag, object.size];
+        }
+
+        keyCount++;
+    }
+
+    NSMutableString *mutableXMLString = [NSMutableString stringWithString:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"];
+    [mutableXMLString appendFormat:@"<Name>%@</Name><Prefix>%@</Prefix><MaxKeys>%lu</MaxKeys>", AFXMLEscapedString(bucket), AFXMLEscapedString(prefix), (unsigned long)maxKeys];
+    if (version2) {
+        [mutableXMLString appendFormat:@"<KeyCount>%lu</KeyCount>", (unsigned long)keyCount];
+    }
+    [mutableXMLString appendFormat:@"<IsTruncated>%@</IsTruncated>", truncated ? @"true" : @"false"];
+    if (truncated && lastListedKey) {
+        [mutableXMLString appendFormat:(version2 ? @"<NextContinuationToken>%@</NextContinuationToken>" : @"<NextMarker>%@</NextMarker>"), AFXMLEscapedString(lastListedKey)];
+    }
+    [mutableXMLString appendString:mutableContents];
+    [mutableXMLString appendString:@"</ListBucketResult>"];
+
+    NSData *data = [mutableXMLString dataUsingEncoding:NSUTF8StringEncoding];
+    NSDictionary *headerFields = @{
+                                   @"Content-Type": @"application/xml",
+                                   @"Content-Length": [NSString stringWithFormat:@"%lu", (unsigned long)[data length]]
+                                   };
+
+    [self respondWithStatusCode:200 headerFields:headerFields data:data fileHandle:nil length:[data length] afterDelay:delay];
+}
+
+- (void)respondWithErrorCode:(NSString *)code
+                     message:(NSString *)message
+                  statusCode:(NSInteger)statusCode
+                         key:(NSString *)key
+                  afterDelay:(NSTimeInterval)delay
+{
+    NSString *XMLString = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Error><Code>%@</Code><Message>%@</Message><Resource>/%@</Resource><RequestId>%@</RequestId></Error>", code, AFXMLEscapedString(message), AFXMLEscapedString(key), [[NSUUID UUID] UUIDString]];
+    NSData *data = [XMLString dataUsingEncoding:NSUTF8StringEncoding];
+
+    BOOL head = [[self.request.HTTPMethod uppercaseString] isEqualToString:@"HEAD"];
+    NSDictionary *headerFields = @{
+                                   @"Content-Type": @"application/xml",
+                                   @"Content-Length": [NSString stringWithFormat:@"%lu", (unsigned long)(head ? 0 : [data length])]
+                                   };
+
+    [self respondWithStatusCode:statusCode headerFields:headerFields data:(head ? nil : data) fileHandle:nil length:(head ? 0 : [data length]) afterDelay:delay];
+}
+
+- (void)respondWithStatusCode:(NSInteger)statusCode
+                 headerFields:(NSDictionary *)headerFields
+                         data:(NSData *)data
+                   fileHandle:(NSFileHandle *)fileHandle
+                       length:(unsigned long long)length
+                   afterDelay:(NSTimeInterval)delay
+{
+    NSMutableDictionary *mutableHeaderFields = [NSMutableDictionary dictionaryWithDictionary:headerFields ?: @{}];
+    mutableHeaderFields[@"Date"] = AFStringFromDate([NSDate date], "%a, %d %b %Y %H:%M:%S GMT");
+    mutableHeaderFields[@"Server"] = @"AmazonS3";
+    mutableHeaderFields[@"x-amz-request-id"] = [[[NSUUID UUID] UUIDString] stringByReplacingOccurrencesOfString:@"-" withString:@""];
+    if (!mutableHeaderFields[@"Content-Length"]) {
+        mutableHeaderFields[@"Content-Length"] = [NSString stringWithFormat:@"%llu", length];
+    }
+
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:mutableHeaderFields];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self performBlockOnClientThread:^{
+            [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+        }];
+
+        [self sendBodyFromData:data fileHandle:fileHandle offset:0 length:length];
+    });
+}
+
+- (void)sendBodyFromData:(NSData *)data
+              fileHandle:(NSFileHandle *)fileHandle
+                  offset:(unsigned long long)offset
+                  length:(unsigned long long)length
+{
+    if (self.stopped || offset >= length) {
+        [fileHandle closeFile];
+
+        [self performBlockOnClientThread:^{
+            [self.client URLProtocolDidFinishLoading:self];
+        }];
+
+        return;
+    }
+
+    NSUInteger chunkLength = (NSUInteger)MIN(length - offset, (unsigned long long)AFAmazonS3StubURLProtocolChunkLength);
+    NSData *chunk = fileHandle ? [fileHandle readDataOfLength:chunkLength] : [data subdataWithRange:NSMakeRange((NSUInteger)offset, chunkLength)];
+    if ([chunk length] == 0) {
+        [fileHandle closeFile];
+
+        NSError *error = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil];
+        [self performBlockOnClientThread:^{
+            [self.client URLProtocol:self didFailWithError:error];
+        }];
+
+        return;
+    }
+
+    [self performBlockOnClientThread:^{
+        [self.client URLProtocol:self didLoadData:chunk];
+    }];
+
+    // Each chunk is sent once the previous one would have been transferred at the simulated bandwidth
+    double bandwidth = [[self class] bandwidth];
+    NSTimeInterval interval = bandwidth > 0.0 ? (double)[chunk length] / bandwidth : 0.0;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self sendBodyFromData:data fileHandle:fileHandle offset:offset + [chunk length] length:length];
+    });
+}
+
+- (void)performBlockOnClientThread:(dispatch_block_t)block {
+    [self performSelector:@selector(performBlock:) onThread:self.clientThread withObject:[block copy] waitUntilDone:NO modes:self.runLoopModes];
+}
+
+- (void)performBlock:(dispatch_block_t)block {
+    // Once loading has stopped, the client must not be sent any more messages
+    if (!self.stopped) {
+        block();
+    }
+}
+
+@end